@@ -1,14 +1,19 @@
 #include <sqlite3.h>
+#include <atomic>
 #include <chrono>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <random>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <unordered_map>
 #include <vector>
+#include <symspell/live_dictionary.hpp>
 #include <symspell/symspell.hpp>
 #include <symspell/symspell_sqlite.hpp>
+#include <symspell/tiered_store.hpp>
 
 using namespace yams::symspell;
 
@@ -22,6 +27,8 @@ public:
         benchmarkConcurrentAccess();
         benchmarkSQLitePersistence();
         benchmarkLargeDictionary();
+        benchmarkExactHits();
+        benchmarkHashCompaction();
 
         std::cout << "\n=== Benchmark Complete ===" << std::endl;
     }
@@ -114,6 +121,46 @@ private:
 
         printResult("4 threads x 1,000 lookups",
                     std::chrono::duration_cast<std::chrono::microseconds>(end - start));
+
+        // The same lookups against a LiveDictionary while a writer publishes 100-term deltas.
+        LiveDictionary live(2, 7);
+        for (int i = 0; i < 1000; ++i) {
+            live.createDictionaryEntry("word" + std::to_string(i), 100);
+        }
+        live.publish();
+
+        std::atomic<bool> done{false};
+        int publishes = 0;
+        std::thread writer([&]() {
+            for (int batch = 0; !done.load(); ++batch) {
+                for (int i = 0; i < 100; ++i) {
+                    live.createDictionaryEntry("live" + std::to_string(batch * 100 + i), 10);
+                }
+                live.publish();
+                ++publishes;
+            }
+        });
+
+        start = std::chrono::high_resolution_clock::now();
+        threads.clear();
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&live]() {
+                LookupContext context;
+                for (int i = 0; i < 250; ++i) {
+                    live.lookup("wrod" + std::to_string(i), context, Verbosity::Closest);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        end = std::chrono::high_resolution_clock::now();
+        done.store(true);
+        writer.join();
+
+        printResult("4 threads x 1,000 live lookups",
+                    std::chrono::duration_cast<std::chrono::microseconds>(end - start));
+        std::cout << "  Publishes during lookups: " << publishes << std::endl;
     }
 
     void benchmarkSQLitePersistence() {
@@ -147,6 +194,36 @@ private:
             sqlite3_close(db);
         }
 
+        {
+            const char* bulkPath = "/tmp/symspell_bench_bulk.db";
+            std::remove(bulkPath);
+            sqlite3* db;
+            sqlite3_open(bulkPath, &db);
+            auto initResult = SQLiteStore::initializeDatabase(db);
+
+            std::vector<std::pair<std::string, int64_t>> words;
+            for (int i = 0; i < 10000; ++i) {
+                words.emplace_back("word" + std::to_string(i), 100);
+            }
+
+            auto start = std::chrono::high_resolution_clock::now();
+            {
+                auto store = std::make_unique<SQLiteStore>(db, 2, 7);
+                auto* sqlite = store.get();
+                SymSpell spell(std::move(store), 2, 7);
+                sqlite->beginBulkImport();
+                spell.createDictionary(words);
+                sqlite->endBulkImport();
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+
+            printResult("Bulk import 10,000 entries (SQLite)",
+                        std::chrono::duration_cast<std::chrono::microseconds>(end - start));
+
+            sqlite3_close(db);
+            std::remove(bulkPath);
+        }
+
         {
             sqlite3* db;
             sqlite3_open(path, &db);
@@ -166,6 +243,34 @@ private:
             sqlite3_close(db);
         }
 
+        {
+            sqlite3* db;
+            sqlite3_open(path, &db);
+
+            // Skewed workload: 500 distinct inputs, each looked up 20 times.
+            auto runSkewed = [](SymSpell& spell) {
+                auto start = std::chrono::high_resolution_clock::now();
+                for (int i = 0; i < 10000; ++i) {
+                    spell.lookup("wrd" + std::to_string(i % 500), Verbosity::Closest);
+                }
+                return std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::high_resolution_clock::now() - start);
+            };
+
+            {
+                SymSpell spell(std::make_unique<SQLiteStore>(db, 2, 7), 2, 7);
+                printResult("10,000 skewed lookups (SQLite)", runSkewed(spell));
+            }
+            {
+                auto tiered =
+                    std::make_unique<TieredStore>(std::make_unique<SQLiteStore>(db, 2, 7));
+                SymSpell spell(std::move(tiered), 2, 7);
+                printResult("10,000 skewed lookups (SQLite, tiered)", runSkewed(spell));
+            }
+
+            sqlite3_close(db);
+        }
+
         std::remove(path);
     }
 
@@ -192,6 +297,184 @@ private:
 
         printResult("1,000 lookups (50K dict)",
                     std::chrono::duration_cast<std::chrono::microseconds>(end - start));
+
+        auto runTopK = [&](SymSpell& dict) {
+            auto begin = std::chrono::high_resolution_clock::now();
+            for (int i = 0; i < 1000; ++i) {
+                dict.lookupTopK("dictonaryword" + std::to_string(i % 50000), 5);
+            }
+            return std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::high_resolution_clock::now() - begin);
+        };
+
+        printResult("1,000 top-5 lookups (50K dict)", runTopK(spell));
+
+        // Skewed frequencies, as in real corpora, with buckets sorted by frequency.
+        auto ordered = std::make_unique<MemoryStore>(2, 7);
+        auto* orderedStore = ordered.get();
+        SymSpell orderedSpell(std::move(ordered), 2, 7);
+        std::vector<std::pair<std::string, int64_t>> words;
+        for (int i = 0; i < 50000; ++i) {
+            words.emplace_back("dictionaryword" + std::to_string(i), 1000000 / (i + 1));
+        }
+        orderedSpell.createDictionary(words);
+        printResult("1,000 top-5 lookups (50K skewed dict)", runTopK(orderedSpell));
+        orderedStore->freeze(BucketOrder::Frequency);
+        printResult("1,000 top-5 lookups (50K skewed, ordered)", runTopK(orderedSpell));
+
+        // Words of fewer characters than the prefix, with a two-byte letter: byte deletes also
+        // split the letter and reach further into the word.
+        std::vector<std::pair<std::string, int64_t>> accentedWords;
+        for (int i = 0; i < 50000; ++i) {
+            accentedWords.emplace_back("\xC3\xA9" + std::to_string(i), 100);
+        }
+        for (TextEncoding encoding : {TextEncoding::Bytes, TextEncoding::Utf8}) {
+            std::string mode = encoding == TextEncoding::Utf8 ? "UTF-8" : "bytes";
+            auto accentedStore = std::make_unique<MemoryStore>(2, 7);
+            auto* accented = accentedStore.get();
+            SymSpell accentedSpell(std::move(accentedStore), 2, 7, {}, encoding);
+            start = std::chrono::high_resolution_clock::now();
+            accentedSpell.createDictionary(accentedWords);
+            end = std::chrono::high_resolution_clock::now();
+            printResult("Create 50,000 accented entries (" + mode + ")",
+                        std::chrono::duration_cast<std::chrono::microseconds>(end - start));
+
+            start = std::chrono::high_resolution_clock::now();
+            for (int i = 0; i < 1000; ++i) {
+                accentedSpell.lookup("e" + std::to_string(i * 50), Verbosity::Closest);
+            }
+            end = std::chrono::high_resolution_clock::now();
+            printResult("1,000 accented lookups (" + mode + ")",
+                        std::chrono::duration_cast<std::chrono::microseconds>(end - start));
+            std::cout << "  Index bytes: " << accented->memoryUsage().total() << std::endl;
+        }
+    }
+
+    // Keys are longer than the small-string buffer, so every std::string temporary allocates.
+    void benchmarkExactHits() {
+        std::cout << "\n--- Exact Hits (50,000 entries) ---" << std::endl;
+
+        std::vector<std::string> words;
+        for (int i = 0; i < 50000; ++i) {
+            words.push_back("dictionaryword" + std::to_string(i));
+        }
+        std::vector<std::string_view> keys(words.begin(), words.end());
+
+        struct Hash {
+            using is_transparent = void;
+            size_t operator()(std::string_view key) const {
+                return std::hash<std::string_view>{}(key);
+            }
+        };
+        std::unordered_map<std::string, int64_t> plain;
+        std::unordered_map<std::string, int64_t, Hash, std::equal_to<>> transparent;
+        for (const auto& word : words) {
+            plain.emplace(word, 1);
+            transparent.emplace(word, 1);
+        }
+
+        auto timeProbes = [&](auto&& probe) {
+            int64_t sum = 0;
+            auto begin = std::chrono::high_resolution_clock::now();
+            for (int iter = 0; iter < 10; ++iter) {
+                for (auto key : keys) {
+                    sum += probe(key);
+                }
+            }
+            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::high_resolution_clock::now() - begin);
+            return std::make_pair(elapsed, sum);
+        };
+        auto [plainTime, plainSum] =
+            timeProbes([&](std::string_view key) { return plain.find(std::string(key))->second; });
+        auto [viewTime, viewSum] =
+            timeProbes([&](std::string_view key) { return transparent.find(key)->second; });
+        printResult("500,000 map probes (std::string key)", plainTime, 500000);
+        printResult("500,000 map probes (string_view key)", viewTime, 500000);
+        if (plainSum != viewSum) {
+            std::cout << "  Probe results differ!" << std::endl;
+        }
+
+        SymSpell spell(std::make_unique<MemoryStore>(2, 7), 2, 7);
+        spell.setCountThreshold(1000);
+        for (const auto& word : words) {
+            spell.createDictionaryEntry(word, 1000);
+            spell.createDictionaryEntry("staged" + word, 1);
+        }
+
+        LookupContext context;
+        size_t hits = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int iter = 0; iter < 10; ++iter) {
+            for (auto key : keys) {
+                hits += spell.lookup(key, context, Verbosity::Top, 0).size();
+            }
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        printResult("500,000 exact-hit lookups",
+                    std::chrono::duration_cast<std::chrono::microseconds>(end - start), 500000);
+        std::cout << "  Hits: " << hits << std::endl;
+
+        std::vector<std::string> staged;
+        for (const auto& word : words) {
+            staged.push_back("staged" + word);
+        }
+        start = std::chrono::high_resolution_clock::now();
+        for (int iter = 0; iter < 10; ++iter) {
+            for (const auto& word : staged) {
+                spell.createDictionaryEntry(word, 1);
+            }
+        }
+        end = std::chrono::high_resolution_clock::now();
+        printResult("500,000 staged count updates",
+                    std::chrono::duration_cast<std::chrono::microseconds>(end - start), 500000);
+    }
+
+    // Index size against false-positive bucket rows, per compaction level.
+    void benchmarkHashCompaction() {
+        std::cout << "\n--- Hash Compaction (50,000 entries) ---" << std::endl;
+
+        // Random words: shared prefixes would leave only a handful of distinct deletes.
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<int> letter('a', 'z');
+        std::uniform_int_distribution<int> length(5, 10);
+        std::vector<std::pair<std::string, int64_t>> words;
+        for (int i = 0; i < 50000; ++i) {
+            std::string word(static_cast<size_t>(length(rng)), 'a');
+            for (char& c : word) {
+                c = static_cast<char>(letter(rng));
+            }
+            words.emplace_back(std::move(word), 100);
+        }
+        std::vector<std::string> queries;
+        for (int i = 0; i < 1000; ++i) {
+            std::string query = words[static_cast<size_t>(i) * 37].first;
+            std::swap(query[1], query[2]);
+            queries.push_back(std::move(query));
+        }
+
+        for (HashOptions options : {HashOptions{64, 0}, HashOptions{32, 0}, HashOptions{64, 44},
+                                    HashOptions{64, 48}}) {
+            SymSpell spell(std::make_unique<MemoryStore>(2, 7), 2, 7, options);
+            spell.createDictionary(words);
+            auto& store = static_cast<MemoryStore&>(spell.store());
+            store.freeze();
+
+            LookupContext context;
+            auto start = std::chrono::high_resolution_clock::now();
+            for (const auto& query : queries) {
+                spell.lookup(query, context, Verbosity::Closest);
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+
+            std::string name = "1,000 lookups (" + std::to_string(options.bits) + "-bit, level " +
+                               std::to_string(options.compactLevel) + ")";
+            printResult(name, std::chrono::duration_cast<std::chrono::microseconds>(end - start),
+                        1000);
+            const auto& stats = context.probeStats();
+            std::cout << "  Buckets: " << store.bucketCount() << ", rows checked: " << stats.rows
+                      << ", collisions: " << stats.collisions << std::endl;
+        }
     }
 };
 
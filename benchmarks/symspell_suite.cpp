@@ -0,0 +1,593 @@
+// Workload benchmark suite: builds a dictionary from a frequency file (or a synthetic Zipf
+// corpus of the same shape), replays typo-distributed queries against MemoryStore and
+// SQLiteStore, and reports latency percentiles, recall, build time, thread scaling and peak
+// RSS, optionally as JSON. With --baseline it compares the mean latencies of a previous JSON
+// report and exits with status 1 if any scenario regressed beyond --tolerance percent.
+//
+//   symspell_suite --dictionary frequency_dictionary_en_82_765.txt --json out.json
+//   symspell_suite --words 1000000 --baseline main.json --tolerance 15
+
+#include <sqlite3.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <symspell/symspell.hpp>
+#include <symspell/symspell_sqlite.hpp>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+using namespace yams::symspell;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct SuiteOptions {
+    std::string dictionary; // "term count" per line; empty for a synthetic corpus.
+    size_t words = 0; // Cap on terms; 0 reads the whole file, or makes 100,000 synthetic ones.
+    size_t queries = 2000;
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    int maxEditDistance = 2;
+    bool sqlite = true;
+    std::string sqlitePath = "/tmp/symspell_suite.db";
+    SQLiteSchema sqliteSchema = SQLiteSchema::Rows;
+    std::string json;
+    std::string baseline;
+    double tolerance = 10.0;
+    uint32_t seed = 42;
+};
+
+struct Query {
+    std::string text;
+    std::string source; // The dictionary word the typos were applied to.
+};
+
+struct ScenarioResult {
+    std::string name;
+    std::string store;
+    std::string pass;
+    std::string verbosity;
+    int distance = 0;
+    size_t queries = 0;
+    double totalMs = 0;
+    double meanUs = 0;
+    double p50Us = 0;
+    double p99Us = 0;
+    double recall = 0; // Share of queries whose source word is among the suggestions.
+};
+
+struct ScalingResult {
+    size_t threads = 0;
+    size_t queries = 0;
+    double totalMs = 0;
+    double queriesPerSecond = 0;
+};
+
+struct BuildResult {
+    std::string store;
+    size_t terms = 0;
+    size_t buckets = 0;
+    double milliseconds = 0;
+};
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+long peakRssKb() {
+#ifndef _WIN32
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        return usage.ru_maxrss; // Kilobytes on Linux.
+    }
+#endif
+    return 0;
+}
+
+const char* verbosityName(Verbosity verbosity) {
+    switch (verbosity) {
+        case Verbosity::Top:
+            return "top";
+        case Verbosity::Closest:
+            return "closest";
+        case Verbosity::All:
+            return "all";
+    }
+    return "";
+}
+
+// Words with English-like letter and length distributions, ranked by a Zipf frequency.
+std::vector<std::pair<std::string, int64_t>> syntheticCorpus(size_t count, uint32_t seed) {
+    static constexpr double kLetterWeights[26] = {8.2, 1.5, 2.8, 4.3, 12.7, 2.2, 2.0, 6.1, 7.0,
+                                                  0.2, 0.8, 4.0, 2.4, 6.7, 7.5, 1.9, 0.1, 6.0,
+                                                  6.3, 9.1, 2.8, 1.0, 2.4, 0.2, 2.0, 0.1};
+    static constexpr double kLengthWeights[] = {0, 0, 2, 6, 10, 12, 13, 13, 11, 9, 7, 5, 4, 3, 2,
+                                                1};
+    std::mt19937 rng(seed);
+    std::discrete_distribution<int> letter(std::begin(kLetterWeights), std::end(kLetterWeights));
+    std::discrete_distribution<int> length(std::begin(kLengthWeights), std::end(kLengthWeights));
+
+    std::vector<std::pair<std::string, int64_t>> entries;
+    std::unordered_set<std::string> seen;
+    entries.reserve(count);
+    while (entries.size() < count) {
+        std::string word(static_cast<size_t>(length(rng)), 'a');
+        for (char& c : word) {
+            c = static_cast<char>('a' + letter(rng));
+        }
+        if (seen.insert(word).second) {
+            auto rank = static_cast<double>(entries.size() + 1);
+            entries.emplace_back(std::move(word), std::max<int64_t>(1, 100000000.0 / rank));
+        }
+    }
+    return entries;
+}
+
+std::vector<std::pair<std::string, int64_t>> loadDictionary(const std::string& path,
+                                                            size_t limit) {
+    std::vector<std::pair<std::string, int64_t>> entries;
+    std::ifstream in(path);
+    std::string term;
+    int64_t count = 0;
+    while (entries.size() < limit && in >> term >> count) {
+        if (count > 0) {
+            entries.emplace_back(term, count);
+        }
+    }
+    return entries;
+}
+
+// Applies `edits` random deletions, insertions, substitutions and adjacent transpositions.
+std::string applyTypos(std::string word, int edits, std::mt19937& rng) {
+    std::uniform_int_distribution<int> letter('a', 'z');
+    for (int e = 0; e < edits; ++e) {
+        int op = std::uniform_int_distribution<int>(0, 3)(rng);
+        if (word.size() < 2) {
+            op = 1;
+        }
+        size_t at = std::uniform_int_distribution<size_t>(0, word.size() - 1)(rng);
+        switch (op) {
+            case 0:
+                word.erase(at, 1);
+                break;
+            case 1:
+                word.insert(at, 1, static_cast<char>(letter(rng)));
+                break;
+            case 2: {
+                char replacement = word[at];
+                while (replacement == word[at]) {
+                    replacement = static_cast<char>(letter(rng));
+                }
+                word[at] = replacement;
+                break;
+            }
+            default:
+                if (at + 1 == word.size()) {
+                    --at;
+                }
+                std::swap(word[at], word[at + 1]);
+                break;
+        }
+    }
+    return word;
+}
+
+// Queries drawn by word frequency, as a live query stream would be.
+std::vector<Query> makeQueries(const std::vector<std::pair<std::string, int64_t>>& entries,
+                               size_t count, int distance, uint32_t seed) {
+    std::mt19937 rng(seed + static_cast<uint32_t>(distance));
+    std::vector<double> weights;
+    weights.reserve(entries.size());
+    for (const auto& [term, frequency] : entries) {
+        weights.push_back(static_cast<double>(frequency));
+    }
+    std::discrete_distribution<size_t> pick(weights.begin(), weights.end());
+    std::vector<Query> queries;
+    queries.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        const std::string& source = entries[pick(rng)].first;
+        queries.push_back(Query{applyTypos(source, distance, rng), source});
+    }
+    return queries;
+}
+
+ScenarioResult runQueries(const SymSpell& spell, const std::vector<Query>& queries,
+                          Verbosity verbosity) {
+    LookupContext context;
+    std::vector<double> latencies;
+    latencies.reserve(queries.size());
+    size_t found = 0;
+    auto start = Clock::now();
+    for (const auto& query : queries) {
+        auto begin = Clock::now();
+        auto results = spell.lookup(query.text, context, verbosity);
+        latencies.push_back(
+            std::chrono::duration<double, std::micro>(Clock::now() - begin).count());
+        found += std::any_of(results.begin(), results.end(),
+                             [&](const Suggestion& s) { return s.term == query.source; });
+    }
+    ScenarioResult result;
+    result.totalMs = millisecondsSince(start);
+    result.queries = queries.size();
+    std::sort(latencies.begin(), latencies.end());
+    if (!latencies.empty()) {
+        double sum = 0;
+        for (double latency : latencies) {
+            sum += latency;
+        }
+        result.meanUs = sum / static_cast<double>(latencies.size());
+        result.p50Us = latencies[latencies.size() / 2];
+        result.p99Us = latencies[std::min(latencies.size() - 1, latencies.size() * 99 / 100)];
+        result.recall = static_cast<double>(found) / static_cast<double>(latencies.size());
+    }
+    return result;
+}
+
+class Suite {
+public:
+    explicit Suite(SuiteOptions options) : options_(std::move(options)) {}
+
+    int run() {
+        loadCorpus();
+        for (int distance = 0; distance <= 3; ++distance) {
+            queries_.push_back(makeQueries(entries_, options_.queries, distance, options_.seed));
+        }
+
+        std::cout << "=== SymSpell Benchmark Suite ===" << std::endl;
+        std::cout << entries_.size() << " terms (" << corpusName() << "), " << options_.queries
+                  << " queries per distance, maxEditDistance " << options_.maxEditDistance
+                  << std::endl;
+
+        benchmarkMemoryStore();
+        if (options_.sqlite) {
+            benchmarkSQLiteStore();
+        }
+        peakRssKb_ = peakRssKb();
+        std::cout << "\nPeak RSS: " << peakRssKb_ << " KB" << std::endl;
+
+        if (!options_.json.empty()) {
+            writeJson();
+        }
+        return options_.baseline.empty() ? 0 : compareBaseline();
+    }
+
+private:
+    std::string corpusName() const {
+        return options_.dictionary.empty() ? "synthetic zipf" : options_.dictionary;
+    }
+
+    void loadCorpus() {
+        if (options_.dictionary.empty()) {
+            entries_ = syntheticCorpus(options_.words != 0 ? options_.words : 100000,
+                                       options_.seed);
+        } else {
+            entries_ = loadDictionary(options_.dictionary,
+                                      options_.words != 0 ? options_.words : SIZE_MAX);
+        }
+        if (entries_.empty()) {
+            std::cerr << "No dictionary entries loaded" << std::endl;
+            std::exit(2);
+        }
+    }
+
+    void benchmarkMemoryStore() {
+        std::cout << "\n--- MemoryStore ---" << std::endl;
+        int maxEdit = options_.maxEditDistance;
+        SymSpell spell(std::make_unique<MemoryStore>(maxEdit, 7), maxEdit, 7);
+        auto start = Clock::now();
+        spell.createDictionary(entries_, BuildOptions{options_.threads});
+        auto& store = static_cast<MemoryStore&>(spell.store());
+        store.freeze(BucketOrder::Frequency);
+        recordBuild(BuildResult{"memory", store.termCount(), store.bucketCount(),
+                                millisecondsSince(start)});
+        buildRssKb_ = peakRssKb();
+        std::cout << "  Peak RSS after build: " << buildRssKb_ << " KB" << std::endl;
+
+        // The first pass warms the caches and the context buffers; the second is steady state.
+        runGrid(spell, "memory", "cold");
+        runGrid(spell, "memory", "warm");
+        benchmarkThreadScaling(spell);
+    }
+
+    void benchmarkSQLiteStore() {
+        std::cout << "\n--- SQLiteStore ---" << std::endl;
+        std::remove(options_.sqlitePath.c_str());
+        int maxEdit = options_.maxEditDistance;
+        {
+            sqlite3* db = openDatabase();
+            if (!db) {
+                return;
+            }
+            auto start = Clock::now();
+            {
+                auto store = std::make_unique<SQLiteStore>(db, maxEdit, 7);
+                SQLiteStore* sqlite = store.get();
+                SymSpell spell(std::move(store), maxEdit, 7);
+                if (!sqlite->beginBulkImport()) {
+                    std::cerr << "beginBulkImport failed" << std::endl;
+                }
+                spell.createDictionary(entries_, BuildOptions{options_.threads});
+                if (!sqlite->endBulkImport()) {
+                    std::cerr << "endBulkImport failed" << std::endl;
+                }
+            }
+            recordBuild(BuildResult{"sqlite", entries_.size(), 0, millisecondsSince(start)});
+            sqlite3_close(db);
+        }
+        std::ifstream file(options_.sqlitePath, std::ios::binary | std::ios::ate);
+        std::cout << "  Database size: " << static_cast<long long>(file.tellg()) / 1024 << " KB ("
+                  << (options_.sqliteSchema == SQLiteSchema::Packed ? "packed" : "rows")
+                  << " schema)" << std::endl;
+
+        // Cold: a fresh connection with an empty page cache (the OS file cache stays warm).
+        sqlite3* db = openDatabase();
+        if (!db) {
+            return;
+        }
+        {
+            SymSpell spell(std::make_unique<SQLiteStore>(db, maxEdit, 7), maxEdit, 7);
+            runGrid(spell, "sqlite", "cold");
+            runGrid(spell, "sqlite", "warm");
+        }
+        sqlite3_close(db);
+        std::remove(options_.sqlitePath.c_str());
+    }
+
+    sqlite3* openDatabase() {
+        sqlite3* db = nullptr;
+        if (sqlite3_open(options_.sqlitePath.c_str(), &db) != SQLITE_OK ||
+            !SQLiteStore::initializeDatabase(db, options_.sqliteSchema)) {
+            std::cerr << "Cannot open " << options_.sqlitePath << std::endl;
+            sqlite3_close(db);
+            return nullptr;
+        }
+        return db;
+    }
+
+    void runGrid(const SymSpell& spell, const std::string& store, const std::string& pass) {
+        for (Verbosity verbosity : {Verbosity::Top, Verbosity::Closest, Verbosity::All}) {
+            for (int distance = 0; distance <= 3; ++distance) {
+                ScenarioResult result = runQueries(spell, queries_[distance], verbosity);
+                result.store = store;
+                result.pass = pass;
+                result.verbosity = verbosityName(verbosity);
+                result.distance = distance;
+                result.name = store + "/" + pass + "/" + result.verbosity + "/d" +
+                              std::to_string(distance);
+                printScenario(result);
+                results_.push_back(std::move(result));
+            }
+        }
+    }
+
+    // lookupBatch over the distinct distance-1 queries at 1, 2, 4, ... threads.
+    void benchmarkThreadScaling(const SymSpell& spell) {
+        std::unordered_set<std::string_view> seen;
+        std::vector<std::string_view> inputs;
+        for (const auto& query : queries_[1]) {
+            if (seen.insert(query.text).second) {
+                inputs.push_back(query.text);
+            }
+        }
+        std::vector<size_t> counts;
+        for (size_t threads = 1; threads < options_.threads; threads *= 2) {
+            counts.push_back(threads);
+        }
+        counts.push_back(options_.threads);
+        for (size_t threads : counts) {
+            auto start = Clock::now();
+            auto results = spell.lookupBatch(inputs, Verbosity::Closest, -1,
+                                             BatchOptions{threads, 1});
+            ScalingResult scaling;
+            scaling.threads = threads;
+            scaling.queries = results.size();
+            scaling.totalMs = millisecondsSince(start);
+            scaling.queriesPerSecond =
+                scaling.totalMs > 0 ? static_cast<double>(results.size()) * 1000.0 / scaling.totalMs
+                                    : 0;
+            std::cout << "  lookupBatch, " << std::setw(3) << threads << " threads: " << std::fixed
+                      << std::setprecision(0) << std::setw(10) << scaling.queriesPerSecond
+                      << " queries/s" << std::endl;
+            scaling_.push_back(scaling);
+        }
+    }
+
+    void recordBuild(const BuildResult& build) {
+        std::cout << "  Build " << build.store << ": " << std::fixed << std::setprecision(1)
+                  << build.milliseconds << " ms";
+        if (build.buckets > 0) {
+            std::cout << ", " << build.buckets << " buckets";
+        }
+        std::cout << std::endl;
+        builds_.push_back(build);
+    }
+
+    static void printScenario(const ScenarioResult& r) {
+        std::cout << "  " << std::left << std::setw(26) << r.name << std::right << std::fixed
+                  << std::setprecision(2) << " mean " << std::setw(9) << r.meanUs << " us  p50 "
+                  << std::setw(9) << r.p50Us << " us  p99 " << std::setw(9) << r.p99Us
+                  << " us  recall " << std::setprecision(3) << r.recall << std::endl;
+    }
+
+    static std::string quoted(std::string_view s) {
+        std::string out = "\"";
+        for (char c : s) {
+            if (c == '"' || c == '\\') {
+                out += '\\';
+            }
+            out += c;
+        }
+        return out + "\"";
+    }
+
+    // One scenario per line, which keeps the report diffable and readable by compareBaseline().
+    void writeJson() const {
+        std::ofstream out(options_.json);
+        out << std::fixed << std::setprecision(3);
+        out << "{\n  \"config\": {\"corpus\": " << quoted(corpusName())
+            << ", \"terms\": " << entries_.size() << ", \"queries\": " << options_.queries
+            << ", \"max_edit_distance\": " << options_.maxEditDistance
+            << ", \"threads\": " << options_.threads << ", \"seed\": " << options_.seed << "},\n";
+        out << "  \"builds\": [\n";
+        for (size_t i = 0; i < builds_.size(); ++i) {
+            const auto& b = builds_[i];
+            out << "    {\"store\": " << quoted(b.store) << ", \"terms\": " << b.terms
+                << ", \"buckets\": " << b.buckets << ", \"build_ms\": " << b.milliseconds << "}"
+                << (i + 1 < builds_.size() ? ",\n" : "\n");
+        }
+        out << "  ],\n  \"results\": [\n";
+        for (size_t i = 0; i < results_.size(); ++i) {
+            const auto& r = results_[i];
+            out << "    {\"name\": " << quoted(r.name) << ", \"store\": " << quoted(r.store)
+                << ", \"pass\": " << quoted(r.pass) << ", \"verbosity\": " << quoted(r.verbosity)
+                << ", \"distance\": " << r.distance << ", \"queries\": " << r.queries
+                << ", \"total_ms\": " << r.totalMs << ", \"mean_us\": " << r.meanUs
+                << ", \"p50_us\": " << r.p50Us << ", \"p99_us\": " << r.p99Us
+                << ", \"recall\": " << r.recall << "}" << (i + 1 < results_.size() ? ",\n" : "\n");
+        }
+        out << "  ],\n  \"thread_scaling\": [\n";
+        for (size_t i = 0; i < scaling_.size(); ++i) {
+            const auto& s = scaling_[i];
+            out << "    {\"threads\": " << s.threads << ", \"queries\": " << s.queries
+                << ", \"total_ms\": " << s.totalMs << ", \"qps\": " << s.queriesPerSecond << "}"
+                << (i + 1 < scaling_.size() ? ",\n" : "\n");
+        }
+        out << "  ],\n  \"peak_rss_kb\": " << peakRssKb_ << ",\n  \"build_peak_rss_kb\": "
+            << buildRssKb_ << "\n}\n";
+        std::cout << "\nWrote " << options_.json << std::endl;
+    }
+
+    // Reads the "name" and "mean_us" fields of every result line of a previous report.
+    static std::unordered_map<std::string, double> readBaseline(const std::string& path) {
+        std::unordered_map<std::string, double> means;
+        std::ifstream in(path);
+        std::string line;
+        auto field = [&](std::string_view key) -> std::string_view {
+            std::string pattern = "\"" + std::string(key) + "\": ";
+            size_t at = line.find(pattern);
+            if (at == std::string::npos) {
+                return {};
+            }
+            at += pattern.size();
+            size_t end = line.find_first_of(",}", at);
+            return std::string_view(line).substr(at, end - at);
+        };
+        while (std::getline(in, line)) {
+            std::string_view name = field("name");
+            std::string_view mean = field("mean_us");
+            if (name.size() >= 2 && !mean.empty()) {
+                means[std::string(name.substr(1, name.size() - 2))] =
+                    std::strtod(std::string(mean).c_str(), nullptr);
+            }
+        }
+        return means;
+    }
+
+    int compareBaseline() const {
+        auto baseline = readBaseline(options_.baseline);
+        if (baseline.empty()) {
+            std::cerr << "No results in baseline " << options_.baseline << std::endl;
+            return 2;
+        }
+        std::cout << "\n--- Against " << options_.baseline << " (tolerance " << options_.tolerance
+                  << "%) ---" << std::endl;
+        size_t regressions = 0;
+        for (const auto& r : results_) {
+            auto it = baseline.find(r.name);
+            if (it == baseline.end() || it->second <= 0) {
+                continue;
+            }
+            double change = (r.meanUs - it->second) / it->second * 100.0;
+            if (change > options_.tolerance) {
+                ++regressions;
+                std::cout << "  REGRESSION " << std::left << std::setw(26) << r.name << std::right
+                          << std::fixed << std::setprecision(2) << std::setw(9) << it->second
+                          << " -> " << std::setw(9) << r.meanUs << " us (+"
+                          << std::setprecision(1) << change << "%)" << std::endl;
+            }
+        }
+        std::cout << "  " << regressions << " regression(s)" << std::endl;
+        return regressions > 0 ? 1 : 0;
+    }
+
+    SuiteOptions options_;
+    std::vector<std::pair<std::string, int64_t>> entries_;
+    std::vector<std::vector<Query>> queries_; // Indexed by typo distance.
+    std::vector<BuildResult> builds_;
+    std::vector<ScenarioResult> results_;
+    std::vector<ScalingResult> scaling_;
+    long buildRssKb_ = 0;
+    long peakRssKb_ = 0;
+};
+
+void usage() {
+    std::cerr << "usage: symspell_suite [--dictionary FILE] [--words N] [--queries N]\n"
+                 "                      [--threads N] [--max-edit N] [--no-sqlite]\n"
+                 "                      [--sqlite-path FILE] [--sqlite-schema rows|packed]\n"
+                 "                      [--seed N] [--json FILE]\n"
+                 "                      [--baseline FILE] [--tolerance PERCENT]\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    SuiteOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                usage();
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+        if (arg == "--dictionary") {
+            options.dictionary = value();
+        } else if (arg == "--words") {
+            options.words = std::stoull(value());
+        } else if (arg == "--queries") {
+            options.queries = std::stoull(value());
+        } else if (arg == "--threads") {
+            options.threads = std::max<size_t>(1, std::stoull(value()));
+        } else if (arg == "--max-edit") {
+            options.maxEditDistance = std::stoi(value());
+        } else if (arg == "--no-sqlite") {
+            options.sqlite = false;
+        } else if (arg == "--sqlite-path") {
+            options.sqlitePath = value();
+        } else if (arg == "--sqlite-schema") {
+            std::string schema = value();
+            if (schema != "rows" && schema != "packed") {
+                usage();
+                return 2;
+            }
+            options.sqliteSchema = schema == "packed" ? SQLiteSchema::Packed : SQLiteSchema::Rows;
+        } else if (arg == "--seed") {
+            options.seed = static_cast<uint32_t>(std::stoul(value()));
+        } else if (arg == "--json") {
+            options.json = value();
+        } else if (arg == "--baseline") {
+            options.baseline = value();
+        } else if (arg == "--tolerance") {
+            options.tolerance = std::stod(value());
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    return Suite(std::move(options)).run();
+}
@@ -0,0 +1,349 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <symspell/edit_distance.hpp>
+#include <symspell/lookup_context.hpp>
+#include <symspell/symspell.hpp>
+
+namespace yams::symspell {
+
+// Word count of the corpus the dictionary counts come from; turns counts into probabilities.
+// This is the figure of the reference SymSpell English frequency dictionary.
+inline constexpr double kCorpusWordCount = 1024908267229.0;
+
+struct Segmentation {
+    std::string segmented;       // Input with word boundaries inserted
+    std::string corrected;       // Segmented and spelling-corrected
+    int distance = 0;            // Edits of the corrections plus inserted spaces
+    double logProbability = 0.0; // Sum of log10 word probabilities
+};
+
+// Multi-word correction on top of SymSpell::lookup, after the reference SymSpell
+// LookupCompound and WordSegmentation.
+//
+// Every sub-lookup of a query runs through one LookupContext, and the Verbosity::Top result
+// of each distinct (term, edit distance) is memoized. Tokens that repeat within a query,
+// split halves shared by several split points and substrings revisited by segmentation are
+// looked up once. The memo persists across calls. It is dropped when the dictionary version
+// changes, or at the start of a call once it holds `maxMemoEntries`. Tokens are separated by
+// ASCII whitespace and compared case-sensitively, like lookup(). Not thread-safe; keep one
+// per thread.
+class CompoundLookup {
+public:
+    explicit CompoundLookup(const SymSpell& spell, size_t maxMemoEntries = size_t{1} << 16)
+        : spell_(spell), maxMemoEntries_(maxMemoEntries) {}
+
+    CompoundLookup(const CompoundLookup&) = delete;
+    CompoundLookup& operator=(const CompoundLookup&) = delete;
+
+    // Corrects a whole phrase: each token may be kept, corrected, merged with the previous
+    // token or split in two, whichever needs the fewest edits, with ties going to the more
+    // probable reading (bigram counts where known). The result's distance is measured
+    // against the full input, and its frequency estimates the phrase's count.
+    Suggestion lookupCompound(std::string_view input, int maxEditDistance = -1) {
+        maxEditDistance = beginCall(maxEditDistance);
+
+        tokens_.clear();
+        for (size_t i = 0; i < input.size();) {
+            if (isSpace(input[i])) {
+                ++i;
+                continue;
+            }
+            size_t end = i;
+            while (end < input.size() && !isSpace(input[end])) {
+                ++end;
+            }
+            tokens_.push_back(input.substr(i, end - i));
+            i = end;
+        }
+
+        parts_.clear();
+        bool lastCombined = false;
+        for (size_t i = 0; i < tokens_.size(); ++i) {
+            std::string_view token = tokens_[i];
+            const Best& best = top(token, maxEditDistance);
+
+            // Merge with the previous token when that is cheaper, e.g. "th e" -> "the".
+            if (i > 0 && !lastCombined) {
+                combined_.assign(tokens_[i - 1]).append(token);
+                const Best& merged = top(combined_, maxEditDistance);
+                if (merged.found) {
+                    const Suggestion& previous = parts_.back();
+                    Suggestion current = best.found ? best.suggestion()
+                                                    : unknown(token, maxEditDistance);
+                    int separate = previous.distance + current.distance;
+                    if (merged.distance + 1 < separate ||
+                        (merged.distance + 1 == separate &&
+                         static_cast<double>(merged.frequency) >
+                             static_cast<double>(previous.frequency) / kCorpusWordCount *
+                                 static_cast<double>(current.frequency))) {
+                        parts_.back() = merged.suggestion();
+                        ++parts_.back().distance;
+                        lastCombined = true;
+                        continue;
+                    }
+                }
+            }
+            lastCombined = false;
+
+            if (best.found && (best.distance == 0 || token.size() == 1)) {
+                parts_.push_back(best.suggestion());
+                continue;
+            }
+            parts_.push_back(bestSplit(token, best, maxEditDistance));
+        }
+
+        Suggestion result{{}, 0, 0};
+        double count = kCorpusWordCount;
+        for (const auto& part : parts_) {
+            if (!result.term.empty()) {
+                result.term.push_back(' ');
+            }
+            result.term.append(part.term);
+            count *= static_cast<double>(part.frequency) / kCorpusWordCount;
+        }
+        result.frequency = static_cast<int64_t>(count);
+        result.distance = fullDistance(input, result.term);
+        return result;
+    }
+
+    // Splits `input` into words by inserting spaces, correcting each word on the way. Spaces
+    // already present are kept as candidate boundaries. Words are at most `maxSegmentLength`
+    // bytes; 0 uses the dictionary's longest word. Runs in O(n * maxSegmentLength) lookups,
+    // most of them memoized after the first few positions.
+    Segmentation wordSegmentation(std::string_view input, int maxEditDistance = -1,
+                                  size_t maxSegmentLength = 0) {
+        maxEditDistance = beginCall(maxEditDistance);
+        if (maxSegmentLength == 0) {
+            maxSegmentLength = spell_.maxWordLength() > 0
+                                   ? static_cast<size_t>(spell_.maxWordLength())
+                                   : input.size();
+        }
+        size_t width = std::max<size_t>(1, std::min(maxSegmentLength, input.size()));
+
+        // compositions[(circular + i) % width] is the best split of the input up to i bytes
+        // past the current position.
+        std::vector<Segmentation> compositions(width);
+        size_t circular = width - 1;
+
+        for (size_t j = 0; j < input.size(); ++j) {
+            size_t longest = std::min(input.size() - j, maxSegmentLength);
+            for (size_t i = 1; i <= longest; ++i) {
+                std::string_view raw = input.substr(j, i);
+                int separatorLength = 0;
+                if (isSpace(raw[0])) {
+                    raw.remove_prefix(1);
+                } else {
+                    separatorLength = 1;
+                }
+                part_.clear();
+                for (char c : raw) {
+                    if (c != ' ') {
+                        part_.push_back(c);
+                    }
+                }
+                // Removed spaces count as edits.
+                int edits = static_cast<int>(raw.size() - part_.size());
+
+                const Best& best = top(part_, maxEditDistance);
+                std::string_view word;
+                double logProbability;
+                if (best.found) {
+                    word = best.term;
+                    edits += best.distance;
+                    logProbability =
+                        std::log10(static_cast<double>(best.frequency) / kCorpusWordCount);
+                } else {
+                    // Unknown words are penalized by length, as in the reference.
+                    word = part_;
+                    edits += static_cast<int>(part_.size());
+                    logProbability =
+                        std::log10(10.0 / (kCorpusWordCount *
+                                           std::pow(10.0, static_cast<double>(part_.size()))));
+                }
+
+                size_t destination = (i + circular) % width;
+                Segmentation& target = compositions[destination];
+                if (j == 0) {
+                    target.segmented.assign(part_);
+                    target.corrected.assign(word);
+                    target.distance = edits;
+                    target.logProbability = logProbability;
+                    continue;
+                }
+
+                const Segmentation& source = compositions[circular];
+                int distance = source.distance + separatorLength + edits;
+                bool sameDistance =
+                    source.distance + edits == target.distance || distance == target.distance;
+                if (i == maxSegmentLength ||
+                    (sameDistance &&
+                     target.logProbability < source.logProbability + logProbability) ||
+                    distance < target.distance) {
+                    target.segmented.assign(source.segmented).append(1, ' ').append(part_);
+                    target.corrected.assign(source.corrected).append(1, ' ').append(word);
+                    target.distance = distance;
+                    target.logProbability = source.logProbability + logProbability;
+                }
+            }
+            circular = (circular + 1) % width;
+        }
+
+        return input.empty() ? Segmentation{} : std::move(compositions[circular]);
+    }
+
+    // Sub-lookups that missed the memo and went to SymSpell::lookup.
+    uint64_t lookups() const { return lookups_; }
+    size_t memoSize() const { return memo_.size(); }
+    void clearMemo() { memo_.clear(); }
+
+private:
+    struct Best {
+        bool found;
+        int distance;
+        int64_t frequency;
+        std::string term;
+
+        Suggestion suggestion() const { return Suggestion{term, distance, frequency}; }
+    };
+
+    struct KeyHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view key) const {
+            return std::hash<std::string_view>{}(key);
+        }
+    };
+
+    static bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+    // Count estimate of an unknown word: shrinks tenfold per byte.
+    static Suggestion unknown(std::string_view token, int maxEditDistance) {
+        return Suggestion{std::string(token), maxEditDistance + 1,
+                          static_cast<int64_t>(
+                              10.0 / std::pow(10.0, static_cast<double>(token.size())))};
+    }
+
+    int beginCall(int maxEditDistance) {
+        if (memoVersion_ != spell_.dictionaryVersion() || memo_.size() >= maxMemoEntries_) {
+            memo_.clear();
+            memoVersion_ = spell_.dictionaryVersion();
+        }
+        if (maxEditDistance < 0 || maxEditDistance > spell_.maxEditDistance()) {
+            maxEditDistance = spell_.maxEditDistance();
+        }
+        return maxEditDistance;
+    }
+
+    // Memoized Verbosity::Top lookup. References stay valid until the next beginCall().
+    const Best& top(std::string_view term, int maxEditDistance) {
+        key_.assign(1, static_cast<char>(maxEditDistance));
+        key_.append(term);
+        if (auto it = memo_.find(std::string_view(key_)); it != memo_.end()) {
+            return it->second;
+        }
+        ++lookups_;
+        auto results = spell_.lookup(term, context_, Verbosity::Top, maxEditDistance);
+        Best best = results.empty() ? Best{false, 0, 0, {}}
+                                    : Best{true, results[0].distance, results[0].frequency,
+                                           results[0].term};
+        return memo_.emplace(key_, std::move(best)).first->second;
+    }
+
+    // Best reading of a token that is not an exact word: its own correction or a split into
+    // two corrected words, preferring fewer edits and then the higher count.
+    Suggestion bestSplit(std::string_view token, const Best& best, int maxEditDistance) {
+        bool haveBest = best.found;
+        Suggestion chosen = haveBest ? best.suggestion() : Suggestion{{}, 0, 0};
+        if (token.size() <= 1) {
+            return haveBest ? chosen : unknown(token, maxEditDistance);
+        }
+
+        for (size_t j = 1; j < token.size(); ++j) {
+            const Best& first = top(token.substr(0, j), maxEditDistance);
+            if (!first.found) {
+                continue;
+            }
+            const Best& second = top(token.substr(j), maxEditDistance);
+            if (!second.found) {
+                continue;
+            }
+
+            Suggestion split{first.term + " " + second.term, 0, 0};
+            int distance = detail::scalarDistance(token, split.term, maxEditDistance, rows_);
+            if (haveBest) {
+                if (distance > chosen.distance) {
+                    continue;
+                }
+                if (distance < chosen.distance) {
+                    haveBest = false;
+                }
+            }
+            split.distance = distance;
+
+            bool rejoins = token.size() == first.term.size() + second.term.size() &&
+                           token.starts_with(first.term) && token.ends_with(second.term);
+            if (auto bigram = spell_.bigramFrequency(first.term, second.term)) {
+                split.frequency = *bigram;
+                if (best.found) {
+                    if (rejoins) {
+                        split.frequency = std::max(split.frequency, best.frequency + 2);
+                    } else if (first.term == best.term || second.term == best.term) {
+                        split.frequency = std::max(split.frequency, best.frequency + 1);
+                    }
+                } else if (rejoins) {
+                    split.frequency =
+                        std::max(split.frequency, std::max(first.frequency, second.frequency) + 2);
+                }
+            } else {
+                // Without a bigram count, assume independence, capped below every known bigram.
+                split.frequency =
+                    std::min(spell_.minBigramCount(),
+                             static_cast<int64_t>(static_cast<double>(first.frequency) /
+                                                  kCorpusWordCount *
+                                                  static_cast<double>(second.frequency)));
+            }
+
+            if (!haveBest || split.frequency > chosen.frequency) {
+                chosen = std::move(split);
+                haveBest = true;
+            }
+        }
+        return haveBest ? chosen : unknown(token, maxEditDistance);
+    }
+
+    int fullDistance(std::string_view a, std::string_view b) {
+        return detail::scalarDistance(a, b, static_cast<int>(a.size() + b.size()), rows_);
+    }
+
+    const SymSpell& spell_;
+    size_t maxMemoEntries_;
+    uint64_t memoVersion_ = 0;
+    uint64_t lookups_ = 0;
+    LookupContext context_;
+    std::unordered_map<std::string, Best, KeyHash, std::equal_to<>> memo_;
+    std::vector<std::string_view> tokens_;
+    std::vector<Suggestion> parts_;
+    std::string key_;
+    std::string combined_;
+    std::string part_;
+    std::vector<int> rows_;
+};
+
+inline Suggestion lookupCompound(const SymSpell& spell, std::string_view input,
+                                 int maxEditDistance = -1) {
+    return CompoundLookup(spell).lookupCompound(input, maxEditDistance);
+}
+
+inline Segmentation wordSegmentation(const SymSpell& spell, std::string_view input,
+                                     int maxEditDistance = -1, size_t maxSegmentLength = 0) {
+    return CompoundLookup(spell).wordSegmentation(input, maxEditDistance, maxSegmentLength);
+}
+
+} // namespace yams::symspell
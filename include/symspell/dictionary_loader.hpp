@@ -0,0 +1,279 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <symspell/result.hpp>
+#include <symspell/symspell.hpp>
+
+namespace yams::symspell {
+
+// Streaming dictionary ingestion. Two input formats are understood:
+//
+//  - frequency files: one "term count" pair per line, whitespace separated, the format of the
+//    reference SymSpell dictionaries and of SymSpell::createDictionary(std::istream&). Lines
+//    without a positive count are skipped.
+//  - raw text corpora: split into tokens (see CorpusTokenizer) and counted. Every occurrence
+//    counts 1, so the dictionary ends up exactly as if createDictionaryEntry(token) had been
+//    called for each token in order: accumulation and the count threshold (setCountThreshold)
+//    apply to the totals.
+//
+// Files are memory-mapped and parsed in place. Terms are views into the mapping (frequency
+// files) or into one arena of distinct tokens (corpora), so parsing allocates per distinct
+// token at most, never per line, and the whole input reaches the bulk builder,
+// SymSpell::createDictionary(), in one call. Streams are read in chunks of
+// LoadOptions::chunkBytes; a frequency stream is handed to the builder chunk by chunk, which
+// bounds memory for inputs of any size.
+
+struct LoadOptions {
+    BuildOptions build;
+    // Read size for streams and for files that cannot be mapped.
+    size_t chunkBytes = size_t{16} << 20;
+    // Corpora: fold ASCII letters of tokens to lower case, as the reference implementation does.
+    bool lowercase = true;
+};
+
+struct LoadStats {
+    uint64_t bytes = 0;
+    uint64_t lines = 0;   // Frequency files: non-empty lines.
+    uint64_t skipped = 0; // Frequency files: lines without a term and a positive count.
+    uint64_t tokens = 0;  // Corpora: tokens counted.
+    uint64_t entries = 0; // Distinct (corpora) or parsed (frequency files) entries built from.
+    size_t termsAdded = 0;
+};
+
+namespace detail {
+
+inline bool isLoaderSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// Parses one "term count" line, without its '\n'. Anything after the count is ignored.
+inline bool parseFrequencyLine(std::string_view line, std::string_view& term, int64_t& count) {
+    size_t begin = 0;
+    while (begin < line.size() && isLoaderSpace(line[begin])) {
+        ++begin;
+    }
+    size_t end = begin;
+    while (end < line.size() && !isLoaderSpace(line[end])) {
+        ++end;
+    }
+    size_t digits = end;
+    while (digits < line.size() && isLoaderSpace(line[digits])) {
+        ++digits;
+    }
+    if (end == begin || digits == end) {
+        return false;
+    }
+    if (line[digits] == '+') {
+        ++digits;
+    }
+    int64_t value = 0;
+    auto [ptr, ec] = std::from_chars(line.data() + digits, line.data() + line.size(), value);
+    if (ec != std::errc() || value <= 0) {
+        return false;
+    }
+    term = line.substr(begin, end - begin);
+    count = value;
+    return true;
+}
+
+// Calls `onEntry(term, count)` for every valid line of `text`. A last line without '\n' is
+// parsed too; callers feeding partial input pass complete lines only.
+template <typename OnEntry>
+void parseFrequencyText(std::string_view text, LoadStats& stats, OnEntry&& onEntry) {
+    stats.bytes += text.size();
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t newline = text.find('\n', pos);
+        size_t lineEnd = newline == std::string_view::npos ? text.size() : newline;
+        std::string_view line = text.substr(pos, lineEnd - pos);
+        pos = lineEnd + 1;
+
+        std::string_view term;
+        int64_t count = 0;
+        if (parseFrequencyLine(line, term, count)) {
+            ++stats.lines;
+            ++stats.entries;
+            onEntry(term, count);
+        } else if (line.find_first_not_of(" \t\r\v\f") != std::string_view::npos) {
+            ++stats.lines;
+            ++stats.skipped;
+        }
+    }
+}
+
+} // namespace detail
+
+// Splits text into tokens and counts them. A token is a maximal run of ASCII letters and
+// digits, apostrophes and bytes >= 0x80, so UTF-8 encoded letters (and the typographic
+// apostrophe) stay inside words, while punctuation, '_' and '-' separate them, like the
+// reference's ['’\w-[_]]+ pattern. Distinct tokens are copied once into an arena; counting
+// an already seen token allocates nothing.
+class CorpusTokenizer {
+public:
+    explicit CorpusTokenizer(bool lowercase = true) : lowercase_(lowercase) {}
+
+    CorpusTokenizer(const CorpusTokenizer&) = delete;
+    CorpusTokenizer& operator=(const CorpusTokenizer&) = delete;
+
+    static bool isTokenByte(unsigned char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+               c == '\'' || c >= 0x80;
+    }
+
+    // Counts the tokens of `text`. The text must end on a token boundary; split input with
+    // completeTokens() first.
+    void add(std::string_view text) {
+        bytes_ += text.size();
+        const auto* data = reinterpret_cast<const unsigned char*>(text.data());
+        size_t pos = 0;
+        while (pos < text.size()) {
+            while (pos < text.size() && !isTokenByte(data[pos])) {
+                ++pos;
+            }
+            size_t begin = pos;
+            while (pos < text.size() && isTokenByte(data[pos])) {
+                ++pos;
+            }
+            if (pos > begin) {
+                count(text.substr(begin, pos - begin));
+            }
+        }
+    }
+
+    // Length of the prefix of `text` that ends on a token boundary: all of it when `final`,
+    // otherwise up to the last non-token byte, as a token may continue in the next chunk.
+    static size_t completeTokens(std::string_view text, bool final) {
+        if (final) {
+            return text.size();
+        }
+        size_t end = text.size();
+        while (end > 0 && isTokenByte(static_cast<unsigned char>(text[end - 1]))) {
+            --end;
+        }
+        return end;
+    }
+
+    uint64_t tokens() const { return tokens_; }
+    uint64_t bytes() const { return bytes_; }
+    size_t distinctTokens() const { return counts_.size(); }
+
+    // Distinct tokens with their counts, in no particular order. Views stay valid until the
+    // tokenizer is destroyed or cleared.
+    std::vector<DictionaryEntry> entries() const {
+        std::vector<DictionaryEntry> out;
+        out.reserve(counts_.size());
+        for (const auto& [token, count] : counts_) {
+            out.push_back(DictionaryEntry{token, count});
+        }
+        return out;
+    }
+
+    void clear() {
+        counts_.clear();
+        blocks_.clear();
+        used_ = 0;
+        tokens_ = 0;
+        bytes_ = 0;
+    }
+
+private:
+    static constexpr size_t kBlockBytes = size_t{1} << 20;
+
+    static bool isUpper(char c) { return c >= 'A' && c <= 'Z'; }
+
+    void count(std::string_view token) {
+        ++tokens_;
+        if (lowercase_ && std::any_of(token.begin(), token.end(), isUpper)) {
+            folded_.assign(token);
+            for (char& c : folded_) {
+                if (isUpper(c)) {
+                    c = static_cast<char>(c - 'A' + 'a');
+                }
+            }
+            token = folded_;
+        }
+        auto it = counts_.find(token);
+        if (it != counts_.end()) {
+            it->second = it->second == INT64_MAX ? INT64_MAX : it->second + 1;
+            return;
+        }
+        counts_.emplace(store(token), 1);
+    }
+
+    std::string_view store(std::string_view token) {
+        if (blocks_.empty() || used_ + token.size() > blockSize_) {
+            blockSize_ = std::max(kBlockBytes, token.size());
+            blocks_.push_back(std::make_unique<char[]>(blockSize_));
+            used_ = 0;
+        }
+        char* target = blocks_.back().get() + used_;
+        std::copy(token.begin(), token.end(), target);
+        used_ += token.size();
+        return std::string_view(target, token.size());
+    }
+
+    struct TokenHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view token) const {
+            return std::hash<std::string_view>{}(token);
+        }
+    };
+
+    bool lowercase_;
+    std::string folded_;
+    std::unordered_map<std::string_view, int64_t, TokenHash, std::equal_to<>> counts_;
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    size_t blockSize_ = 0;
+    size_t used_ = 0;
+    uint64_t tokens_ = 0;
+    uint64_t bytes_ = 0;
+};
+
+// In-memory inputs. Views into `text` only need to stay valid for the duration of the call.
+inline LoadStats loadFrequencies(SymSpell& spell, std::string_view text,
+                                 const LoadOptions& options = {}) {
+    LoadStats stats;
+    std::vector<DictionaryEntry> entries;
+    detail::parseFrequencyText(text, stats, [&](std::string_view term, int64_t count) {
+        entries.push_back(DictionaryEntry{term, count});
+    });
+    stats.termsAdded = spell.createDictionary(std::span<const DictionaryEntry>(entries),
+                                              options.build);
+    return stats;
+}
+
+inline LoadStats loadCorpus(SymSpell& spell, std::string_view text,
+                            const LoadOptions& options = {}) {
+    CorpusTokenizer tokenizer(options.lowercase);
+    tokenizer.add(text);
+    auto entries = tokenizer.entries();
+    LoadStats stats;
+    stats.bytes = tokenizer.bytes();
+    stats.tokens = tokenizer.tokens();
+    stats.entries = entries.size();
+    stats.termsAdded = spell.createDictionary(std::span<const DictionaryEntry>(entries),
+                                              options.build);
+    return stats;
+}
+
+// Streams, read in chunks of options.chunkBytes. Frequency entries are built chunk by chunk;
+// corpus tokens are counted over the whole stream and built once.
+LoadStats loadFrequencies(SymSpell& spell, std::istream& in, const LoadOptions& options = {});
+LoadStats loadCorpus(SymSpell& spell, std::istream& in, const LoadOptions& options = {});
+
+// Files, memory-mapped when possible and streamed otherwise.
+Result<LoadStats> loadFrequencyFile(SymSpell& spell, const std::string& path,
+                                    const LoadOptions& options = {});
+Result<LoadStats> loadCorpusFile(SymSpell& spell, const std::string& path,
+                                 const LoadOptions& options = {});
+
+} // namespace yams::symspell
@@ -0,0 +1,247 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <string_view>
+#include <vector>
+#include <symspell/utf8.hpp>
+
+namespace yams::symspell::detail {
+
+// Bounded optimal string alignment distance (Damerau-Levenshtein with adjacent transpositions,
+// no substring edited twice). Returns maxDistance + 1 as soon as the result is known to exceed
+// maxDistance. `rows` is caller-owned scratch and is only grown, never shrunk.
+template <typename Char>
+int scalarDistanceOf(std::basic_string_view<Char> s1, std::basic_string_view<Char> s2,
+                     int maxDistance, std::vector<int>& rows) {
+    int len1 = static_cast<int>(s1.size());
+    int len2 = static_cast<int>(s2.size());
+
+    if (std::abs(len1 - len2) > maxDistance) {
+        return maxDistance + 1;
+    }
+
+    size_t width = static_cast<size_t>(len2) + 1;
+    if (rows.size() < 3 * width) {
+        rows.resize(3 * width);
+    }
+    int* beforePrevious = rows.data();
+    int* previous = beforePrevious + width;
+    int* current = previous + width;
+
+    for (int j = 0; j <= len2; ++j) {
+        previous[j] = j;
+    }
+
+    for (int i = 1; i <= len1; ++i) {
+        current[0] = i;
+        int minRow = i;
+
+        for (int j = 1; j <= len2; ++j) {
+            int cost = (s1[i - 1] == s2[j - 1]) ? 0 : 1;
+            current[j] = std::min({previous[j] + 1, current[j - 1] + 1, previous[j - 1] + cost});
+
+            if (i > 1 && j > 1 && s1[i - 1] == s2[j - 2] && s1[i - 2] == s2[j - 1]) {
+                current[j] = std::min(current[j], beforePrevious[j - 2] + 1);
+            }
+
+            minRow = std::min(minRow, current[j]);
+        }
+
+        // No later row can drop below the minimum of this one, transpositions included.
+        if (minRow > maxDistance) {
+            return maxDistance + 1;
+        }
+
+        int* recycled = beforePrevious;
+        beforePrevious = previous;
+        previous = current;
+        current = recycled;
+    }
+
+    int distance = previous[len2];
+    return (distance > maxDistance) ? maxDistance + 1 : distance;
+}
+
+inline int scalarDistance(std::string_view s1, std::string_view s2, int maxDistance,
+                          std::vector<int>& rows) {
+    return scalarDistanceOf(s1, s2, maxDistance, rows);
+}
+
+// The same over code points (TextEncoding::Utf8 inputs too long for BitParallelPattern).
+inline int scalarDistance(std::u32string_view s1, std::u32string_view s2, int maxDistance,
+                          std::vector<int>& rows) {
+    return scalarDistanceOf(s1, s2, maxDistance, rows);
+}
+
+// Bit-parallel optimal string alignment distance for patterns of at most 64 characters: Myers'
+// bit-vector algorithm in Hyyrö's global-distance form with his transposition extension. One
+// column of the DP matrix is processed per text character in a handful of word operations.
+// The pattern's match masks are built once and reused for every text it is compared against.
+//
+// Characters are bytes after assign() and code points of UTF-8 text after assignUtf8(). In
+// the latter case ASCII characters keep their byte-indexed masks and the masks of the other
+// code points go to a small open-addressed table, so ASCII texts run the byte loop unchanged.
+class BitParallelPattern {
+public:
+    static constexpr size_t kMaxLength = 64;
+
+    BitParallelPattern() { std::fill(std::begin(peq_), std::end(peq_), 0); }
+
+    // Prepares `pattern` for matching. Returns false (leaving the object unusable until the next
+    // successful assign) if it is longer than kMaxLength. The bytes are copied.
+    bool assign(std::string_view pattern) {
+        clear();
+        if (pattern.size() > kMaxLength) {
+            return false;
+        }
+        length_ = pattern.size();
+        for (size_t i = 0; i < length_; ++i) {
+            pattern_[i] = static_cast<uint8_t>(pattern[i]);
+            peq_[pattern_[i]] |= uint64_t{1} << i;
+        }
+        return true;
+    }
+
+    // assign() over the code points of UTF-8 text (see utf8.hpp); distances are then in code
+    // points and texts must be passed to distanceUtf8().
+    bool assignUtf8(std::string_view pattern) {
+        clear();
+        for (size_t i = 0; i < pattern.size(); ++length_) {
+            if (length_ == kMaxLength) {
+                clear();
+                return false;
+            }
+            char32_t cp = decodeUtf8(pattern, i);
+            pattern_[length_] = cp;
+            maskOf(cp, true) |= uint64_t{1} << length_;
+        }
+        return true;
+    }
+
+    size_t length() const { return length_; }
+
+    int distance(std::string_view text, int maxDistance) const {
+        return run(static_cast<int>(text.size()), maxDistance,
+                   [&](int j) { return peq_[static_cast<uint8_t>(text[j])]; });
+    }
+
+    int distanceUtf8(std::string_view text, int maxDistance) const {
+        if (isAscii(text)) {
+            return distance(text, maxDistance);
+        }
+        size_t pos = 0;
+        return run(static_cast<int>(utf8Length(text)), maxDistance, [&](int) {
+            char32_t cp = decodeUtf8(text, pos);
+            return cp < 0x80 ? peq_[cp] : wideMask(cp);
+        });
+    }
+
+private:
+    static constexpr size_t kWideSlots = 128; // At least twice kMaxLength.
+
+    struct WideEntry {
+        char32_t cp = 0; // 0 marks a free slot; code point 0 is ASCII.
+        uint64_t mask = 0;
+    };
+
+    static size_t wideSlot(char32_t cp) { return ((cp * 2654435761u) >> 25) & (kWideSlots - 1); }
+
+    void clear() {
+        for (size_t i = 0; i < length_; ++i) {
+            if (pattern_[i] < 256) {
+                peq_[pattern_[i]] = 0;
+            }
+        }
+        if (wideCount_ > 0) {
+            std::fill(std::begin(wide_), std::end(wide_), WideEntry{});
+            wideCount_ = 0;
+        }
+        length_ = 0;
+    }
+
+    uint64_t& maskOf(char32_t cp, bool insert) {
+        if (cp < 0x80) {
+            return peq_[cp];
+        }
+        size_t slot = wideSlot(cp);
+        while (wide_[slot].cp != 0 && wide_[slot].cp != cp) {
+            slot = (slot + 1) & (kWideSlots - 1);
+        }
+        if (insert && wide_[slot].cp == 0) {
+            wide_[slot].cp = cp;
+            ++wideCount_;
+        }
+        return wide_[slot].mask;
+    }
+
+    uint64_t wideMask(char32_t cp) const {
+        if (wideCount_ == 0) {
+            return 0;
+        }
+        for (size_t slot = wideSlot(cp);; slot = (slot + 1) & (kWideSlots - 1)) {
+            if (wide_[slot].cp == cp) {
+                return wide_[slot].mask;
+            }
+            if (wide_[slot].cp == 0) {
+                return 0;
+            }
+        }
+    }
+
+    // The kernel over a text of n characters; matchMask(j) returns the pattern mask of the
+    // j-th one and is called once per character, in order.
+    template <typename MatchMask> int run(int n, int maxDistance, MatchMask&& matchMask) const {
+        int m = static_cast<int>(length_);
+
+        if (std::abs(m - n) > maxDistance) {
+            return maxDistance + 1;
+        }
+        if (m == 0) {
+            return n;
+        }
+
+        const uint64_t last = uint64_t{1} << (m - 1);
+        uint64_t vp = m == 64 ? ~uint64_t{0} : (uint64_t{1} << m) - 1;
+        uint64_t vn = 0;
+        uint64_t d0 = 0;
+        uint64_t pmPrevious = 0;
+        int score = m;
+
+        for (int j = 0; j < n; ++j) {
+            uint64_t pm = matchMask(j);
+            uint64_t tr = (((~d0) & pm) << 1) & pmPrevious;
+            d0 = (((pm & vp) + vp) ^ vp) | pm | vn | tr;
+            uint64_t hp = vn | ~(d0 | vp);
+            uint64_t hn = vp & d0;
+
+            if (hp & last) {
+                ++score;
+            } else if (hn & last) {
+                --score;
+            }
+
+            // The final distance is at least score minus the characters still to come.
+            if (score - (n - j - 1) > maxDistance) {
+                return maxDistance + 1;
+            }
+
+            uint64_t x = (hp << 1) | 1;
+            vn = x & d0;
+            vp = (hn << 1) | ~(x | d0);
+            pmPrevious = pm;
+        }
+
+        return score > maxDistance ? maxDistance + 1 : score;
+    }
+
+    uint64_t peq_[256];
+    WideEntry wide_[kWideSlots];
+    char32_t pattern_[kMaxLength] = {};
+    size_t length_ = 0;
+    size_t wideCount_ = 0;
+};
+
+} // namespace yams::symspell::detail
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include <symspell/term_dictionary.hpp>
+
+namespace yams::symspell {
+
+// Key of a delete bucket: a hash of the delete string, tagged with its length (see
+// HashOptions). 32-bit hashes are kept sign-extended, the values of indexes built before
+// hashes were widened.
+using DeleteHash = int64_t;
+
+// One slot of the open-addressed hash -> bucket table. A slot with count == 0 is empty.
+struct FlatBucketSlot {
+    DeleteHash hash;
+    uint32_t offset;
+    uint32_t count;
+};
+
+// Read-only view of a frozen delete index: an open-addressed, power-of-two sized slot table
+// pointing into one contiguous array of term ids (CSR layout). The view does not own its
+// memory, so the same probe code runs over owned vectors and memory-mapped snapshots.
+class FlatDeleteIndexView {
+public:
+    FlatDeleteIndexView() = default;
+    FlatDeleteIndexView(std::span<const FlatBucketSlot> slots, std::span<const TermId> ids)
+        : slots_(slots), ids_(ids) {}
+
+    std::span<const TermId> find(DeleteHash hash) const {
+        if (slots_.empty()) {
+            return {};
+        }
+        size_t mask = slots_.size() - 1;
+        for (size_t i = slotIndex(hash, mask);; i = (i + 1) & mask) {
+            const auto& slot = slots_[i];
+            if (slot.count == 0) {
+                return {};
+            }
+            if (slot.hash == hash) {
+                return ids_.subspan(slot.offset, slot.count);
+            }
+        }
+    }
+
+    std::span<const FlatBucketSlot> slots() const { return slots_; }
+    std::span<const TermId> ids() const { return ids_; }
+
+    static size_t slotIndex(DeleteHash hash, size_t mask) {
+        // Fibonacci mixing; the low bits of delete hashes carry the length tag, and compacted
+        // hashes have no high bits.
+        uint64_t h = (static_cast<uint64_t>(hash) ^ (static_cast<uint64_t>(hash) >> 32)) *
+                     0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(h >> 32) & mask;
+    }
+
+private:
+    std::span<const FlatBucketSlot> slots_;
+    std::span<const TermId> ids_;
+};
+
+// Owning frozen delete index, built once from the mutable bucket map.
+class FlatDeleteIndex {
+public:
+    FlatDeleteIndex() = default;
+
+    explicit FlatDeleteIndex(const std::unordered_map<DeleteHash, std::vector<TermId>>& buckets) {
+        size_t capacity = slotsFor(buckets.size());
+        slots_.assign(capacity, FlatBucketSlot{0, 0, 0});
+
+        size_t total = 0;
+        for (const auto& [hash, ids] : buckets) {
+            total += ids.size();
+        }
+        ids_.reserve(total);
+
+        size_t mask = capacity - 1;
+        for (const auto& [hash, ids] : buckets) {
+            if (ids.empty()) {
+                continue;
+            }
+            size_t i = FlatDeleteIndexView::slotIndex(hash, mask);
+            while (slots_[i].count != 0) {
+                i = (i + 1) & mask;
+            }
+            slots_[i] = FlatBucketSlot{hash, static_cast<uint32_t>(ids_.size()),
+                                       static_cast<uint32_t>(ids.size())};
+            ids_.insert(ids_.end(), ids.begin(), ids.end());
+        }
+    }
+
+    FlatDeleteIndexView view() const { return FlatDeleteIndexView(slots_, ids_); }
+
+    // Slot table size for `buckets` buckets: a power of two, at most two thirds full.
+    static size_t slotsFor(size_t buckets) {
+        size_t capacity = 16;
+        while (capacity < buckets + buckets / 2) {
+            capacity *= 2;
+        }
+        return capacity;
+    }
+
+    // Reorders the ids within every bucket by `less`; the slot table is unchanged.
+    template <typename Less> void sortBuckets(Less less) {
+        for (const auto& slot : slots_) {
+            if (slot.count > 1) {
+                auto begin = ids_.begin() + slot.offset;
+                std::sort(begin, begin + slot.count, less);
+            }
+        }
+    }
+
+    size_t slotCount() const { return slots_.size(); }
+    size_t idCount() const { return ids_.size(); }
+
+private:
+    std::vector<FlatBucketSlot> slots_;
+    std::vector<TermId> ids_;
+};
+
+} // namespace yams::symspell
@@ -0,0 +1,428 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <symspell/symspell.hpp>
+
+namespace yams::symspell {
+
+// Read-only union of two frozen MemoryStores: a large base and a small overlay holding every
+// term changed since the base was built. Overlay entries shadow base ones; an overlay term
+// with frequency 0 is a tombstone that hides the base term. Both layers are shared, so
+// consecutive snapshots of a LiveDictionary reuse the same base. `metadata` describes the
+// union; loadMetadata() returns it.
+class LayeredStore : public ISymSpellStore {
+public:
+    LayeredStore(std::shared_ptr<MemoryStore> base, std::shared_ptr<MemoryStore> overlay,
+                 std::optional<DictionaryMetadata> metadata = std::nullopt)
+        : base_(std::move(base)), overlay_(std::move(overlay)), metadata_(std::move(metadata)) {
+        if (!base_ || !overlay_ || !base_->frozen() || !overlay_->frozen()) {
+            throw std::invalid_argument("LayeredStore requires two frozen MemoryStores");
+        }
+    }
+
+    const MemoryStore& base() const { return *base_; }
+    const MemoryStore& overlay() const { return *overlay_; }
+
+    void addDelete(DeleteHash hash, std::string_view term) override {
+        (void)hash;
+        (void)term;
+        throw std::logic_error("LayeredStore is read-only");
+    }
+
+    std::vector<std::string> getTerms(DeleteHash hash) override {
+        std::vector<std::string> terms;
+        visitTerms(hash, [&](std::string_view term) {
+            terms.emplace_back(term);
+            return true;
+        });
+        return terms;
+    }
+
+    void visitTerms(DeleteHash hash, TermVisitor visitor) override {
+        visitTermsMulti(std::span<const DeleteHash>(&hash, 1),
+                        [&](DeleteHash, std::string_view term, const int64_t*) {
+                            return visitor(term);
+                        });
+    }
+
+    void visitTermsMulti(std::span<const DeleteHash> hashes, MultiTermVisitor visitor) override {
+        bool stopped = false;
+        if (overlay_->bucketCount() > 0) {
+            overlay_->visitTermsMulti(hashes, [&](DeleteHash hash, std::string_view term,
+                                                  const int64_t* freq) {
+                stopped = !visitor(hash, term, freq);
+                return !stopped;
+            });
+        }
+        if (stopped) {
+            return;
+        }
+        bool shadowing = overlay_->termCount() > 0;
+        base_->visitTermsMulti(hashes, [&](DeleteHash hash, std::string_view term,
+                                           const int64_t* freq) {
+            if (shadowing && overlay_->termExists(term)) {
+                return true;
+            }
+            return visitor(hash, term, freq);
+        });
+    }
+
+    void setFrequency(std::string_view term, int64_t freq) override {
+        (void)term;
+        (void)freq;
+        throw std::logic_error("LayeredStore is read-only");
+    }
+
+    std::optional<int64_t> getFrequency(std::string_view term) override {
+        if (auto freq = overlay_->getFrequency(term)) {
+            return *freq > 0 ? freq : std::nullopt;
+        }
+        return base_->getFrequency(term);
+    }
+
+    bool termExists(std::string_view term) override { return getFrequency(term).has_value(); }
+
+    bool supportsConcurrentReads() const override { return true; }
+
+    std::optional<DictionaryMetadata> loadMetadata() override { return metadata_; }
+
+private:
+    std::shared_ptr<MemoryStore> base_;
+    std::shared_ptr<MemoryStore> overlay_;
+    std::optional<DictionaryMetadata> metadata_;
+};
+
+struct LiveDictionaryOptions {
+    // publish() merges the overlay into a new base once it holds more than
+    // max(minCompactionTerms, base terms / compactionRatio) terms.
+    size_t minCompactionTerms = 4096;
+    size_t compactionRatio = 8;
+    // Bucket order of every layer built by publish().
+    BucketOrder bucketOrder = BucketOrder::Insertion;
+    BuildOptions build;
+    // Delete hashing and text encoding of every layer; a base passed in must have been built
+    // with the same.
+    HashOptions hash;
+    TextEncoding encoding = TextEncoding::Bytes;
+};
+
+struct LiveDictionaryStats {
+    uint64_t version = 0;
+    size_t baseTerms = 0;
+    size_t overlayTerms = 0;
+    size_t pendingChanges = 0;
+    uint64_t compactions = 0;
+};
+
+// Dictionary that keeps serving lookups while it is updated, with RCU-style publication.
+// Readers take snapshot(), an immutable refcounted SymSpell over a LayeredStore, and hold it
+// for as long as they like; every lookup on one snapshot sees the same dictionary. Writers
+// stage changes with createDictionaryEntry() and removeDictionaryEntry(), and publish()
+// builds a new frozen overlay (or, past the compaction threshold, a new base) off to the
+// side and swaps it in with a single atomic store. Readers never wait for a build and
+// writers never wait for readers; a replaced layer is freed when its last snapshot goes.
+//
+// Writer calls are serialized by an internal mutex. Staged changes are invisible to readers
+// until publish(). There is no count threshold: every word with a positive count is live.
+class LiveDictionary {
+public:
+    explicit LiveDictionary(int maxEditDistance = 2, int prefixLength = 7,
+                            const LiveDictionaryOptions& options = {})
+        : maxEditDistance_(maxEditDistance), prefixLength_(prefixLength), options_(options) {
+        base_ = buildLayer({}, {});
+        overlay_ = base_;
+        current_.store(makeSnapshot());
+    }
+
+    // Starts from a dictionary built and frozen up front. The store is shared, not copied.
+    explicit LiveDictionary(std::shared_ptr<MemoryStore> base,
+                            const LiveDictionaryOptions& options = {})
+        : options_(options) {
+        if (!base || !base->frozen()) {
+            throw std::invalid_argument("LiveDictionary requires a frozen base store");
+        }
+        maxEditDistance_ = base->maxEditDistance();
+        prefixLength_ = base->prefixLength();
+        base_ = std::move(base);
+        countBaseLengths();
+        overlay_ = buildLayer({}, {});
+        current_.store(makeSnapshot());
+    }
+
+    LiveDictionary(const LiveDictionary&) = delete;
+    LiveDictionary& operator=(const LiveDictionary&) = delete;
+
+    // The most recently published dictionary. Holding and querying it takes no lock.
+    std::shared_ptr<const SymSpell> snapshot() const {
+        return current_.load(std::memory_order_acquire);
+    }
+
+    std::vector<Suggestion> lookup(std::string_view input, Verbosity verbosity = Verbosity::Closest,
+                                   int maxEditDistance = -1) const {
+        return snapshot()->lookup(input, verbosity, maxEditDistance);
+    }
+
+    // The span points into `context`, so it outlives the snapshot the lookup ran on.
+    std::span<const Suggestion> lookup(std::string_view input, LookupContext& context,
+                                       Verbosity verbosity = Verbosity::Closest,
+                                       int maxEditDistance = -1) const {
+        return snapshot()->lookup(input, context, verbosity, maxEditDistance);
+    }
+
+    // Stages `count` more occurrences of `key`. Returns true if the word is new. Bigram keys
+    // are not words and are skipped, as by SymSpell::createDictionaryEntry().
+    bool createDictionaryEntry(std::string_view key, int64_t count = 1) {
+        if (count <= 0 || SymSpell::isBigramKey(key)) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(writerMutex_);
+        int64_t current = latestFrequency(key);
+        pending_[std::string(key)] = count > INT64_MAX - current ? INT64_MAX : current + count;
+        return current == 0;
+    }
+
+    // Stages the removal of `key`. Returns false if the word is not in the dictionary.
+    bool removeDictionaryEntry(std::string_view key) {
+        std::lock_guard<std::mutex> lock(writerMutex_);
+        if (latestFrequency(key) == 0) {
+            return false;
+        }
+        pending_[std::string(key)] = 0;
+        return true;
+    }
+
+    // Makes the staged changes visible to new snapshots. Returns the published version, which
+    // is unchanged if nothing was staged.
+    uint64_t publish() {
+        std::lock_guard<std::mutex> lock(writerMutex_);
+        if (pending_.empty()) {
+            return version_;
+        }
+        mergePending();
+        size_t ratio = std::max<size_t>(options_.compactionRatio, 1);
+        size_t threshold = std::max(options_.minCompactionTerms, base_->termCount() / ratio);
+        if (overlayTerms_.size() > threshold) {
+            compactLocked();
+        } else {
+            std::vector<DictionaryEntry> entries;
+            std::vector<std::string_view> tombstones;
+            for (const auto& [term, freq] : overlayTerms_) {
+                if (freq > 0) {
+                    entries.push_back(DictionaryEntry{term, freq});
+                } else {
+                    tombstones.push_back(term);
+                }
+            }
+            overlay_ = buildLayer(entries, tombstones);
+        }
+        return publishLocked();
+    }
+
+    // Publishes staged changes and merges the overlay into a new base, e.g. before writing the
+    // base out with writeSnapshot().
+    uint64_t compact() {
+        std::lock_guard<std::mutex> lock(writerMutex_);
+        bool changed = !pending_.empty();
+        mergePending();
+        if (!changed && overlay_->termCount() == 0) {
+            return version_;
+        }
+        compactLocked();
+        return publishLocked();
+    }
+
+    // The frozen base of the current snapshot; includes the overlay only after compact().
+    std::shared_ptr<const MemoryStore> base() const {
+        std::lock_guard<std::mutex> lock(writerMutex_);
+        return base_;
+    }
+
+    LiveDictionaryStats stats() const {
+        std::lock_guard<std::mutex> lock(writerMutex_);
+        return LiveDictionaryStats{version_, base_->termCount(), overlayTerms_.size(),
+                                   pending_.size(), compactions_};
+    }
+
+private:
+    struct TermHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view term) const {
+            return std::hash<std::string_view>{}(term);
+        }
+    };
+
+    using TermCounts = std::unordered_map<std::string, int64_t, TermHash, std::equal_to<>>;
+
+    // Frequency including staged and unpublished changes; 0 if absent.
+    int64_t latestFrequency(std::string_view key) const {
+        if (auto it = pending_.find(key); it != pending_.end()) {
+            return it->second;
+        }
+        if (auto it = overlayTerms_.find(key); it != overlayTerms_.end()) {
+            return it->second;
+        }
+        return base_->getFrequency(key).value_or(0);
+    }
+
+    void mergePending() {
+        for (auto& [term, freq] : pending_) {
+            if (freq == 0 && !base_->termExists(term)) {
+                overlayTerms_.erase(term);
+            } else {
+                overlayTerms_[term] = freq;
+            }
+        }
+        pending_.clear();
+    }
+
+    // Bigram entries of the base have no deletes; they are carried over as frequencies only.
+    void compactLocked() {
+        std::vector<DictionaryEntry> entries;
+        std::vector<DictionaryEntry> bigrams;
+        entries.reserve(base_->termCount() + overlayTerms_.size());
+        TermDictionaryView terms = base_->terms();
+        std::span<const int64_t> frequencies = base_->frequencies();
+        for (TermId id = 0; id < terms.size(); ++id) {
+            std::string_view term = terms.term(id);
+            if (SymSpell::isBigramKey(term)) {
+                bigrams.push_back(DictionaryEntry{term, frequencies[id]});
+            } else if (!overlayTerms_.contains(term)) {
+                entries.push_back(DictionaryEntry{term, frequencies[id]});
+            }
+        }
+        for (const auto& [term, freq] : overlayTerms_) {
+            if (freq > 0) {
+                entries.push_back(DictionaryEntry{term, freq});
+            }
+        }
+        base_ = buildLayer(entries, {}, bigrams);
+        countBaseLengths();
+        overlay_ = buildLayer({}, {});
+        overlayTerms_.clear();
+        ++compactions_;
+    }
+
+    uint64_t publishLocked() {
+        ++version_;
+        current_.store(makeSnapshot(), std::memory_order_release);
+        return version_;
+    }
+
+    // Builds a frozen layer. `frequencyOnly` entries get a frequency but no deletes. The
+    // returned pointer aliases the builder, which owns the store.
+    std::shared_ptr<MemoryStore> buildLayer(std::span<const DictionaryEntry> entries,
+                                            std::span<const std::string_view> tombstones,
+                                            std::span<const DictionaryEntry> frequencyOnly = {})
+        const {
+        auto builder = std::make_shared<SymSpell>(
+            std::make_unique<MemoryStore>(maxEditDistance_, prefixLength_), maxEditDistance_,
+            prefixLength_, options_.hash, options_.encoding);
+        builder->createDictionary(entries, options_.build);
+        auto& store = static_cast<MemoryStore&>(builder->store());
+        for (auto term : tombstones) {
+            store.setFrequency(term, 0);
+        }
+        for (const auto& entry : frequencyOnly) {
+            store.setFrequency(entry.term, entry.count);
+        }
+        store.freeze(options_.bucketOrder);
+        return std::shared_ptr<MemoryStore>(builder, &store);
+    }
+
+    // Length histogram of the base's words, without bigram entries and tombstones, and the
+    // smallest count of its bigrams. The overlay holds no bigrams.
+    void countBaseLengths() {
+        baseLengths_.clear();
+        baseMinBigramCount_ = 0;
+        TermDictionaryView terms = base_->terms();
+        std::span<const int64_t> frequencies = base_->frequencies();
+        for (TermId id = 0; id < terms.size(); ++id) {
+            std::string_view term = terms.term(id);
+            if (frequencies[id] <= 0) {
+                continue;
+            }
+            if (SymSpell::isBigramKey(term)) {
+                if (baseMinBigramCount_ == 0 || frequencies[id] < baseMinBigramCount_) {
+                    baseMinBigramCount_ = frequencies[id];
+                }
+            } else {
+                if (baseLengths_.size() <= term.size()) {
+                    baseLengths_.resize(term.size() + 1);
+                }
+                ++baseLengths_[term.size()];
+            }
+        }
+    }
+
+    // Metadata of the published layers: the base's histogram with the overlay applied, so
+    // snapshots prune inputs by the longest live word.
+    DictionaryMetadata layerMetadata() const {
+        DictionaryMetadata metadata;
+        metadata.maxEditDistance = maxEditDistance_;
+        metadata.prefixLength = prefixLength_;
+        metadata.hashOptions = options_.hash;
+        metadata.encoding = options_.encoding;
+        metadata.minBigramCount = baseMinBigramCount_;
+        auto& histogram = metadata.lengthHistogram;
+        histogram = baseLengths_;
+        for (const auto& [term, freq] : overlayTerms_) {
+            if (term.size() < histogram.size() && histogram[term.size()] > 0 &&
+                base_->getFrequency(term).value_or(0) > 0) {
+                --histogram[term.size()];
+            }
+            if (freq > 0) {
+                if (histogram.size() <= term.size()) {
+                    histogram.resize(term.size() + 1);
+                }
+                ++histogram[term.size()];
+            }
+        }
+        while (!histogram.empty() && histogram.back() == 0) {
+            histogram.pop_back();
+        }
+        for (uint64_t count : histogram) {
+            metadata.termCount += count;
+        }
+        metadata.maxWordLength = histogram.empty() ? 0 : static_cast<int>(histogram.size() - 1);
+        return metadata;
+    }
+
+    std::shared_ptr<const SymSpell> makeSnapshot() const {
+        return std::make_shared<const SymSpell>(
+            std::make_unique<LayeredStore>(base_, overlay_, layerMetadata()), maxEditDistance_,
+            prefixLength_, options_.hash, options_.encoding);
+    }
+
+    int maxEditDistance_ = 2;
+    int prefixLength_ = 7;
+    LiveDictionaryOptions options_;
+    std::atomic<std::shared_ptr<const SymSpell>> current_;
+
+    mutable std::mutex writerMutex_;
+    std::shared_ptr<MemoryStore> base_;
+    std::shared_ptr<MemoryStore> overlay_;
+    // baseLengths_[n]: words of n bytes in the base.
+    std::vector<uint64_t> baseLengths_;
+    int64_t baseMinBigramCount_ = 0;
+    // Every term of the overlay with its frequency; 0 marks a removed base term.
+    TermCounts overlayTerms_;
+    // Staged absolute frequencies; 0 marks a removal.
+    TermCounts pending_;
+    uint64_t version_ = 0;
+    uint64_t compactions_ = 0;
+};
+
+} // namespace yams::symspell
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <symspell/lookup_context.hpp>
+
+namespace yams::symspell {
+
+struct LookupCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t size = 0;
+};
+
+// One cached lookup result. All terms share a single buffer, so an entry costs three
+// allocations regardless of how many suggestions it holds.
+class CachedLookup {
+public:
+    CachedLookup(uint64_t version, std::span<const Suggestion> results) : version_(version) {
+        size_t bytes = 0;
+        for (const auto& s : results) {
+            bytes += s.term.size();
+        }
+        terms_.reserve(bytes);
+        items_.reserve(results.size());
+        for (const auto& s : results) {
+            items_.push_back(Item{static_cast<uint32_t>(terms_.size()),
+                                  static_cast<uint32_t>(s.term.size()), s.distance, s.frequency});
+            terms_.append(s.term);
+        }
+    }
+
+    uint64_t version() const { return version_; }
+    size_t size() const { return items_.size(); }
+    std::string_view term(size_t i) const {
+        return std::string_view(terms_).substr(items_[i].offset, items_[i].length);
+    }
+    int distance(size_t i) const { return items_[i].distance; }
+    int64_t frequency(size_t i) const { return items_[i].frequency; }
+
+private:
+    struct Item {
+        uint32_t offset;
+        uint32_t length;
+        int distance;
+        int64_t frequency;
+    };
+
+    uint64_t version_;
+    std::string terms_;
+    std::vector<Item> items_;
+};
+
+// Bounded, thread-safe LRU cache of lookup results. Keys are split across independently
+// locked shards so concurrent lookups rarely contend. Every entry records the dictionary
+// version it was computed against; a lookup under a newer version treats it as a miss and
+// drops it, so invalidation is a counter bump rather than a sweep.
+class LookupCache {
+public:
+    explicit LookupCache(size_t capacity, size_t shards = 16)
+        : shards_(std::clamp<size_t>(shards, 1, std::max<size_t>(capacity, 1))) {
+        shardCapacity_ = std::max<size_t>(1, (capacity + shards_.size() - 1) / shards_.size());
+    }
+
+    LookupCache(const LookupCache&) = delete;
+    LookupCache& operator=(const LookupCache&) = delete;
+
+    size_t capacity() const { return shardCapacity_ * shards_.size(); }
+
+    std::shared_ptr<const CachedLookup> find(std::string_view key, uint64_t version) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) {
+            ++shard.misses;
+            return nullptr;
+        }
+        if (it->second->value->version() != version) {
+            shard.lru.erase(it->second);
+            shard.index.erase(it);
+            ++shard.misses;
+            return nullptr;
+        }
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        ++shard.hits;
+        return it->second->value;
+    }
+
+    void insert(std::string_view key, uint64_t version, std::span<const Suggestion> results) {
+        auto value = std::make_shared<const CachedLookup>(version, results);
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (auto it = shard.index.find(key); it != shard.index.end()) {
+            it->second->value = std::move(value);
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+            return;
+        }
+        if (shard.lru.size() >= shardCapacity_) {
+            shard.index.erase(shard.lru.back().key);
+            shard.lru.pop_back();
+            ++shard.evictions;
+        }
+        shard.lru.push_front(Node{std::string(key), std::move(value)});
+        shard.index.emplace(shard.lru.front().key, shard.lru.begin());
+    }
+
+    void clear() {
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.index.clear();
+            shard.lru.clear();
+        }
+    }
+
+    LookupCacheStats stats() const {
+        LookupCacheStats total;
+        for (const auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total.hits += shard.hits;
+            total.misses += shard.misses;
+            total.evictions += shard.evictions;
+            total.size += shard.lru.size();
+        }
+        return total;
+    }
+
+private:
+    struct Node {
+        std::string key;
+        std::shared_ptr<const CachedLookup> value;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<Node> lru;
+        // Keys view the strings owned by the list nodes.
+        std::unordered_map<std::string_view, std::list<Node>::iterator> index;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+    };
+
+    Shard& shardFor(std::string_view key) {
+        return shards_[std::hash<std::string_view>{}(key) % shards_.size()];
+    }
+
+    std::vector<Shard> shards_;
+    size_t shardCapacity_ = 1;
+};
+
+} // namespace yams::symspell
@@ -0,0 +1,317 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <symspell/edit_distance.hpp>
+#include <symspell/flat_index.hpp>
+#include <symspell/metrics.hpp>
+
+namespace yams::symspell {
+
+enum class Verbosity { Top, Closest, All };
+
+struct Suggestion {
+    std::string term;
+    int distance;
+    int64_t frequency;
+
+    auto operator<=>(const Suggestion&) const = default;
+};
+
+namespace detail {
+
+// Open-addressed set of 32-bit indices keyed by a caller-supplied hash. The caller owns the
+// keys and provides equality by index, so the set itself never copies strings. clear() is
+// O(1): every slot carries a generation stamp and stale stamps read as empty.
+class FlatIndexSet {
+public:
+    void clear() {
+        size_ = 0;
+        if (++generation_ == 0) {
+            std::fill(slots_.begin(), slots_.end(), Slot{});
+            generation_ = 1;
+        }
+    }
+
+    size_t size() const { return size_; }
+
+    // Inserts `index` unless an equal key is already present. `equal(existingIndex)` compares
+    // the key being inserted against a stored one. Returns true if `index` was inserted.
+    template <typename Equal> bool insert(uint32_t hash, uint32_t index, Equal&& equal) {
+        if ((size_ + 1) * 2 > slots_.size()) {
+            grow();
+        }
+        size_t mask = slots_.size() - 1;
+        for (size_t i = hash & mask;; i = (i + 1) & mask) {
+            Slot& slot = slots_[i];
+            if (slot.generation != generation_) {
+                slot = Slot{generation_, hash, index};
+                ++size_;
+                return true;
+            }
+            if (slot.hash == hash && equal(slot.index)) {
+                return false;
+            }
+        }
+    }
+
+private:
+    struct Slot {
+        uint32_t generation = 0;
+        uint32_t hash = 0;
+        uint32_t index = 0;
+    };
+
+    void grow() {
+        std::vector<Slot> old = std::move(slots_);
+        slots_.assign(old.empty() ? 64 : old.size() * 2, Slot{});
+        size_t mask = slots_.size() - 1;
+        for (const Slot& slot : old) {
+            if (slot.generation != generation_) {
+                continue;
+            }
+            size_t i = slot.hash & mask;
+            while (slots_[i].generation == generation_) {
+                i = (i + 1) & mask;
+            }
+            slots_[i] = slot;
+        }
+    }
+
+    std::vector<Slot> slots_;
+    uint32_t generation_ = 1;
+    size_t size_ = 0;
+};
+
+// Strings appended back to back into one buffer and addressed by index. Views returned by
+// view() are invalidated by the next append.
+class StringArena {
+public:
+    void clear() {
+        chars_.clear();
+        refs_.clear();
+    }
+
+    size_t size() const { return refs_.size(); }
+
+    std::string_view view(size_t index) const {
+        const Ref& ref = refs_[index];
+        return std::string_view(chars_).substr(ref.offset, ref.length);
+    }
+
+    uint64_t hash(size_t index) const { return refs_[index].hash; }
+
+    uint32_t append(std::string_view s, uint64_t hash) {
+        refs_.push_back(Ref{static_cast<uint32_t>(chars_.size()), static_cast<uint32_t>(s.size()),
+                            hash});
+        chars_.append(s);
+        return static_cast<uint32_t>(refs_.size() - 1);
+    }
+
+    // Two-phase append: build the string at the end of the buffer with pending(), then
+    // commit() it or discard it with rollback().
+    std::string& pending() { return chars_; }
+    size_t pendingBegin() const {
+        return refs_.empty() ? 0 : refs_.back().offset + refs_.back().length;
+    }
+
+    uint32_t commit(uint64_t hash) {
+        auto begin = static_cast<uint32_t>(pendingBegin());
+        refs_.push_back(Ref{begin, static_cast<uint32_t>(chars_.size() - begin), hash});
+        return static_cast<uint32_t>(refs_.size() - 1);
+    }
+
+    void rollback() { chars_.resize(pendingBegin()); }
+
+private:
+    struct Ref {
+        uint32_t offset;
+        uint32_t length;
+        uint64_t hash;
+    };
+
+    std::string chars_;
+    std::vector<Ref> refs_;
+};
+
+} // namespace detail
+
+// Caller-owned scratch state for SymSpell::lookup. Buffers are cleared between lookups but
+// never freed, so once they have grown to the working-set size a lookup performs no heap
+// allocations. A context must not be shared between threads; keep one per thread.
+class LookupContext {
+public:
+    LookupContext() = default;
+    LookupContext(const LookupContext&) = delete;
+    LookupContext& operator=(const LookupContext&) = delete;
+    LookupContext(LookupContext&&) = default;
+    LookupContext& operator=(LookupContext&&) = default;
+
+    // Results of the most recent lookup made with this context.
+    std::span<const Suggestion> results() const {
+        return std::span<const Suggestion>(results_.data(), resultCount_);
+    }
+
+    // Bucket terms checked against the candidate deletes they were found under, summed over
+    // every lookup made with this context since the last resetProbeStats(). A collision is
+    // a term that shares the candidate's bucket only through a hash collision, i.e. that
+    // cannot have the candidate as a delete; the share of collisions measures the cost of
+    // HashOptions::compactLevel.
+    struct ProbeStats {
+        uint64_t rows = 0;
+        uint64_t collisions = 0;
+    };
+
+    const ProbeStats& probeStats() const { return probeStats_; }
+    void resetProbeStats() { probeStats_ = {}; }
+
+    // Counters and phase times summed over every lookup made with this context since the last
+    // resetLookupStats(); reset before a lookup to see that lookup alone. Only recorded in
+    // builds with YAMS_SYMSPELL_METRICS (see metrics.hpp).
+    const LookupStats& lookupStats() const { return lookupStats_; }
+    void resetLookupStats() { lookupStats_ = {}; }
+
+private:
+    friend class SymSpell;
+
+    void reset() {
+        candidates_.clear();
+        candidateSet_.clear();
+        suggestions_.clear();
+        suggestionSet_.clear();
+        resultCount_ = 0;
+    }
+
+    // Inserts `term` into the considered-suggestions set. Returns false if already present.
+    bool considerSuggestion(std::string_view term, uint32_t hash) {
+        auto index = static_cast<uint32_t>(suggestions_.size());
+        bool inserted = suggestionSet_.insert(hash, index, [&](uint32_t existing) {
+            return suggestions_.view(existing) == term;
+        });
+        if (inserted) {
+            suggestions_.append(term, hash);
+        }
+        return inserted;
+    }
+
+    // One candidate of the level being probed. `term` points into candidates_, which is not
+    // appended to while a level is probed.
+    struct LevelEntry {
+        DeleteHash hash;
+        std::string_view term;
+    };
+
+    // Collects the distinct delete hashes of candidates [begin, end) for one probe, and an
+    // index from hash back to the candidates that produced it (several on a collision).
+    void prepareLevel(size_t begin, size_t end) {
+        level_.clear();
+        for (size_t i = begin; i < end; ++i) {
+            level_.push_back(
+                LevelEntry{static_cast<DeleteHash>(candidates_.hash(i)), candidates_.view(i)});
+        }
+        std::sort(level_.begin(), level_.end(),
+                  [](const LevelEntry& a, const LevelEntry& b) { return a.hash < b.hash; });
+        levelHashes_.clear();
+        for (const LevelEntry& entry : level_) {
+            if (levelHashes_.empty() || levelHashes_.back() != entry.hash) {
+                levelHashes_.push_back(entry.hash);
+            }
+        }
+    }
+
+    std::span<const LevelEntry> levelCandidates(DeleteHash hash) const {
+        auto range = std::equal_range(level_.begin(), level_.end(), LevelEntry{hash, {}},
+                                      [](const LevelEntry& a, const LevelEntry& b) {
+                                          return a.hash < b.hash;
+                                      });
+        return std::span<const LevelEntry>(range.first, range.second);
+    }
+
+    // Progress of the lookup running with this context. SymSpell runs a lookup in phases with
+    // store probes in between, and keeps everything the phases share here, so a lookup can be
+    // suspended at a probe and resumed later.
+    struct LookupState {
+        std::string_view input;
+        Verbosity verbosity = Verbosity::Closest;
+        size_t limit = 0;
+        bool ranked = false;
+        bool bitParallel = false;
+        int maxEditDistance = 0;
+        int maxEditDistance2 = 0;
+        int inputLen = 0; // In characters of the encoding, like the lengths below.
+        int inputPrefixLen = 0;
+        size_t levelBegin = 0;
+        size_t levelEnd = 0;
+        int candidateLen = 0;
+        int lengthDiff = 0;
+        DeleteHash lastHash = 0;
+        std::span<const LevelEntry> lastCandidates;
+    };
+
+    void clearResults() { resultCount_ = 0; }
+
+    Suggestion& result(size_t index) { return results_[index]; }
+
+    void pushResult(std::string_view term, int distance, int64_t frequency) {
+        if (resultCount_ == results_.size()) {
+            results_.emplace_back();
+        }
+        assignResult(resultCount_++, term, distance, frequency);
+    }
+
+    // Offers a suggestion to the first `limit` results, which are kept sorted by ascending
+    // distance and then descending frequency. Returns false if it does not make the cut.
+    // Entries move by swapping, so their string buffers are recycled rather than reallocated.
+    bool insertRanked(size_t limit, std::string_view term, int distance, int64_t frequency) {
+        auto before = [](const Suggestion& a, const Suggestion& b) {
+            return a.distance != b.distance ? a.distance < b.distance : a.frequency > b.frequency;
+        };
+        size_t index = resultCount_;
+        if (resultCount_ < limit) {
+            pushResult(term, distance, frequency);
+        } else {
+            const Suggestion& last = results_[limit - 1];
+            if (distance > last.distance ||
+                (distance == last.distance && frequency <= last.frequency)) {
+                return false;
+            }
+            index = limit - 1;
+            assignResult(index, term, distance, frequency);
+        }
+        for (; index > 0 && before(results_[index], results_[index - 1]); --index) {
+            std::swap(results_[index], results_[index - 1]);
+        }
+        return true;
+    }
+
+    void assignResult(size_t index, std::string_view term, int distance, int64_t frequency) {
+        Suggestion& s = results_[index];
+        s.term.assign(term.data(), term.size());
+        s.distance = distance;
+        s.frequency = frequency;
+    }
+
+    LookupState state_;
+    ProbeStats probeStats_;
+    LookupStats lookupStats_;
+    detail::StringArena candidates_;
+    detail::FlatIndexSet candidateSet_;
+    std::vector<LevelEntry> level_;
+    std::vector<DeleteHash> levelHashes_;
+    detail::StringArena suggestions_;
+    detail::FlatIndexSet suggestionSet_;
+    std::string scratch_;
+    std::string cacheKey_;
+    detail::BitParallelPattern pattern_;
+    std::vector<int> distanceRows_;
+    std::u32string inputCodePoints_; // TextEncoding::Utf8 inputs beyond the bit-parallel kernel.
+    std::u32string textCodePoints_;
+    std::vector<Suggestion> results_;
+    size_t resultCount_ = 0;
+};
+
+} // namespace yams::symspell
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Instrumentation switch. Define YAMS_SYMSPELL_METRICS=1 for the whole build, library
+// included, to have lookups fill LookupContext::lookupStats() and stores their metrics().
+// Otherwise every recording site compiles away and the counters stay zero; the structures
+// keep the same layout either way.
+#ifndef YAMS_SYMSPELL_METRICS
+#define YAMS_SYMSPELL_METRICS 0
+#endif
+
+namespace yams::symspell {
+
+inline constexpr bool kMetricsEnabled = YAMS_SYMSPELL_METRICS != 0;
+
+// Where the time of the lookups made with one LookupContext went.
+struct LookupStats {
+    uint64_t lookups = 0;
+    uint64_t cacheHits = 0;
+    uint64_t candidates = 0;    // Candidate deletes generated, the input prefix included.
+    uint64_t probes = 0;        // Multi-bucket store calls, one per candidate level.
+    uint64_t bucketsProbed = 0; // Distinct delete hashes asked for.
+    uint64_t termsScanned = 0;  // Bucket rows delivered by the store.
+    uint64_t prefixRejects = 0; // (row, candidate) pairs dropped by the length/prefix checks.
+    uint64_t distanceComputations = 0;
+    // Wall time per phase. Probing includes checking the rows as they arrive, and for
+    // lookupAsync() the time a probe spent suspended.
+    std::chrono::nanoseconds generateTime{0};
+    std::chrono::nanoseconds probeTime{0};
+    std::chrono::nanoseconds finishTime{0};
+};
+
+// Aggregate read counters of a store since construction or resetMetrics().
+struct StoreMetrics {
+    uint64_t probes = 0; // getTerms/visitTerms* calls.
+    uint64_t bucketsProbed = 0;
+    uint64_t rowsReturned = 0;
+    std::chrono::nanoseconds stepTime{0}; // SQLiteStore: time in sqlite3_step() on reads.
+};
+
+namespace detail {
+
+inline void countMetric(uint64_t& counter, uint64_t amount = 1) {
+    if constexpr (kMetricsEnabled) {
+        counter += amount;
+    }
+}
+
+// Adds the lifetime of the timer to `total`.
+class PhaseTimer {
+public:
+    explicit PhaseTimer(std::chrono::nanoseconds& total) : total_(total) {
+        if constexpr (kMetricsEnabled) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+    ~PhaseTimer() {
+        if constexpr (kMetricsEnabled) {
+            total_ += std::chrono::steady_clock::now() - start_;
+        }
+    }
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+    std::chrono::nanoseconds& total_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// StoreMetrics shared by concurrent readers. Each call records its totals once, with relaxed
+// atomics, so readers never contend per row.
+class StoreCounters {
+public:
+    StoreCounters() = default;
+    StoreCounters(const StoreCounters& other) { *this = other; }
+    StoreCounters& operator=(const StoreCounters& other) {
+        probes_.store(other.probes_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        buckets_.store(other.buckets_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        rows_.store(other.rows_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        stepNanos_.store(other.stepNanos_.load(std::memory_order_relaxed),
+                         std::memory_order_relaxed);
+        return *this;
+    }
+
+    void recordProbe(uint64_t buckets, uint64_t rows) {
+        if constexpr (kMetricsEnabled) {
+            probes_.fetch_add(1, std::memory_order_relaxed);
+            buckets_.fetch_add(buckets, std::memory_order_relaxed);
+            rows_.fetch_add(rows, std::memory_order_relaxed);
+        }
+    }
+
+    void recordStepTime(std::chrono::nanoseconds time) {
+        if constexpr (kMetricsEnabled) {
+            stepNanos_.fetch_add(static_cast<uint64_t>(time.count()), std::memory_order_relaxed);
+        }
+    }
+
+    StoreMetrics snapshot() const {
+        StoreMetrics metrics;
+        metrics.probes = probes_.load(std::memory_order_relaxed);
+        metrics.bucketsProbed = buckets_.load(std::memory_order_relaxed);
+        metrics.rowsReturned = rows_.load(std::memory_order_relaxed);
+        metrics.stepTime = std::chrono::nanoseconds(stepNanos_.load(std::memory_order_relaxed));
+        return metrics;
+    }
+
+    void reset() { *this = StoreCounters(); }
+
+private:
+    std::atomic<uint64_t> probes_{0};
+    std::atomic<uint64_t> buckets_{0};
+    std::atomic<uint64_t> rows_{0};
+    std::atomic<uint64_t> stepNanos_{0};
+};
+
+} // namespace detail
+
+} // namespace yams::symspell
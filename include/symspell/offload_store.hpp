@@ -0,0 +1,136 @@
+#pragma once
+
+#include <algorithm>
+#include <coroutine>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <symspell/probe_pool.hpp>
+#include <symspell/symspell.hpp>
+#include <symspell/task.hpp>
+
+namespace yams::symspell {
+
+// Makes a blocking store awaitable by running its reads on a small pool of worker threads,
+// e.g. a SQLiteStore behind an event loop. SymSpell::lookupAsync() suspends at every probe and
+// resumes on the worker that ran it, so the thread that started the lookup never waits on
+// the store and up to `threads` probes of different lookups are in flight at once. Stores
+// without concurrent reads get one worker. Synchronous calls and writes go straight to the
+// backing store on the calling thread.
+class OffloadStore : public ISymSpellStore, public IAsyncSymSpellStore {
+public:
+    explicit OffloadStore(std::unique_ptr<ISymSpellStore> backing, size_t threads = 0)
+        : backing_(std::move(backing)) {
+        if (!backing_) {
+            throw std::invalid_argument("OffloadStore requires a backing store");
+        }
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        pool_ = std::make_unique<detail::ProbePool>(
+            backing_->supportsConcurrentReads() ? threads : 1);
+    }
+
+    ISymSpellStore& backing() { return *backing_; }
+
+    Task<std::optional<int64_t>> getFrequencyAsync(std::string_view term) override {
+        co_await resumeOnPool();
+        co_return backing_->getFrequency(term);
+    }
+
+    Task<void> visitTermsMultiAsync(std::span<const DeleteHash> hashes,
+                                    MultiTermVisitor visitor) override {
+        co_await resumeOnPool();
+        backing_->visitTermsMulti(hashes, [&](DeleteHash hash, std::string_view term,
+                                              const int64_t* freq) {
+            if (freq) {
+                return visitor(hash, term, freq);
+            }
+            int64_t resolved = backing_->getFrequency(term).value_or(0);
+            return visitor(hash, term, &resolved);
+        });
+    }
+
+    void addDelete(DeleteHash hash, std::string_view term) override {
+        backing_->addDelete(hash, term);
+    }
+
+    void addDeletes(std::span<const std::string_view> terms,
+                    std::span<const DeletePosting> postings) override {
+        backing_->addDeletes(terms, postings);
+    }
+
+    std::vector<std::string> getTerms(DeleteHash hash) override { return backing_->getTerms(hash); }
+
+    void visitTerms(DeleteHash hash, TermVisitor visitor) override {
+        backing_->visitTerms(hash, visitor);
+    }
+
+    void visitTermsMulti(std::span<const DeleteHash> hashes, MultiTermVisitor visitor) override {
+        backing_->visitTermsMulti(hashes, visitor);
+    }
+
+    void visitTermsByFrequency(std::span<const DeleteHash> hashes,
+                               RankedTermVisitor visitor) override {
+        backing_->visitTermsByFrequency(hashes, visitor);
+    }
+
+    void setFrequency(std::string_view term, int64_t freq) override {
+        backing_->setFrequency(term, freq);
+    }
+
+    std::optional<int64_t> getFrequency(std::string_view term) override {
+        return backing_->getFrequency(term);
+    }
+
+    bool termExists(std::string_view term) override { return backing_->termExists(term); }
+
+    void removeDelete(DeleteHash hash, std::string_view term) override {
+        backing_->removeDelete(hash, term);
+    }
+
+    void removeDeletes(std::string_view term, std::span<const DeleteHash> hashes) override {
+        backing_->removeDeletes(term, hashes);
+    }
+
+    bool removeTerm(std::string_view term) override { return backing_->removeTerm(term); }
+
+    bool supportsConcurrentReads() const override { return backing_->supportsConcurrentReads(); }
+
+    bool bucketsOrderedByFrequency() const override {
+        return backing_->bucketsOrderedByFrequency();
+    }
+
+    std::optional<DictionaryMetadata> loadMetadata() override { return backing_->loadMetadata(); }
+    void saveMetadata(const DictionaryMetadata& metadata) override {
+        backing_->saveMetadata(metadata);
+    }
+    void flushMetadata() override { backing_->flushMetadata(); }
+    std::optional<int64_t> minBigramFrequency() override {
+        return backing_->minBigramFrequency();
+    }
+
+private:
+    // Suspends the calling coroutine and resumes it on a pool worker.
+    struct PoolAwaiter {
+        detail::ProbePool& pool;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) const {
+            pool.submit([handle]() { handle.resume(); });
+        }
+        void await_resume() const noexcept {}
+    };
+
+    PoolAwaiter resumeOnPool() { return PoolAwaiter{*pool_}; }
+
+    std::unique_ptr<ISymSpellStore> backing_;
+    std::unique_ptr<detail::ProbePool> pool_;
+};
+
+} // namespace yams::symspell
@@ -10,6 +10,8 @@ namespace yams::symspell {
 enum class ErrorCode {
     Success = 0,
     DatabaseError,
+    IoError,
+    InvalidFormat,
     InternalError,
     Unknown
 };
@@ -21,6 +23,10 @@ constexpr const char* errorToString(ErrorCode error) {
             return "Success";
         case ErrorCode::DatabaseError:
             return "Database error";
+        case ErrorCode::IoError:
+            return "I/O error";
+        case ErrorCode::InvalidFormat:
+            return "Invalid format";
         case ErrorCode::InternalError:
             return "Internal error";
         case ErrorCode::Unknown:
@@ -0,0 +1,293 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <latch>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <symspell/probe_pool.hpp>
+#include <symspell/symspell.hpp>
+
+namespace yams::symspell {
+
+struct ShardedStoreOptions {
+    // Probes that touch several shards query them in parallel: one on the calling thread and
+    // the rest on a shared pool of `probeThreads` workers (0 = one per shard beyond the
+    // first). With parallelProbes off, shards are queried one after another, which is
+    // cheaper for in-process shards whose probes take microseconds.
+    bool parallelProbes = true;
+    size_t probeThreads = 0;
+};
+
+// Partitions the delete index across N backend stores by delete hash: shard i owns the hashes
+// whose Fibonacci mix falls in [i * 2^64 / N, (i + 1) * 2^64 / N), which spreads 32-bit,
+// 64-bit and compacted hashes (see HashOptions) evenly. A backend is any ISymSpellStore, so a
+// shard can be a local MemoryStore, a SQLiteStore on its own disk, or a client of a remote
+// service implementing the interface. Deletes dominate the index, so each shard holds about
+// 1/N of it.
+//
+// Term frequencies and dictionary metadata are replicated to every shard, so a shard answers
+// its rows together with their frequencies and any shard can serve getFrequency(); reads are
+// spread over shards by term hash, and metadata is loaded from the first shard. A
+// multi-bucket probe is split by shard and fanned out (see ShardedStoreOptions); rows are then
+// handed to the visitor on the calling thread, shard by shard.
+class ShardedStore : public ISymSpellStore {
+public:
+    explicit ShardedStore(std::vector<std::unique_ptr<ISymSpellStore>> shards,
+                          const ShardedStoreOptions& options = {})
+        : shards_(std::move(shards)) {
+        if (shards_.empty() ||
+            std::any_of(shards_.begin(), shards_.end(), [](const auto& s) { return !s; })) {
+            throw std::invalid_argument("ShardedStore requires at least one shard");
+        }
+        if (options.parallelProbes && shards_.size() > 1) {
+            size_t threads = options.probeThreads != 0 ? options.probeThreads : shards_.size() - 1;
+            pool_ = std::make_unique<detail::ProbePool>(threads);
+        }
+    }
+
+    size_t shardCount() const { return shards_.size(); }
+    ISymSpellStore& shard(size_t index) { return *shards_[index]; }
+    const ISymSpellStore& shard(size_t index) const { return *shards_[index]; }
+
+    size_t shardOf(DeleteHash hash) const {
+        uint64_t mixed = static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(((mixed >> 32) * shards_.size()) >> 32);
+    }
+
+    void addDelete(DeleteHash hash, std::string_view term) override {
+        shards_[shardOf(hash)]->addDelete(hash, term);
+    }
+
+    // Postings are split by a stable counting sort, so each shard receives one call with its
+    // postings still ordered by hash.
+    void addDeletes(std::span<const std::string_view> terms,
+                    std::span<const DeletePosting> postings) override {
+        if (shards_.size() == 1) {
+            shards_[0]->addDeletes(terms, postings);
+            return;
+        }
+        std::vector<size_t> begin(shards_.size() + 1, 0);
+        for (const auto& posting : postings) {
+            ++begin[shardOf(posting.hash) + 1];
+        }
+        for (size_t i = 0; i < shards_.size(); ++i) {
+            begin[i + 1] += begin[i];
+        }
+        std::vector<DeletePosting> split(postings.size());
+        std::vector<size_t> next(begin.begin(), begin.end() - 1);
+        for (const auto& posting : postings) {
+            split[next[shardOf(posting.hash)]++] = posting;
+        }
+        for (size_t i = 0; i < shards_.size(); ++i) {
+            if (begin[i + 1] > begin[i]) {
+                shards_[i]->addDeletes(
+                    terms, std::span<const DeletePosting>(split).subspan(
+                               begin[i], begin[i + 1] - begin[i]));
+            }
+        }
+    }
+
+    std::vector<std::string> getTerms(DeleteHash hash) override {
+        return shards_[shardOf(hash)]->getTerms(hash);
+    }
+
+    void visitTerms(DeleteHash hash, TermVisitor visitor) override {
+        shards_[shardOf(hash)]->visitTerms(hash, visitor);
+    }
+
+    void visitTermsMulti(std::span<const DeleteHash> hashes, MultiTermVisitor visitor) override {
+        std::vector<std::vector<DeleteHash>> groups = groupByShard(hashes);
+        std::vector<size_t> touched;
+        for (size_t i = 0; i < groups.size(); ++i) {
+            if (!groups[i].empty()) {
+                touched.push_back(i);
+            }
+        }
+        if (touched.size() == 1 || !pool_) {
+            for (size_t index : touched) {
+                bool stopped = false;
+                shards_[index]->visitTermsMulti(groups[index], [&](DeleteHash hash,
+                                                                   std::string_view term,
+                                                                   const int64_t* freq) {
+                    stopped = !visitor(hash, term, freq);
+                    return !stopped;
+                });
+                if (stopped) {
+                    return;
+                }
+            }
+            return;
+        }
+
+        // Collect every touched shard's rows in parallel, then replay them in shard order.
+        std::vector<ProbeRows> rows(touched.size());
+        std::vector<std::exception_ptr> failures(touched.size());
+        auto probe = [&](size_t slot) {
+            try {
+                rows[slot].collect(*shards_[touched[slot]], groups[touched[slot]]);
+            } catch (...) {
+                failures[slot] = std::current_exception();
+            }
+        };
+        std::latch done(static_cast<std::ptrdiff_t>(touched.size() - 1));
+        for (size_t slot = 1; slot < touched.size(); ++slot) {
+            pool_->submit([&, slot]() {
+                probe(slot);
+                done.count_down();
+            });
+        }
+        probe(0);
+        done.wait();
+        for (const auto& failure : failures) {
+            if (failure) {
+                std::rethrow_exception(failure);
+            }
+        }
+        for (const auto& shardRows : rows) {
+            if (!shardRows.replay(visitor)) {
+                return;
+            }
+        }
+    }
+
+    // Every shard is frequency ordered, and buckets never span shards.
+    void visitTermsByFrequency(std::span<const DeleteHash> hashes,
+                               RankedTermVisitor visitor) override {
+        std::vector<std::vector<DeleteHash>> groups = groupByShard(hashes);
+        for (size_t i = 0; i < groups.size(); ++i) {
+            if (groups[i].empty()) {
+                continue;
+            }
+            bool stopped = false;
+            shards_[i]->visitTermsByFrequency(groups[i], [&](DeleteHash hash, std::string_view term,
+                                                             int64_t freq) {
+                auto control = visitor(hash, term, freq);
+                stopped = control == VisitControl::Stop;
+                return control;
+            });
+            if (stopped) {
+                return;
+            }
+        }
+    }
+
+    void setFrequency(std::string_view term, int64_t freq) override {
+        for (auto& shard : shards_) {
+            shard->setFrequency(term, freq);
+        }
+    }
+
+    std::optional<int64_t> getFrequency(std::string_view term) override {
+        return replicaOf(term).getFrequency(term);
+    }
+
+    bool termExists(std::string_view term) override { return replicaOf(term).termExists(term); }
+
+    void removeDelete(DeleteHash hash, std::string_view term) override {
+        shards_[shardOf(hash)]->removeDelete(hash, term);
+    }
+
+    void removeDeletes(std::string_view term, std::span<const DeleteHash> hashes) override {
+        for (DeleteHash hash : hashes) {
+            removeDelete(hash, term);
+        }
+    }
+
+    bool removeTerm(std::string_view term) override {
+        bool removed = false;
+        for (auto& shard : shards_) {
+            removed = shard->removeTerm(term) || removed;
+        }
+        return removed;
+    }
+
+    // Metadata is replicated like frequencies; every shard sees the whole dictionary.
+    std::optional<DictionaryMetadata> loadMetadata() override { return shards_[0]->loadMetadata(); }
+    void saveMetadata(const DictionaryMetadata& metadata) override {
+        for (auto& shard : shards_) {
+            shard->saveMetadata(metadata);
+        }
+    }
+    void flushMetadata() override {
+        for (auto& shard : shards_) {
+            shard->flushMetadata();
+        }
+    }
+    std::optional<int64_t> minBigramFrequency() override {
+        return shards_[0]->minBigramFrequency();
+    }
+
+    bool supportsConcurrentReads() const override {
+        return std::all_of(shards_.begin(), shards_.end(),
+                           [](const auto& shard) { return shard->supportsConcurrentReads(); });
+    }
+
+    bool bucketsOrderedByFrequency() const override {
+        return std::all_of(shards_.begin(), shards_.end(),
+                           [](const auto& shard) { return shard->bucketsOrderedByFrequency(); });
+    }
+
+private:
+    // Rows of one shard's probe, copied out so the visitor can run on the calling thread.
+    class ProbeRows {
+    public:
+        void collect(ISymSpellStore& shard, std::span<const DeleteHash> hashes) {
+            shard.visitTermsMulti(hashes, [this](DeleteHash hash, std::string_view term,
+                                                 const int64_t* freq) {
+                rows_.push_back(Row{hash, static_cast<uint32_t>(chars_.size()),
+                                    static_cast<uint32_t>(term.size()), freq ? *freq : 0,
+                                    freq != nullptr});
+                chars_.append(term);
+                return true;
+            });
+        }
+
+        bool replay(MultiTermVisitor visitor) const {
+            for (const Row& row : rows_) {
+                std::string_view term = std::string_view(chars_).substr(row.offset, row.length);
+                if (!visitor(row.hash, term, row.hasFrequency ? &row.frequency : nullptr)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+    private:
+        struct Row {
+            DeleteHash hash;
+            uint32_t offset;
+            uint32_t length;
+            int64_t frequency;
+            bool hasFrequency;
+        };
+
+        std::string chars_;
+        std::vector<Row> rows_;
+    };
+
+    std::vector<std::vector<DeleteHash>> groupByShard(std::span<const DeleteHash> hashes) const {
+        std::vector<std::vector<DeleteHash>> groups(shards_.size());
+        for (DeleteHash hash : hashes) {
+            groups[shardOf(hash)].push_back(hash);
+        }
+        return groups;
+    }
+
+    ISymSpellStore& replicaOf(std::string_view term) {
+        return *shards_[std::hash<std::string_view>{}(term) % shards_.size()];
+    }
+
+    std::vector<std::unique_ptr<ISymSpellStore>> shards_;
+    std::unique_ptr<detail::ProbePool> pool_;
+};
+
+} // namespace yams::symspell
@@ -1,426 +1,2141 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
+#include <exception>
+#include <functional>
+#include <istream>
+#include <iterator>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <ranges>
+#include <span>
+#include <stdexcept>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
+#include <symspell/edit_distance.hpp>
+#include <symspell/flat_index.hpp>
+#include <symspell/lookup_cache.hpp>
+#include <symspell/lookup_context.hpp>
+#include <symspell/metrics.hpp>
+#include <symspell/task.hpp>
+#include <symspell/term_dictionary.hpp>
+#include <symspell/utf8.hpp>
 
 namespace yams::symspell {
 
-enum class Verbosity { Top, Closest, All };
+// Non-owning reference to a callable, used for store callbacks on the lookup hot path where
+// std::function would type-erase through the heap. The referenced callable must outlive the call.
+template <typename Signature> class FunctionRef;
 
-struct Suggestion {
-    std::string term;
-    int distance;
-    int64_t frequency;
+template <typename R, typename... Args> class FunctionRef<R(Args...)> {
+public:
+    template <typename F>
+        requires(!std::is_same_v<std::remove_cvref_t<F>, FunctionRef> &&
+                 std::is_invocable_r_v<R, F&, Args...>)
+    FunctionRef(F&& f) noexcept
+        : obj_(const_cast<void*>(static_cast<const void*>(std::addressof(f)))),
+          call_([](void* obj, Args... args) -> R {
+              return std::invoke(*static_cast<std::add_pointer_t<F>>(obj),
+                                 std::forward<Args>(args)...);
+          }) {}
+
+    R operator()(Args... args) const { return call_(obj_, std::forward<Args>(args)...); }
+
+private:
+    void* obj_;
+    R (*call_)(void*, Args...);
+};
+
+// Invoked once per term of a delete bucket; return false to stop the enumeration.
+using TermVisitor = FunctionRef<bool(std::string_view)>;
+
+// Invoked once per (delete hash, term, frequency) of a multi-bucket probe; return false to stop.
+// The frequency pointer is only valid during the call, and null when the store cannot supply
+// the frequency along with the term.
+using MultiTermVisitor = FunctionRef<bool(DeleteHash, std::string_view, const int64_t*)>;
+
+// Returned by ranked visitors: keep going, skip the rest of the current bucket, or stop.
+enum class VisitControl { Continue, SkipBucket, Stop };
+
+// Invoked once per (delete hash, term, frequency) of a frequency-ordered probe.
+using RankedTermVisitor = FunctionRef<VisitControl(DeleteHash, std::string_view, int64_t)>;
 
-    auto operator<=>(const Suggestion&) const = default;
+// How delete strings are hashed into bucket keys. Lookups must use the options the index was
+// built with.
+struct HashOptions {
+    // Width of the FNV-1a hash: 64, or 32 to read indexes built before hashes were widened.
+    int bits = 64;
+    // Drops the top `compactLevel` bits of every hash, which bounds the number of buckets by
+    // 2^(bits - compactLevel): a smaller index, at the price of buckets shared by unrelated
+    // deletes whose terms lookups have to filter out (see LookupContext::probeStats()).
+    // 0 keeps the full hash; at most bits - 8.
+    int compactLevel = 0;
+
+    bool operator==(const HashOptions&) const = default;
+};
+
+// What a character is for edit distances, prefix lengths and deletes. Bytes treats every
+// byte as one. Utf8 works on the code points of UTF-8 text, so a delete removes a whole
+// sequence and an accented letter is one edit away from its plain form; words whose prefix
+// is ASCII take the byte paths unchanged. Malformed bytes count as characters of their own
+// (see utf8.hpp). Like HashOptions, lookups must use the encoding the index was built with.
+enum class TextEncoding { Bytes, Utf8 };
+
+// Build parameters and shape of a dictionary, kept next to the index by persistent stores
+// (see ISymSpellStore::loadMetadata) so that a SymSpell opened over it restores its length
+// bounds and can reject parameters the deletes were not built with. Lengths are in bytes. A
+// prefixLength of 0 marks the build parameters unknown, for indexes that predate metadata.
+// Bigram entries are not terms and are not counted.
+struct DictionaryMetadata {
+    int maxEditDistance = 0;
+    int prefixLength = 0;
+    HashOptions hashOptions;
+    TextEncoding encoding = TextEncoding::Bytes;
+    int maxWordLength = 0;
+    uint64_t termCount = 0;
+    // lengthHistogram[n]: number of terms of n bytes. Empty if unknown.
+    std::vector<uint64_t> lengthHistogram;
+    // Smallest bigram count (see SymSpell::kBigramSeparator); 0 if there are no bigrams.
+    int64_t minBigramCount = 0;
+
+    bool operator==(const DictionaryMetadata&) const = default;
+};
+
+// One delete of a bulk build: `term` indexes the term list passed alongside the postings.
+struct DeletePosting {
+    DeleteHash hash;
+    uint32_t term;
 };
 
 class ISymSpellStore {
 public:
     virtual ~ISymSpellStore() = default;
 
-    virtual void addDelete(int hash, std::string_view term) = 0;
-    virtual std::vector<std::string> getTerms(int hash) = 0;
+    virtual void addDelete(DeleteHash hash, std::string_view term) = 0;
+    virtual std::vector<std::string> getTerms(DeleteHash hash) = 0;
+
+    // Bulk insert used by SymSpell::createDictionary: every posting adds terms[posting.term] to
+    // bucket posting.hash. Postings arrive sorted by hash, so equal hashes are adjacent. The
+    // default forwards to addDelete().
+    virtual void addDeletes(std::span<const std::string_view> terms,
+                            std::span<const DeletePosting> postings) {
+        for (const auto& posting : postings) {
+            addDelete(posting.hash, terms[posting.term]);
+        }
+    }
+
+    // Zero-copy bucket enumeration used by SymSpell::lookup. Views passed to the visitor are only
+    // valid for the duration of the callback. The default falls back to getTerms() so existing
+    // stores keep working; stores with in-place buckets should override it.
+    virtual void visitTerms(DeleteHash hash, TermVisitor visitor) {
+        for (const auto& term : getTerms(hash)) {
+            if (!visitor(term)) {
+                return;
+            }
+        }
+    }
+
+    // Enumerates the buckets of several hashes in one call, passing each term together with
+    // its frequency. SymSpell::lookup probes one candidate level at a time through this, so
+    // stores with per-query overhead should answer the whole span at once. `hashes` holds no
+    // duplicates; terms may arrive in any order. The default visits each bucket in turn and
+    // reports no frequencies, leaving lookup to call getFrequency() for the few terms that
+    // survive its distance check rather than for every bucket entry.
+    virtual void visitTermsMulti(std::span<const DeleteHash> hashes, MultiTermVisitor visitor) {
+        for (DeleteHash hash : hashes) {
+            bool stopped = false;
+            visitTerms(hash, [&](std::string_view term) {
+                stopped = !visitor(hash, term, nullptr);
+                return !stopped;
+            });
+            if (stopped) {
+                return;
+            }
+        }
+    }
+
     virtual void setFrequency(std::string_view term, int64_t freq) = 0;
     virtual std::optional<int64_t> getFrequency(std::string_view term) = 0;
     virtual bool termExists(std::string_view term) = 0;
+
+    // Removal, used by SymSpell::removeDictionaryEntry and decrementDictionaryEntry: the term
+    // leaves the bucket of every delete hash first, then removeTerm() drops its frequency entry
+    // and returns false if it had none. removeDeletes() defaults to one removeDelete() per hash.
+    // The defaults of removeDelete() and removeTerm() throw std::logic_error, for read-only and
+    // append-only stores.
+    virtual void removeDelete(DeleteHash hash, std::string_view term) {
+        (void)hash;
+        (void)term;
+        throw std::logic_error("Store does not support removal");
+    }
+
+    virtual void removeDeletes(std::string_view term, std::span<const DeleteHash> hashes) {
+        for (DeleteHash hash : hashes) {
+            removeDelete(hash, term);
+        }
+    }
+
+    virtual bool removeTerm(std::string_view term) {
+        (void)term;
+        throw std::logic_error("Store does not support removal");
+    }
+
+    // True if the read methods (getTerms, visitTerms, visitTermsMulti, getFrequency,
+    // termExists) may be called from several threads at once, provided no write runs
+    // concurrently. SymSpell::lookupBatch only fans out across threads for stores that return
+    // true.
+    virtual bool supportsConcurrentReads() const { return false; }
+
+    // True if every bucket enumerates its terms in descending frequency order, so the first
+    // entry bounds the rest. Ranked lookups then probe through visitTermsByFrequency() and
+    // skip the remainder of a bucket once no term in it can displace their current results.
+    virtual bool bucketsOrderedByFrequency() const { return false; }
+
+    // Multi-bucket probe for stores whose buckets are ordered by frequency; the visitor may
+    // skip the rest of a bucket. The default adapts visitTermsMulti(), which must deliver the
+    // rows of each bucket back to back, and resolves missing frequencies with getFrequency().
+    // Stores should override it to skip buckets without enumerating them.
+    virtual void visitTermsByFrequency(std::span<const DeleteHash> hashes,
+                                       RankedTermVisitor visitor) {
+        DeleteHash skippedHash = 0;
+        bool skipping = false;
+        visitTermsMulti(hashes, [&](DeleteHash hash, std::string_view term, const int64_t* freq) {
+            if (skipping && hash == skippedHash) {
+                return true;
+            }
+            skipping = false;
+            auto control = visitor(hash, term, freq ? *freq : getFrequency(term).value_or(0));
+            if (control == VisitControl::SkipBucket) {
+                skippedHash = hash;
+                skipping = true;
+            }
+            return control != VisitControl::Stop;
+        });
+    }
+
+    // Dictionary metadata kept by persistent stores. SymSpell loads it on construction and
+    // hands the updated metadata to saveMetadata() after every change to the set of terms.
+    // A store may defer writing changes that only affect the term counts until
+    // flushMetadata(), which SymSpell calls at the end of createDictionary(). The defaults
+    // keep nothing.
+    virtual std::optional<DictionaryMetadata> loadMetadata() { return std::nullopt; }
+    virtual void saveMetadata(const DictionaryMetadata& metadata) { (void)metadata; }
+    virtual void flushMetadata() {}
+
+    // Smallest frequency of the bigram entries (keys containing SymSpell::kBigramSeparator),
+    // for stores that can scan them; nullopt if there are none or the store cannot tell.
+    // SymSpell calls it when the smallest bigram count grows.
+    virtual std::optional<int64_t> minBigramFrequency() { return std::nullopt; }
+};
+
+// Awaitable reads for stores whose probes wait on I/O: a database served from another thread,
+// a remote shard. A store implements this next to ISymSpellStore, and SymSpell::lookupAsync()
+// awaits these reads instead of blocking in the synchronous ones, so one thread can keep many
+// lookups in flight. Rows should carry their frequencies; a row without one is resolved with
+// the blocking getFrequency(). The visitor runs on whichever thread resumes the probe.
+class IAsyncSymSpellStore {
+public:
+    virtual ~IAsyncSymSpellStore() = default;
+
+    virtual Task<std::optional<int64_t>> getFrequencyAsync(std::string_view term) = 0;
+    virtual Task<void> visitTermsMultiAsync(std::span<const DeleteHash> hashes,
+                                            MultiTermVisitor visitor) = 0;
+};
+
+// Bytes held by a store's index, by role. totals() of stores built from the same dictionary
+// can be compared directly.
+struct MemoryUsage {
+    size_t termBytes = 0;        // Term text, offsets, term hashes, frequencies.
+    size_t deleteIndexBytes = 0; // Term ids in the delete buckets.
+    size_t hashTableBytes = 0;   // Term id index and delete bucket tables.
+
+    size_t total() const { return termBytes + deleteIndexBytes + hashTableBytes; }
+};
+
+// Predicted size of the MemoryStore index of a dictionary; see SymSpell::estimateFootprint().
+struct FootprintEstimate {
+    size_t words = 0;
+    size_t postings = 0; // Bucket entries: distinct delete hashes per word, summed.
+    size_t buckets = 0;
+    MemoryUsage building; // While the dictionary is built, before freeze().
+    MemoryUsage frozen;
 };
 
+// Order of the terms within each delete bucket of a frozen MemoryStore.
+enum class BucketOrder {
+    Insertion,
+    Frequency, // Descending frequency; ties by insertion order of the term.
+};
+
+// In-memory store backed by interned terms: each dictionary word is stored once in a
+// TermDictionary and delete buckets hold 32-bit TermIds, with frequencies in a parallel array
+// indexed by id.
+//
+// Once the dictionary is built, freeze() converts the bucket map into an immutable
+// FlatDeleteIndex. After that, frequencies of existing terms may still be updated, but adding
+// deletes or new terms throws std::logic_error. Updating a frequency of a store frozen with
+// BucketOrder::Frequency drops its ordering guarantee.
+//
+// Before freeze(), terms can be removed. The arena cannot give bytes back, so a removed term
+// keeps its id as a tombstone (revived if the term is added again) until freeze() compacts
+// the dictionary.
+//
+// A term that only has deletes, and no frequency set, is interned but not in the dictionary:
+// termExists() and getFrequency() do not report it, and bucket rows carry no frequency for it.
 class MemoryStore : public ISymSpellStore {
 public:
+    // Entry of frequencies() for an interned term whose frequency was never set.
+    static constexpr int64_t kNoFrequency = INT64_MIN;
+
     explicit MemoryStore(int maxEditDistance = 2, int prefixLength = 7)
         : maxEditDistance_(maxEditDistance), prefixLength_(prefixLength) {}
 
-    void addDelete(int hash, std::string_view term) override {
-        deletes_[hash].push_back(std::string(term));
+    void addDelete(DeleteHash hash, std::string_view term) override {
+        if (frozen_) {
+            throw std::logic_error("MemoryStore is frozen");
+        }
+        TermId id = internTerm(term);
+        auto& bucket = deletes_[hash];
+        // Deletes of one word are added back to back, so this catches repeated hashes cheaply.
+        if (bucket.empty() || bucket.back() != id) {
+            bucket.push_back(id);
+        }
     }
 
-    std::vector<std::string> getTerms(int hash) override {
-        auto it = deletes_.find(hash);
-        if (it != deletes_.end()) {
-            return it->second;
+    void addDeletes(std::span<const std::string_view> terms,
+                    std::span<const DeletePosting> postings) override {
+        if (frozen_) {
+            throw std::logic_error("MemoryStore is frozen");
+        }
+        // Resolve every term once instead of once per delete.
+        std::vector<TermId> ids;
+        ids.reserve(terms.size());
+        for (auto term : terms) {
+            ids.push_back(internTerm(term));
+        }
+
+        size_t buckets = 0;
+        for (size_t i = 0; i < postings.size(); ++i) {
+            buckets += (i == 0 || postings[i].hash != postings[i - 1].hash) ? 1 : 0;
+        }
+        deletes_.reserve(deletes_.size() + buckets);
+
+        for (size_t i = 0; i < postings.size();) {
+            DeleteHash hash = postings[i].hash;
+            auto& bucket = deletes_[hash];
+            for (; i < postings.size() && postings[i].hash == hash; ++i) {
+                TermId id = ids[postings[i].term];
+                if (bucket.empty() || bucket.back() != id) {
+                    bucket.push_back(id);
+                }
+            }
+        }
+    }
+
+    std::vector<std::string> getTerms(DeleteHash hash) override {
+        std::vector<std::string> result;
+        auto ids = bucket(hash);
+        result.reserve(ids.size());
+        for (TermId id : ids) {
+            result.emplace_back(terms_.term(id));
+        }
+        counters_.recordProbe(1, ids.size());
+        return result;
+    }
+
+    void visitTerms(DeleteHash hash, TermVisitor visitor) override {
+        uint64_t rows = 0;
+        for (TermId id : bucket(hash)) {
+            ++rows;
+            if (!visitor(terms_.term(id))) {
+                break;
+            }
+        }
+        counters_.recordProbe(1, rows);
+    }
+
+    void visitTermsMulti(std::span<const DeleteHash> hashes, MultiTermVisitor visitor) override {
+        uint64_t rows = 0;
+        for (DeleteHash hash : hashes) {
+            for (TermId id : bucket(hash)) {
+                ++rows;
+                const int64_t* freq = &frequencies_[id];
+                if (!visitor(hash, terms_.term(id), *freq != kNoFrequency ? freq : nullptr)) {
+                    counters_.recordProbe(hashes.size(), rows);
+                    return;
+                }
+            }
         }
-        return {};
+        counters_.recordProbe(hashes.size(), rows);
+    }
+
+    void visitTermsByFrequency(std::span<const DeleteHash> hashes,
+                               RankedTermVisitor visitor) override {
+        uint64_t rows = 0;
+        for (DeleteHash hash : hashes) {
+            for (TermId id : bucket(hash)) {
+                ++rows;
+                int64_t freq = frequencies_[id] != kNoFrequency ? frequencies_[id] : 0;
+                auto control = visitor(hash, terms_.term(id), freq);
+                if (control == VisitControl::Stop) {
+                    counters_.recordProbe(hashes.size(), rows);
+                    return;
+                }
+                if (control == VisitControl::SkipBucket) {
+                    break;
+                }
+            }
+        }
+        counters_.recordProbe(hashes.size(), rows);
     }
 
     void setFrequency(std::string_view term, int64_t freq) override {
-        words_[std::string(term)] = freq;
+        if (frozen_) {
+            auto id = terms_.find(term);
+            if (!id) {
+                throw std::logic_error("MemoryStore is frozen");
+            }
+            if (frequencies_[*id] != freq) {
+                frequencyOrdered_ = false;
+            }
+            frequencies_[*id] = freq;
+            return;
+        }
+        frequencies_[internTerm(term)] = freq;
     }
 
     std::optional<int64_t> getFrequency(std::string_view term) override {
-        auto it = words_.find(std::string(term));
-        if (it != words_.end()) {
-            return it->second;
+        if (auto id = liveId(term)) {
+            return frequencies_[*id];
         }
         return std::nullopt;
     }
 
-    bool termExists(std::string_view term) override { return words_.contains(std::string(term)); }
+    bool termExists(std::string_view term) override { return liveId(term).has_value(); }
+
+    void removeDelete(DeleteHash hash, std::string_view term) override {
+        if (frozen_) {
+            throw std::logic_error("MemoryStore is frozen");
+        }
+        auto id = terms_.find(term);
+        auto it = deletes_.find(hash);
+        if (!id || it == deletes_.end()) {
+            return;
+        }
+        auto& bucket = it->second;
+        bucket.erase(std::remove(bucket.begin(), bucket.end(), *id), bucket.end());
+        if (bucket.empty()) {
+            deletes_.erase(it);
+        }
+    }
+
+    bool removeTerm(std::string_view term) override {
+        if (frozen_) {
+            throw std::logic_error("MemoryStore is frozen");
+        }
+        auto id = liveId(term);
+        if (!id) {
+            return false;
+        }
+        removed_[*id] = true;
+        frequencies_[*id] = kNoFrequency;
+        ++removedCount_;
+        return true;
+    }
+
+    // Reads only touch immutable state, both before and after freeze().
+    bool supportsConcurrentReads() const override { return true; }
+
+    bool bucketsOrderedByFrequency() const override { return frequencyOrdered_; }
+
+    std::optional<int64_t> minBigramFrequency() override {
+        std::optional<int64_t> minimum;
+        TermDictionaryView terms = terms_.view();
+        for (TermId id = 0; id < terms.size(); ++id) {
+            int64_t freq = frequencies_[id];
+            if (freq > 0 && (!minimum || freq < *minimum) &&
+                terms.term(id).find('\x1F') != std::string_view::npos) {
+                minimum = freq;
+            }
+        }
+        return minimum;
+    }
+
+    // Compacts the delete buckets into a flat CSR layout (open-addressed hash -> offset table
+    // plus one contiguous id array) and releases the per-bucket vectors. With
+    // BucketOrder::Frequency every bucket is sorted by descending term frequency, so its first
+    // entry bounds the rest. Idempotent; the order of the first call wins.
+    void freeze(BucketOrder order = BucketOrder::Insertion) {
+        if (frozen_) {
+            return;
+        }
+        if (removedCount_ > 0) {
+            compact();
+        }
+        flat_ = FlatDeleteIndex(deletes_);
+        if (order == BucketOrder::Frequency) {
+            flat_.sortBuckets([this](TermId a, TermId b) {
+                return frequencies_[a] != frequencies_[b] ? frequencies_[a] > frequencies_[b]
+                                                          : a < b;
+            });
+            frequencyOrdered_ = true;
+        }
+        bucketCount_ = deletes_.size();
+        std::unordered_map<DeleteHash, std::vector<TermId>>().swap(deletes_);
+        terms_.shrinkToFit();
+        frequencies_.shrink_to_fit();
+        frozen_ = true;
+    }
+
+    bool frozen() const { return frozen_; }
+
+    // Interned terms, including bigram keys (SymSpell::kBigramSeparator) and terms that only
+    // have deletes.
+    size_t termCount() const { return terms_.size() - removedCount_; }
+    size_t bucketCount() const { return frozen_ ? bucketCount_ : deletes_.size(); }
+
+    int maxEditDistance() const { return maxEditDistance_; }
+    int prefixLength() const { return prefixLength_; }
+
+    TermDictionaryView terms() const { return terms_.view(); }
+    std::span<const int64_t> frequencies() const { return frequencies_; }
+    // Empty until freeze() has been called.
+    FlatDeleteIndexView deleteIndex() const { return flat_.view(); }
+
+    // Heap bytes held by the store: vector capacities, and for the bucket map of an unfrozen
+    // store its nodes and bucket array. Allocator bookkeeping is not included.
+    MemoryUsage memoryUsage() const {
+        MemoryUsage usage;
+        usage.termBytes = terms_.storageBytes() + frequencies_.capacity() * sizeof(int64_t) +
+                          removed_.capacity() / 8;
+        usage.hashTableBytes = terms_.indexBytes();
+        if (frozen_) {
+            usage.deleteIndexBytes = flat_.idCount() * sizeof(TermId);
+            usage.hashTableBytes += flat_.slotCount() * sizeof(FlatBucketSlot);
+        } else {
+            for (const auto& [hash, bucket] : deletes_) {
+                usage.deleteIndexBytes += bucket.capacity() * sizeof(TermId);
+            }
+            usage.hashTableBytes +=
+                deletes_.size() * kBucketNodeBytes + deletes_.bucket_count() * sizeof(void*);
+        }
+        return usage;
+    }
+
+    // memoryUsage() of a store holding `terms` terms of `termChars` bytes in total, with
+    // `postings` entries in `buckets` delete buckets, before or after freeze(). Unfrozen
+    // vectors are assumed to have grown by doubling; `bucketSlack` is the ratio of bucket
+    // capacity to bucket size.
+    static MemoryUsage estimateMemoryUsage(size_t terms, size_t termChars, size_t buckets,
+                                           size_t postings, bool frozen,
+                                           double bucketSlack = 1.0) {
+        auto grown = [frozen](size_t n) { return frozen ? n : std::bit_ceil(n); };
+        MemoryUsage usage;
+        usage.termBytes = grown(termChars) + (grown(terms + 1) + grown(terms)) * sizeof(uint32_t) +
+                          grown(terms) * sizeof(int64_t) + std::bit_ceil(terms) / 8;
+        usage.hashTableBytes = TermDictionary::indexSlotsFor(terms) * sizeof(uint32_t);
+        if (frozen) {
+            usage.deleteIndexBytes = postings * sizeof(TermId);
+            usage.hashTableBytes += FlatDeleteIndex::slotsFor(buckets) * sizeof(FlatBucketSlot);
+        } else {
+            usage.deleteIndexBytes =
+                static_cast<size_t>(static_cast<double>(postings * sizeof(TermId)) * bucketSlack);
+            usage.hashTableBytes += buckets * (kBucketNodeBytes + sizeof(void*));
+        }
+        return usage;
+    }
+
+    // Read counters, zero unless built with YAMS_SYMSPELL_METRICS (see metrics.hpp).
+    StoreMetrics metrics() const { return counters_.snapshot(); }
+    void resetMetrics() { counters_.reset(); }
+
+    // histogram[i] is the number of delete buckets holding [2^i, 2^(i+1)) terms. Computed on
+    // each call by walking the index, so it costs nothing on the lookup path.
+    std::vector<size_t> bucketSizeHistogram() const {
+        std::vector<size_t> histogram;
+        auto count = [&](size_t size) {
+            if (size == 0) {
+                return;
+            }
+            auto bin = static_cast<size_t>(std::bit_width(size) - 1);
+            if (histogram.size() <= bin) {
+                histogram.resize(bin + 1, 0);
+            }
+            ++histogram[bin];
+        };
+        if (frozen_) {
+            for (const auto& slot : flat_.view().slots()) {
+                count(slot.count);
+            }
+        } else {
+            for (const auto& [hash, bucket] : deletes_) {
+                count(bucket.size());
+            }
+        }
+        return histogram;
+    }
 
 private:
+    // A node of deletes_ in the common standard libraries: next pointer plus the value.
+    static constexpr size_t kBucketNodeBytes =
+        sizeof(void*) + sizeof(std::pair<const DeleteHash, std::vector<TermId>>);
+
+    std::span<const TermId> bucket(DeleteHash hash) const {
+        if (frozen_) {
+            return flat_.view().find(hash);
+        }
+        auto it = deletes_.find(hash);
+        if (it == deletes_.end()) {
+            return {};
+        }
+        return it->second;
+    }
+
+    TermId internTerm(std::string_view term) {
+        TermId id = terms_.intern(term);
+        if (id == frequencies_.size()) {
+            frequencies_.push_back(kNoFrequency);
+            removed_.push_back(false);
+        } else if (removed_[id]) {
+            removed_[id] = false;
+            --removedCount_;
+        }
+        return id;
+    }
+
+    // Removed terms keep kNoFrequency until they are added again.
+    std::optional<TermId> liveId(std::string_view term) const {
+        auto id = terms_.find(term);
+        if (id && frequencies_[*id] == kNoFrequency) {
+            return std::nullopt;
+        }
+        return id;
+    }
+
+    // Rebuilds the dictionary without tombstones and renumbers the bucket entries.
+    void compact() {
+        TermDictionary terms;
+        std::vector<int64_t> frequencies;
+        std::vector<TermId> remap(terms_.size(), 0);
+        terms.reserve(terms_.size() - removedCount_, terms_.view().chars().size());
+        frequencies.reserve(terms_.size() - removedCount_);
+        for (TermId id = 0; id < terms_.size(); ++id) {
+            if (!removed_[id]) {
+                remap[id] = terms.intern(terms_.term(id));
+                frequencies.push_back(frequencies_[id]);
+            }
+        }
+        for (auto& [hash, bucket] : deletes_) {
+            std::erase_if(bucket, [this](TermId id) { return removed_[id]; });
+            for (TermId& id : bucket) {
+                id = remap[id];
+            }
+        }
+        std::erase_if(deletes_, [](const auto& entry) { return entry.second.empty(); });
+        terms_ = std::move(terms);
+        frequencies_ = std::move(frequencies);
+        removed_.assign(terms_.size(), false);
+        removedCount_ = 0;
+    }
+
     int maxEditDistance_;
     int prefixLength_;
-    std::unordered_map<int, std::vector<std::string>> deletes_;
-    std::unordered_map<std::string, int64_t> words_;
+    TermDictionary terms_;
+    std::vector<int64_t> frequencies_;
+    std::unordered_map<DeleteHash, std::vector<TermId>> deletes_;
+    FlatDeleteIndex flat_;
+    std::vector<bool> removed_;
+    size_t removedCount_ = 0;
+    size_t bucketCount_ = 0;
+    bool frozen_ = false;
+    detail::StoreCounters counters_;
+    bool frequencyOrdered_ = false;
+};
+
+struct DictionaryEntry {
+    std::string_view term;
+    int64_t count;
 };
 
+struct BuildOptions {
+    // Threads generating deletes in createDictionary; 0 uses hardware_concurrency().
+    size_t threads = 0;
+};
+
+struct BatchOptions {
+    // Worker threads for lookupBatch; 0 uses std::thread::hardware_concurrency().
+    size_t threads = 0;
+    // Batches with fewer distinct inputs per thread run on fewer threads.
+    size_t minInputsPerThread = 16;
+};
+
+// Thread-safety: lookup() and lookupBatch() are const and may run concurrently with each
+// other when the store reports supportsConcurrentReads(). Dictionary mutations
+// (createDictionaryEntry, setCountThreshold) must not overlap with any other call.
 class SymSpell {
 public:
-    SymSpell(std::unique_ptr<ISymSpellStore> store, int maxEditDistance = 2, int prefixLength = 7)
-        : store_(std::move(store)), maxEditDistance_(maxEditDistance), prefixLength_(prefixLength),
-          compactMask_(calculateCompactMask(5)), maxDictionaryWordLength_(0) {}
+    SymSpell(std::unique_ptr<ISymSpellStore> store, int maxEditDistance = 2, int prefixLength = 7,
+             const HashOptions& hashOptions = {}, TextEncoding encoding = TextEncoding::Bytes)
+        : store_(std::move(store)), asyncStore_(dynamic_cast<IAsyncSymSpellStore*>(store_.get())),
+          maxEditDistance_(maxEditDistance), prefixLength_(prefixLength),
+          hashOptions_(hashOptions), encoding_(encoding),
+          compactMask_(calculateCompactMask(hashOptions)),
+          deleteGenerator_(selectDeleteGenerator(maxEditDistance, prefixLength)),
+          maxDictionaryWordLength_(0) {
+        restoreMetadata();
+    }
 
+    // Adds `count` to `key`. Returns false if count <= 0, if the key is a bigram key (see
+    // kBigramSeparator) or if the key was already in the dictionary or stays staged.
     bool createDictionaryEntry(std::string_view key, int64_t count = 1) {
-        if (count <= 0) {
+        if (count <= 0 || isBigramKey(key)) {
             return false;
         }
 
-        auto it = belowThresholdWords_.find(std::string(key));
+        auto it = belowThresholdWords_.find(key);
         if (it != belowThresholdWords_.end()) {
-            count = std::min<int64_t>(INT64_MAX - it->second, it->second + count);
+            count = saturatingAdd(it->second, count);
             if (count >= countThreshold_) {
                 belowThresholdWords_.erase(it);
             } else {
-                belowThresholdWords_[std::string(key)] = count;
+                it->second = count;
                 return false;
             }
         } else {
             auto freq = store_->getFrequency(key);
             if (freq.has_value()) {
-                count = std::min<int64_t>(INT64_MAX - *freq, *freq + count);
+                count = saturatingAdd(*freq, count);
+                ++dictionaryVersion_;
                 store_->setFrequency(key, count);
                 return false;
             } else if (count < countThreshold_) {
-                belowThresholdWords_[std::string(key)] = count;
+                stage(key, count);
                 return false;
             }
         }
 
+        ++dictionaryVersion_;
         store_->setFrequency(key, count);
-        if (key.size() > static_cast<size_t>(maxDictionaryWordLength_)) {
-            maxDictionaryWordLength_ = static_cast<int>(key.size());
-        }
+        recordTerm(key.size());
 
-        auto edits = editsPrefix(key);
-        for (const auto& deleteWord : edits) {
-            int deleteHash = getStringHash(deleteWord);
-            store_->addDelete(deleteHash, key);
+        std::string word;
+        std::vector<DeleteHash> hashes;
+        generateDeleteHashes(key, word, hashes);
+        for (DeleteHash hash : hashes) {
+            store_->addDelete(hash, key);
         }
+        store_->saveMetadata(metadata_);
 
         return true;
     }
 
-    std::vector<Suggestion> lookup(std::string_view input, Verbosity verbosity = Verbosity::Closest,
-                                   int maxEditDistance = -1) const {
-        if (maxEditDistance < 0) {
-            maxEditDistance = maxEditDistance_;
+    // Bulk build: equivalent to calling createDictionaryEntry for every entry (same count
+    // threshold and accumulation semantics), but deletes are generated in parallel, grouped by
+    // hash and written to the store bucket by bucket in one pass. Term views only need to stay
+    // valid for the duration of the call. Returns the number of terms added to the dictionary.
+    // Entries with bigram keys are skipped.
+    size_t createDictionary(std::span<const DictionaryEntry> entries,
+                            const BuildOptions& options = {}) {
+        std::vector<DictionaryEntry> added;
+        {
+            std::unordered_map<std::string_view, size_t> index;
+            std::vector<DictionaryEntry> merged;
+            index.reserve(entries.size());
+            for (const auto& entry : entries) {
+                if (entry.count <= 0 || isBigramKey(entry.term)) {
+                    continue;
+                }
+                auto [it, inserted] = index.emplace(entry.term, merged.size());
+                if (inserted) {
+                    merged.push_back(entry);
+                } else {
+                    auto& target = merged[it->second];
+                    target.count = saturatingAdd(target.count, entry.count);
+                }
+            }
+
+            for (auto entry : merged) {
+                auto staged = belowThresholdWords_.find(entry.term);
+                if (staged != belowThresholdWords_.end()) {
+                    entry.count = saturatingAdd(staged->second, entry.count);
+                    if (entry.count < countThreshold_) {
+                        staged->second = entry.count;
+                        continue;
+                    }
+                    belowThresholdWords_.erase(staged);
+                } else if (auto freq = store_->getFrequency(entry.term)) {
+                    ++dictionaryVersion_;
+                    store_->setFrequency(entry.term, saturatingAdd(*freq, entry.count));
+                    continue;
+                } else if (entry.count < countThreshold_) {
+                    stage(entry.term, entry.count);
+                    continue;
+                }
+                added.push_back(entry);
+            }
         }
 
-        if (maxEditDistance > maxEditDistance_) {
-            maxEditDistance = maxEditDistance_;
+        if (!added.empty()) {
+            ++dictionaryVersion_;
+        }
+        for (const auto& entry : added) {
+            store_->setFrequency(entry.term, entry.count);
+            recordTerm(entry.term.size());
         }
 
-        std::vector<Suggestion> suggestions;
-        int inputLen = static_cast<int>(input.size());
+        writeDeletes(added, options);
+        if (!added.empty()) {
+            store_->saveMetadata(metadata_);
+            store_->flushMetadata();
+        }
+        return added.size();
+    }
 
-        // Early exit if input is too long for any dictionary word
-        // Skip this check if maxDictionaryWordLength_ is 0 (not yet computed, e.g., loaded from DB)
-        if (maxDictionaryWordLength_ > 0 && inputLen - maxEditDistance > maxDictionaryWordLength_) {
-            return suggestions;
+    // Convenience overload for containers of (term, count) pairs, e.g.
+    // std::vector<std::pair<std::string, int64_t>>. Elements must be stored in the container.
+    template <typename Range>
+        requires std::is_lvalue_reference_v<std::ranges::range_reference_t<const Range>>
+    size_t createDictionary(const Range& entries, const BuildOptions& options = {}) {
+        std::vector<DictionaryEntry> converted;
+        if constexpr (std::ranges::sized_range<const Range>) {
+            converted.reserve(std::ranges::size(entries));
+        }
+        for (const auto& [term, count] : entries) {
+            converted.push_back(
+                DictionaryEntry{std::string_view(term), static_cast<int64_t>(count)});
         }
+        return createDictionary(std::span<const DictionaryEntry>(converted), options);
+    }
 
-        auto exactFreq = store_->getFrequency(input);
-        if (exactFreq.has_value()) {
-            suggestions.push_back({std::string(input), 0, *exactFreq});
-            if (verbosity != Verbosity::All) {
-                return suggestions;
+    // Reads a frequency file with one "term count" pair per line (whitespace separated, the
+    // format of the reference SymSpell dictionaries) and bulk-builds from it. Lines without a
+    // positive count are skipped. Returns the number of terms added. For large files and raw
+    // corpora see the chunked, allocation-free loaders in dictionary_loader.hpp.
+    size_t createDictionary(std::istream& in, const BuildOptions& options = {}) {
+        std::vector<std::string> terms;
+        std::vector<int64_t> counts;
+        std::string line;
+        while (std::getline(in, line)) {
+            auto termBegin = line.find_first_not_of(" \t\r");
+            if (termBegin == std::string::npos) {
+                continue;
             }
+            auto termEnd = line.find_first_of(" \t", termBegin);
+            if (termEnd == std::string::npos) {
+                continue;
+            }
+            char* end = nullptr;
+            long long count = std::strtoll(line.c_str() + termEnd, &end, 10);
+            if (end == line.c_str() + termEnd || count <= 0) {
+                continue;
+            }
+            terms.push_back(line.substr(termBegin, termEnd - termBegin));
+            counts.push_back(count);
         }
 
-        if (maxEditDistance == 0) {
-            return suggestions;
+        std::vector<DictionaryEntry> entries;
+        entries.reserve(terms.size());
+        for (size_t i = 0; i < terms.size(); ++i) {
+            entries.push_back(DictionaryEntry{terms[i], counts[i]});
         }
+        return createDictionary(std::span<const DictionaryEntry>(entries), options);
+    }
 
-        std::unordered_set<std::string> consideredDeletes;
-        std::unordered_set<std::string> consideredSuggestions;
-        consideredSuggestions.insert(std::string(input));
-
-        int maxEditDistance2 = maxEditDistance;
-        std::vector<std::string> candidates;
-        int inputPrefixLen = inputLen;
+    // Separator of the two words of a bigram key. Bigram counts used by lookupCompound() are
+    // kept in the store as ordinary frequency entries under "first\x1Fsecond", so every store
+    // persists them unchanged. They get no deletes and never appear as suggestions: the
+    // dictionary entry points skip keys containing the separator.
+    static constexpr char kBigramSeparator = '\x1F';
 
-        if (inputPrefixLen > prefixLength_) {
-            inputPrefixLen = prefixLength_;
-        }
-        candidates.push_back(std::string(input.substr(0, inputPrefixLen)));
+    static bool isBigramKey(std::string_view key) {
+        return key.find(kBigramSeparator) != std::string_view::npos;
+    }
 
-        size_t candidatePointer = 0;
+    static std::string bigramKey(std::string_view first, std::string_view second) {
+        std::string key;
+        key.reserve(first.size() + second.size() + 1);
+        key.append(first).append(1, kBigramSeparator).append(second);
+        return key;
+    }
 
-        while (candidatePointer < candidates.size()) {
-            // Copy the candidate to avoid iterator invalidation when push_back reallocates
-            std::string candidate = candidates[candidatePointer++];
-            int candidateLen = static_cast<int>(candidate.size());
-            int lengthDiff = inputPrefixLen - candidateLen;
+    // Adds `count` to the bigram (first, second). Returns false if count <= 0.
+    bool createBigramEntry(std::string_view first, std::string_view second, int64_t count) {
+        bool smallestGrew = false;
+        if (!addBigram(first, second, count, smallestGrew)) {
+            return false;
+        }
+        if (smallestGrew) {
+            refreshMinBigramCount();
+        }
+        store_->saveMetadata(metadata_);
+        return true;
+    }
 
-            if (lengthDiff > maxEditDistance2) {
-                if (verbosity == Verbosity::All) {
-                    continue;
-                }
-                break;
+    // Reads a bigram file with one "first second count" triple per line (the format of the
+    // reference SymSpell bigram dictionaries). Returns the number of entries read.
+    size_t createBigramDictionary(std::istream& in) {
+        size_t added = 0;
+        bool smallestGrew = false;
+        std::string line;
+        while (std::getline(in, line)) {
+            auto firstBegin = line.find_first_not_of(" \t\r");
+            auto firstEnd = line.find_first_of(" \t", firstBegin);
+            auto secondBegin = line.find_first_not_of(" \t", firstEnd);
+            auto secondEnd = line.find_first_of(" \t", secondBegin);
+            if (firstBegin == std::string::npos || secondEnd == std::string::npos) {
+                continue;
             }
+            char* end = nullptr;
+            long long count = std::strtoll(line.c_str() + secondEnd, &end, 10);
+            if (end == line.c_str() + secondEnd || count <= 0) {
+                continue;
+            }
+            std::string_view view(line);
+            added += addBigram(view.substr(firstBegin, firstEnd - firstBegin),
+                               view.substr(secondBegin, secondEnd - secondBegin), count,
+                               smallestGrew)
+                         ? 1
+                         : 0;
+        }
+        if (smallestGrew) {
+            refreshMinBigramCount();
+        }
+        if (added > 0) {
+            store_->saveMetadata(metadata_);
+            store_->flushMetadata();
+        }
+        return added;
+    }
 
-            int deleteHash = getStringHash(candidate);
-            auto dictTerms = store_->getTerms(deleteHash);
+    std::optional<int64_t> bigramFrequency(std::string_view first, std::string_view second) const {
+        return store_->getFrequency(bigramKey(first, second));
+    }
 
-            for (const auto& suggestion : dictTerms) {
-                if (suggestion == input) {
-                    continue;
-                }
+    // Smallest bigram count of the dictionary, persisted with its metadata; INT64_MAX if there
+    // is none.
+    int64_t minBigramCount() const {
+        return metadata_.minBigramCount > 0 ? metadata_.minBigramCount : INT64_MAX;
+    }
 
-                int suggestionLen = static_cast<int>(suggestion.size());
+    std::vector<Suggestion> lookup(std::string_view input, Verbosity verbosity = Verbosity::Closest,
+                                   int maxEditDistance = -1) const {
+        LookupContext context;
+        lookup(input, context, verbosity, maxEditDistance);
+        return takeResults(context);
+    }
 
-                if (std::abs(suggestionLen - inputLen) > maxEditDistance2) {
-                    continue;
-                }
+    // Allocation-free lookup: all scratch state lives in the caller-owned `context`, which is
+    // reused across calls. The returned span points into `context` and stays valid until the
+    // next lookup made with it.
+    std::span<const Suggestion> lookup(std::string_view input, LookupContext& context,
+                                       Verbosity verbosity = Verbosity::Closest,
+                                       int maxEditDistance = -1) const {
+        return lookupCached(input, context, verbosity, verbosity == Verbosity::Top ? 1 : 0,
+                            maxEditDistance);
+    }
 
-                if (suggestionLen < candidateLen) {
-                    continue;
-                }
+    // The `k` best suggestions within the edit distance, ordered by ascending distance and
+    // then descending frequency. Unlike Verbosity::Closest the results may span several
+    // distances; lookupTopK(input, 1) is Verbosity::Top. Candidates that cannot displace the
+    // current k-th result are rejected before or during their distance check.
+    std::vector<Suggestion> lookupTopK(std::string_view input, size_t k,
+                                       int maxEditDistance = -1) const {
+        LookupContext context;
+        lookupTopK(input, context, k, maxEditDistance);
+        return takeResults(context);
+    }
 
-                if (suggestionLen == candidateLen && suggestion != candidate) {
-                    continue;
-                }
+    std::span<const Suggestion> lookupTopK(std::string_view input, LookupContext& context,
+                                           size_t k, int maxEditDistance = -1) const {
+        if (k == 0) {
+            context.reset();
+            return context.results();
+        }
+        return lookupCached(input, context, Verbosity::Top, k, maxEditDistance);
+    }
 
-                int suggPrefixLen = std::min(suggestionLen, prefixLength_);
-                if (suggPrefixLen > inputPrefixLen &&
-                    (suggPrefixLen - candidateLen) > maxEditDistance2) {
-                    continue;
-                }
+    // Coroutine form of lookup(). With a store that implements IAsyncSymSpellStore every probe
+    // is awaited, so the calling thread is free while the store works; with any other store
+    // the lookup runs synchronously and the task completes without suspending. The result
+    // cache is used as in lookup(). `input` must stay valid, and `context` unused, until the
+    // task completes.
+    Task<std::span<const Suggestion>> lookupAsync(std::string_view input, LookupContext& context,
+                                                  Verbosity verbosity = Verbosity::Closest,
+                                                  int maxEditDistance = -1) const {
+        size_t limit = verbosity == Verbosity::Top ? 1 : 0;
+        maxEditDistance = clampEditDistance(maxEditDistance);
+        if (!asyncStore_) {
+            co_return lookupCached(input, context, verbosity, limit, maxEditDistance);
+        }
+        detail::countMetric(context.lookupStats_.lookups);
+        if (!cache_) {
+            co_return co_await lookupUncachedAsync(input, context, verbosity, limit,
+                                                   maxEditDistance);
+        }
 
-                if (!deleteInSuggestionPrefix(candidate, suggestion)) {
-                    continue;
-                }
+        std::string& key = cacheKey(context, input, verbosity, limit, maxEditDistance);
+        if (serveCached(context, key)) {
+            co_return context.results();
+        }
+        auto results =
+            co_await lookupUncachedAsync(input, context, verbosity, limit, maxEditDistance);
+        cache_->insert(key, dictionaryVersion_, results);
+        co_return results;
+    }
 
-                if (!consideredSuggestions.insert(suggestion).second) {
-                    continue;
-                }
+    Task<std::vector<Suggestion>> lookupAsync(std::string_view input,
+                                              Verbosity verbosity = Verbosity::Closest,
+                                              int maxEditDistance = -1) const {
+        LookupContext context;
+        co_await lookupAsync(input, context, verbosity, maxEditDistance);
+        co_return takeResults(context);
+    }
 
-                int distance = damerauLevenshteinDistance(input, suggestion, maxEditDistance2);
-                if (distance < 0 || distance > maxEditDistance2) {
-                    continue;
+    // Looks up every input and returns the results in input order. Repeated inputs are looked
+    // up once. Work is spread over `options.threads` workers, each with its own LookupContext,
+    // when the store supports concurrent reads; otherwise the batch runs on the calling thread.
+    std::vector<std::vector<Suggestion>> lookupBatch(std::span<const std::string_view> inputs,
+                                                     Verbosity verbosity = Verbosity::Closest,
+                                                     int maxEditDistance = -1,
+                                                     const BatchOptions& options = {}) const {
+        std::vector<std::string_view> unique;
+        std::vector<size_t> slotOf(inputs.size());
+        {
+            std::unordered_map<std::string_view, size_t> seen;
+            seen.reserve(inputs.size());
+            for (size_t i = 0; i < inputs.size(); ++i) {
+                auto [it, inserted] = seen.emplace(inputs[i], unique.size());
+                if (inserted) {
+                    unique.push_back(inputs[i]);
                 }
+                slotOf[i] = it->second;
+            }
+        }
 
-                auto freq = store_->getFrequency(suggestion);
-                int64_t suggestionFreq = freq.value_or(0);
-
-                if (verbosity == Verbosity::Top) {
-                    if (suggestions.empty()) {
-                        maxEditDistance2 = distance;
-                        suggestions.push_back({suggestion, distance, suggestionFreq});
-                    } else if (distance < maxEditDistance2 ||
-                               (distance == maxEditDistance2 &&
-                                suggestionFreq > suggestions[0].frequency)) {
-                        maxEditDistance2 = distance;
-                        suggestions[0] = {suggestion, distance, suggestionFreq};
-                    }
-                } else if (verbosity == Verbosity::Closest) {
-                    if (distance < maxEditDistance2) {
-                        suggestions.clear();
-                        maxEditDistance2 = distance;
-                        suggestions.push_back({suggestion, distance, suggestionFreq});
-                    } else if (distance == maxEditDistance2) {
-                        suggestions.push_back({suggestion, distance, suggestionFreq});
+        std::vector<std::vector<Suggestion>> uniqueResults(unique.size());
+        std::atomic<size_t> next{0};
+        auto worker = [&]() {
+            LookupContext context;
+            for (size_t i = next.fetch_add(1); i < unique.size(); i = next.fetch_add(1)) {
+                auto results = lookup(unique[i], context, verbosity, maxEditDistance);
+                uniqueResults[i].assign(results.begin(), results.end());
+            }
+        };
+
+        size_t threads = options.threads != 0 ? options.threads
+                                              : std::max(1u, std::thread::hardware_concurrency());
+        size_t minPerThread = std::max<size_t>(1, options.minInputsPerThread);
+        threads = std::min(threads, unique.size() / minPerThread);
+        if (!store_->supportsConcurrentReads()) {
+            threads = 1;
+        }
+
+        if (threads <= 1) {
+            worker();
+        } else {
+            std::exception_ptr failure;
+            std::mutex failureMutex;
+            std::vector<std::thread> pool;
+            pool.reserve(threads - 1);
+            auto guarded = [&]() {
+                try {
+                    worker();
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(failureMutex);
+                    if (!failure) {
+                        failure = std::current_exception();
                     }
-                } else {
-                    suggestions.push_back({suggestion, distance, suggestionFreq});
+                    next.store(unique.size());
                 }
+            };
+            for (size_t t = 1; t < threads; ++t) {
+                pool.emplace_back(guarded);
+            }
+            guarded();
+            for (auto& thread : pool) {
+                thread.join();
             }
+            if (failure) {
+                std::rethrow_exception(failure);
+            }
+        }
 
-            if (lengthDiff < maxEditDistance_ && candidateLen <= prefixLength_) {
-                if (verbosity != Verbosity::All && lengthDiff >= maxEditDistance2) {
-                    continue;
-                }
+        std::vector<std::vector<Suggestion>> results(inputs.size());
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            results[i] = uniqueResults[slotOf[i]];
+        }
+        return results;
+    }
 
-                for (int i = 0; i < candidateLen; ++i) {
-                    std::string deleteWord = candidate;
-                    deleteWord.erase(i, 1);
+    // Removes `key` from the dictionary: its deletes and frequency entry, or its staged count
+    // if it is below the count threshold. Returns false if it was neither.
+    bool removeDictionaryEntry(std::string_view key) {
+        auto it = belowThresholdWords_.find(key);
+        if (it != belowThresholdWords_.end()) {
+            belowThresholdWords_.erase(it);
+            return true;
+        }
+        if (!store_->termExists(key)) {
+            return false;
+        }
+        removeFromStore(key);
+        return true;
+    }
 
-                    if (consideredDeletes.insert(deleteWord).second) {
-                        candidates.push_back(std::move(deleteWord));
-                    }
-                }
+    // Inverse of createDictionaryEntry: subtracts `count` from the word's count. A word whose
+    // count drops below the threshold leaves the dictionary but keeps its remaining count in
+    // the staging area, so later additions can promote it again; at zero it is forgotten.
+    // Returns false if count <= 0 or the word is neither in the dictionary nor staged.
+    bool decrementDictionaryEntry(std::string_view key, int64_t count = 1) {
+        if (count <= 0) {
+            return false;
+        }
+        auto it = belowThresholdWords_.find(key);
+        if (it != belowThresholdWords_.end()) {
+            it->second -= std::min(count, it->second);
+            if (it->second == 0) {
+                belowThresholdWords_.erase(it);
             }
+            return true;
+        }
+        auto freq = store_->getFrequency(key);
+        if (!freq) {
+            return false;
+        }
+        int64_t remaining = *freq - std::min(count, *freq);
+        if (remaining >= countThreshold_ && remaining > 0) {
+            ++dictionaryVersion_;
+            store_->setFrequency(key, remaining);
+            return true;
         }
+        removeFromStore(key);
+        if (remaining > 0) {
+            stage(key, remaining);
+        }
+        return true;
+    }
 
-        if (verbosity != Verbosity::All && !suggestions.empty()) {
-            std::sort(suggestions.begin(), suggestions.end(),
-                      [](const Suggestion& a, const Suggestion& b) {
-                          if (a.distance != b.distance) {
-                              return a.distance < b.distance;
-                          }
-                          return a.frequency > b.frequency;
-                      });
+    void setCountThreshold(int64_t threshold) { countThreshold_ = threshold; }
 
-            if (verbosity == Verbosity::Closest) {
-                int minDist = suggestions[0].distance;
-                suggestions.erase(std::remove_if(suggestions.begin() + 1, suggestions.end(),
-                                                 [minDist](const Suggestion& s) {
-                                                     return s.distance != minDist;
-                                                 }),
-                                  suggestions.end());
-            }
+    // Bounds the staging area for words below the count threshold. When a new word would not
+    // fit, the least frequent half of the staged words is dropped, which keeps eviction
+    // amortized O(1) per word. 0 disables staging: sub-threshold counts are discarded.
+    void setStagingCapacity(size_t maxWords) {
+        stagingCapacity_ = maxWords;
+        if (belowThresholdWords_.size() > stagingCapacity_) {
+            evictStaged(stagingCapacity_);
         }
+    }
 
-        return suggestions;
+    size_t stagedCount() const { return belowThresholdWords_.size(); }
+    // Staged words dropped to respect the staging capacity.
+    uint64_t stagingEvictions() const { return stagingEvictions_; }
+
+    // Enables a bounded LRU cache of lookup results keyed by (input, verbosity, edit distance)
+    // and split over `shards` independently locked shards; capacity 0 disables it. Entries are
+    // versioned: createDictionaryEntry() and createDictionary() retire all cached results.
+    // Changes made directly through store() must be followed by invalidateLookupCache().
+    void enableLookupCache(size_t capacity, size_t shards = 16) {
+        cache_ = capacity > 0 ? std::make_unique<LookupCache>(capacity, shards) : nullptr;
     }
 
-    void setCountThreshold(int64_t threshold) { countThreshold_ = threshold; }
+    void invalidateLookupCache() { ++dictionaryVersion_; }
+
+    LookupCacheStats lookupCacheStats() const {
+        return cache_ ? cache_->stats() : LookupCacheStats{};
+    }
 
     int maxEditDistance() const { return maxEditDistance_; }
     int prefixLength() const { return prefixLength_; }
+    const HashOptions& hashOptions() const { return hashOptions_; }
+    TextEncoding encoding() const { return encoding_; }
+    // In bytes, whatever the encoding.
     int maxWordLength() const { return maxDictionaryWordLength_; }
+    // Parameters and shape of the dictionary as persisted: restored from the store's metadata
+    // on construction and updated with every term added or removed. maxWordLength only grows.
+    // The build parameters are unknown (prefixLength 0) for a store persisted without them.
+    const DictionaryMetadata& metadata() const { return metadata_; }
+
+    // Records this instance's build parameters in a store that reports them unknown, so later
+    // instances with other ones are rejected. Only call it if the store's deletes were built
+    // with exactly these parameters. Does nothing if the parameters are known.
+    void recordBuildParameters() {
+        if (metadata_.prefixLength != 0) {
+            return;
+        }
+        metadata_.maxEditDistance = maxEditDistance_;
+        metadata_.prefixLength = prefixLength_;
+        metadata_.hashOptions = hashOptions_;
+        metadata_.encoding = encoding_;
+        store_->saveMetadata(metadata_);
+        store_->flushMetadata();
+    }
+
+    // Changes whenever the dictionary does, for callers that cache work derived from lookups.
+    uint64_t dictionaryVersion() const { return dictionaryVersion_; }
+
+    ISymSpellStore& store() { return *store_; }
+    const ISymSpellStore& store() const { return *store_; }
+
+    // Predicts the MemoryStore index of a `totalWords`-word dictionary from a random sample
+    // of its words, without building it. Postings scale with the word count. Buckets do not,
+    // since words share deletes: their count is extrapolated as words^alpha, with alpha fitted
+    // between the first half of the sample and all of it. Byte counts follow from the store
+    // layout (MemoryStore::estimateMemoryUsage).
+    static FootprintEstimate estimateFootprint(std::span<const std::string_view> sample,
+                                               size_t totalWords, int maxEditDistance = 2,
+                                               int prefixLength = 7,
+                                               const HashOptions& hashOptions = {},
+                                               TextEncoding encoding = TextEncoding::Bytes) {
+        SymSpell generator(std::make_unique<MemoryStore>(maxEditDistance, prefixLength),
+                           maxEditDistance, prefixLength, hashOptions, encoding);
+        std::vector<std::string_view> words;
+        {
+            std::unordered_set<std::string_view> seen;
+            for (auto word : sample) {
+                if (seen.insert(word).second) {
+                    words.push_back(word);
+                }
+            }
+        }
+        FootprintEstimate estimate;
+        estimate.words = totalWords;
+        if (words.empty() || totalWords == 0) {
+            return estimate;
+        }
+
+        std::unordered_map<DeleteHash, uint32_t> bucketSizes;
+        size_t half = words.size() / 2;
+        size_t halfBuckets = 0;
+        size_t chars = 0;
+        size_t postings = 0;
+        std::string scratch;
+        std::vector<DeleteHash> hashes;
+        for (size_t i = 0; i < words.size(); ++i) {
+            if (i == half) {
+                halfBuckets = bucketSizes.size();
+            }
+            hashes.clear();
+            generator.generateDeleteHashes(words[i], scratch, hashes);
+            for (DeleteHash hash : hashes) {
+                ++bucketSizes[hash];
+            }
+            postings += hashes.size();
+            chars += words[i].size();
+        }
+
+        double scale = static_cast<double>(totalWords) / static_cast<double>(words.size());
+        double alpha = 1.0;
+        if (half > 0 && halfBuckets > 0) {
+            alpha = std::log(static_cast<double>(bucketSizes.size()) / halfBuckets) /
+                    std::log(static_cast<double>(words.size()) / half);
+            alpha = std::clamp(alpha, 0.0, 1.0);
+        }
+        size_t slackCapacity = 0;
+        for (const auto& [hash, size] : bucketSizes) {
+            slackCapacity += std::bit_ceil(size);
+        }
+
+        estimate.postings = static_cast<size_t>(static_cast<double>(postings) * scale);
+        estimate.buckets = std::min(
+            estimate.postings,
+            static_cast<size_t>(static_cast<double>(bucketSizes.size()) * std::pow(scale, alpha)));
+        auto termChars = static_cast<size_t>(static_cast<double>(chars) * scale);
+        double slack = static_cast<double>(slackCapacity) / static_cast<double>(postings);
+        estimate.building = MemoryStore::estimateMemoryUsage(
+            totalWords, termChars, estimate.buckets, estimate.postings, false, slack);
+        estimate.frozen = MemoryStore::estimateMemoryUsage(totalWords, termChars, estimate.buckets,
+                                                           estimate.postings, true);
+        return estimate;
+    }
 
 private:
-    static uint32_t calculateCompactMask(int compactLevel) {
-        if (compactLevel > 16) {
-            return 0xFFFFFFFF;
+    static int64_t saturatingAdd(int64_t a, int64_t b) {
+        return b > INT64_MAX - a ? INT64_MAX : a + b;
+    }
+
+    void stage(std::string_view key, int64_t count) {
+        if (stagingCapacity_ == 0) {
+            ++stagingEvictions_;
+            return;
+        }
+        if (belowThresholdWords_.size() >= stagingCapacity_) {
+            evictStaged(stagingCapacity_ / 2);
+        }
+        if (auto it = belowThresholdWords_.find(key); it != belowThresholdWords_.end()) {
+            it->second = count;
+        } else {
+            belowThresholdWords_.emplace(key, count);
         }
-        return (0xFFFFFFFF >> (3 + compactLevel)) << 2;
     }
 
-    static int getStringHash(std::string_view s) {
-        uint32_t hash = 2166136261u;
-        size_t len = s.size();
-        size_t lenMask = len > 3 ? 3 : len;
+    // Shrinks the staging area to `keep` words, dropping the lowest counts first.
+    void evictStaged(size_t keep) {
+        size_t drop = belowThresholdWords_.size() - std::min(keep, belowThresholdWords_.size());
+        if (drop == 0) {
+            return;
+        }
+        std::vector<int64_t> counts;
+        counts.reserve(belowThresholdWords_.size());
+        for (const auto& [word, count] : belowThresholdWords_) {
+            counts.push_back(count);
+        }
+        std::nth_element(counts.begin(), counts.begin() + static_cast<std::ptrdiff_t>(drop - 1),
+                         counts.end());
+        int64_t cutoff = counts[drop - 1];
+        // Everything below the cutoff goes, then as many words at the cutoff as needed.
+        size_t atCutoff = drop - static_cast<size_t>(std::count_if(
+                                     counts.begin(), counts.end(),
+                                     [cutoff](int64_t count) { return count < cutoff; }));
+        for (auto it = belowThresholdWords_.begin(); it != belowThresholdWords_.end();) {
+            if (it->second < cutoff || (it->second == cutoff && atCutoff > 0)) {
+                atCutoff -= it->second == cutoff ? 1 : 0;
+                it = belowThresholdWords_.erase(it);
+                ++stagingEvictions_;
+            } else {
+                ++it;
+            }
+        }
+    }
 
-        for (char c : s) {
-            hash ^= static_cast<uint32_t>(c);
-            hash *= 16777619u;
+    void removeFromStore(std::string_view key) {
+        std::string word;
+        std::vector<DeleteHash> hashes;
+        generateDeleteHashes(key, word, hashes);
+        store_->removeDeletes(key, hashes);
+        store_->removeTerm(key);
+        ++dictionaryVersion_;
+
+        auto& histogram = metadata_.lengthHistogram;
+        metadata_.termCount -= metadata_.termCount > 0 ? 1 : 0;
+        if (key.size() < histogram.size() && histogram[key.size()] > 0) {
+            --histogram[key.size()];
         }
+        store_->saveMetadata(metadata_);
+    }
 
-        return static_cast<int>((hash & 0xFFFFFFFFu) | lenMask);
+    // Adds to a bigram and tracks the smallest count. `smallestGrew` is set if the bigram held
+    // the smallest count, which then has to be looked up again.
+    bool addBigram(std::string_view first, std::string_view second, int64_t count,
+                   bool& smallestGrew) {
+        if (count <= 0) {
+            return false;
+        }
+        std::string key = bigramKey(first, second);
+        auto previous = store_->getFrequency(key);
+        count = saturatingAdd(previous.value_or(0), count);
+        store_->setFrequency(key, count);
+        int64_t& minimum = metadata_.minBigramCount;
+        if (previous && *previous == minimum) {
+            smallestGrew = true;
+        }
+        if (minimum == 0 || count < minimum) {
+            minimum = count;
+        }
+        return true;
     }
 
-    std::vector<std::string> editsPrefix(std::string_view key) const {
-        std::vector<std::string> result;
-        std::unordered_set<std::string> seen;
+    // A store that cannot scan its bigrams keeps the last known smallest count, a lower bound.
+    void refreshMinBigramCount() {
+        if (auto minimum = store_->minBigramFrequency()) {
+            metadata_.minBigramCount = *minimum;
+        }
+    }
 
-        if (static_cast<int>(key.size()) <= maxEditDistance_) {
-            result.push_back("");
-            seen.insert("");
+    // Adopts the length bounds and term statistics of a persisted dictionary. Deletes built
+    // with another prefix length, hash or encoding, or for a smaller edit distance, would
+    // silently miss suggestions, so those are rejected. Only an empty store takes this
+    // instance's parameters; unknown ones stay unknown (see recordBuildParameters()), since
+    // recording parameters the deletes were not built with would turn the right ones away.
+    void restoreMetadata() {
+        metadata_.maxEditDistance = maxEditDistance_;
+        metadata_.prefixLength = prefixLength_;
+        metadata_.hashOptions = hashOptions_;
+        metadata_.encoding = encoding_;
+        auto stored = store_->loadMetadata();
+        if (!stored) {
+            return;
         }
+        if (stored->prefixLength != 0 &&
+            (stored->prefixLength != prefixLength_ || stored->hashOptions != hashOptions_ ||
+             stored->encoding != encoding_ || stored->maxEditDistance < maxEditDistance_)) {
+            throw std::invalid_argument(
+                "SymSpell parameters (" +
+                describeParameters(maxEditDistance_, prefixLength_, hashOptions_, encoding_) +
+                ") do not match the dictionary's metadata (built with " +
+                describeParameters(stored->maxEditDistance, stored->prefixLength,
+                                   stored->hashOptions, stored->encoding) +
+                ")");
+        }
+        metadata_ = std::move(*stored);
+        maxDictionaryWordLength_ = metadata_.maxWordLength;
+    }
+
+    static std::string describeParameters(int maxEditDistance, int prefixLength,
+                                          const HashOptions& hashOptions, TextEncoding encoding) {
+        return "maxEditDistance " + std::to_string(maxEditDistance) + ", prefixLength " +
+               std::to_string(prefixLength) + ", hash bits " + std::to_string(hashOptions.bits) +
+               ", compactLevel " + std::to_string(hashOptions.compactLevel) + ", encoding " +
+               (encoding == TextEncoding::Utf8 ? "utf8" : "bytes");
+    }
 
-        std::string prefix = std::string(key);
-        if (prefix.size() > static_cast<size_t>(prefixLength_)) {
-            prefix = prefix.substr(0, prefixLength_);
+    // Terms added from now on only carry deletes up to this instance's edit distance.
+    void recordTerm(size_t length) {
+        if (length > static_cast<size_t>(maxDictionaryWordLength_)) {
+            maxDictionaryWordLength_ = static_cast<int>(length);
         }
+        metadata_.maxWordLength = maxDictionaryWordLength_;
+        if (metadata_.prefixLength != 0) {
+            metadata_.maxEditDistance = std::min(metadata_.maxEditDistance, maxEditDistance_);
+        }
+        ++metadata_.termCount;
+        auto& histogram = metadata_.lengthHistogram;
+        if (histogram.size() <= length) {
+            histogram.resize(length + 1);
+        }
+        ++histogram[length];
+    }
 
-        result.push_back(prefix);
-        seen.insert(prefix);
+    static std::vector<Suggestion> takeResults(LookupContext& context) {
+        auto begin = std::make_move_iterator(context.results_.begin());
+        auto count = static_cast<std::ptrdiff_t>(context.resultCount_);
+        return std::vector<Suggestion>(begin, begin + count);
+    }
 
-        edits(prefix, 0, result, seen);
+    int clampEditDistance(int maxEditDistance) const {
+        if (maxEditDistance < 0 || maxEditDistance > maxEditDistance_) {
+            return maxEditDistance_;
+        }
+        return maxEditDistance;
+    }
 
-        return result;
+    static std::string& cacheKey(LookupContext& context, std::string_view input,
+                                 Verbosity verbosity, size_t limit, int maxEditDistance) {
+        std::string& key = context.cacheKey_;
+        key.assign(1, static_cast<char>(verbosity));
+        key.push_back(static_cast<char>(maxEditDistance));
+        key.append(reinterpret_cast<const char*>(&limit), sizeof(limit));
+        key.append(input);
+        return key;
     }
 
-    void edits(std::string_view word, int editDistance, std::vector<std::string>& result,
-               std::unordered_set<std::string>& seen) const {
-        editDistance++;
+    // Fills the context from the result cache; false on a miss.
+    bool serveCached(LookupContext& context, std::string_view key) const {
+        auto hit = cache_->find(key, dictionaryVersion_);
+        if (!hit) {
+            return false;
+        }
+        detail::countMetric(context.lookupStats_.cacheHits);
+        context.reset();
+        for (size_t i = 0; i < hit->size(); ++i) {
+            context.pushResult(hit->term(i), hit->distance(i), hit->frequency(i));
+        }
+        return true;
+    }
 
-        if (editDistance > maxEditDistance_) {
-            return;
+    // Serves a lookup from the result cache when one is enabled. `limit` is the number of
+    // ranked results for Verbosity::Top and ignored otherwise.
+    std::span<const Suggestion> lookupCached(std::string_view input, LookupContext& context,
+                                             Verbosity verbosity, size_t limit,
+                                             int maxEditDistance) const {
+        detail::countMetric(context.lookupStats_.lookups);
+        maxEditDistance = clampEditDistance(maxEditDistance);
+        if (!cache_) {
+            return lookupUncached(input, context, verbosity, limit, maxEditDistance);
         }
 
-        for (size_t i = 0; i < word.size(); ++i) {
-            std::string deleteWord = std::string(word);
-            deleteWord.erase(i, 1);
+        std::string& key = cacheKey(context, input, verbosity, limit, maxEditDistance);
+        if (serveCached(context, key)) {
+            return context.results();
+        }
+        auto results = lookupUncached(input, context, verbosity, limit, maxEditDistance);
+        cache_->insert(key, dictionaryVersion_, results);
+        return results;
+    }
 
-            if (seen.insert(deleteWord).second) {
-                result.push_back(deleteWord);
-                edits(deleteWord, editDistance, result, seen);
+    // The lookup itself; `maxEditDistance` is already clamped to [0, maxEditDistance_].
+    // Verbosity::Top keeps the best `limit` suggestions ranked in the result array, and once
+    // it holds `limit` of them maxEditDistance2 tracks the distance of the last one.
+    std::span<const Suggestion> lookupUncached(std::string_view input, LookupContext& context,
+                                               Verbosity verbosity, size_t limit,
+                                               int maxEditDistance) const {
+        if (!beginLookup(input, context, verbosity, limit, maxEditDistance)) {
+            return context.results();
+        }
+        std::optional<int64_t> exactFreq;
+        if (probesExactMatch(input)) {
+            detail::PhaseTimer timer(context.lookupStats_.probeTime);
+            exactFreq = store_->getFrequency(input);
+        }
+        if (acceptExactMatch(context, exactFreq)) {
+            bool orderedBuckets = context.state_.ranked && store_->bucketsOrderedByFrequency();
+            while (beginLevel(context)) {
+                probeLevel(context, orderedBuckets);
+                endLevel(context);
             }
         }
+        return finishLookup(context);
     }
 
-    static bool deleteInSuggestionPrefix(std::string_view deleteWord, std::string_view suggestion) {
-        if (deleteWord.empty()) {
-            return true;
+    void probeLevel(LookupContext& context, bool orderedBuckets) const {
+        detail::PhaseTimer timer(context.lookupStats_.probeTime);
+        countLevelProbe(context);
+        if (orderedBuckets) {
+            store_->visitTermsByFrequency(
+                context.levelHashes_,
+                [&](DeleteHash hash, std::string_view suggestion, int64_t freq) {
+                    return probeRow(context, hash, suggestion, &freq);
+                });
+        } else {
+            store_->visitTermsMulti(
+                context.levelHashes_,
+                [&](DeleteHash hash, std::string_view suggestion, const int64_t* freq) {
+                    probeRow(context, hash, suggestion, freq);
+                    return true;
+                });
         }
+    }
 
-        size_t suggLen = std::min(suggestion.size(), static_cast<size_t>(7));
-        size_t delLen = deleteWord.size();
+    static void countLevelProbe(LookupContext& context) {
+        detail::countMetric(context.lookupStats_.probes);
+        detail::countMetric(context.lookupStats_.bucketsProbed, context.levelHashes_.size());
+    }
 
-        size_t j = 0;
-        for (size_t i = 0; i < delLen; ++i) {
-            char delChar = deleteWord[i];
-            while (j < suggLen && delChar != suggestion[j]) {
-                ++j;
+    // lookupUncached() over an IAsyncSymSpellStore: the same phases, with the probes awaited.
+    Task<std::span<const Suggestion>> lookupUncachedAsync(std::string_view input,
+                                                          LookupContext& context,
+                                                          Verbosity verbosity, size_t limit,
+                                                          int maxEditDistance) const {
+        if (beginLookup(input, context, verbosity, limit, maxEditDistance)) {
+            std::optional<int64_t> exactFreq;
+            if (probesExactMatch(input)) {
+                detail::PhaseTimer timer(context.lookupStats_.probeTime);
+                exactFreq = co_await asyncStore_->getFrequencyAsync(input);
             }
-            if (j == suggLen) {
+            if (acceptExactMatch(context, exactFreq)) {
+                while (beginLevel(context)) {
+                    {
+                        detail::PhaseTimer timer(context.lookupStats_.probeTime);
+                        countLevelProbe(context);
+                        co_await asyncStore_->visitTermsMultiAsync(
+                            context.levelHashes_, [&](DeleteHash hash, std::string_view suggestion,
+                                                      const int64_t* freq) {
+                                probeRow(context, hash, suggestion, freq);
+                                return true;
+                            });
+                    }
+                    endLevel(context);
+                }
+            }
+        }
+        co_return finishLookup(context);
+    }
+
+    // The phases of a lookup. Store probes happen only between them, and everything they
+    // share lives in context.state_, so lookupUncached() and lookupUncachedAsync() differ only
+    // in how they wait for the store.
+
+    // Returns false if the input is too long for any dictionary word.
+    bool beginLookup(std::string_view input, LookupContext& context, Verbosity verbosity,
+                     size_t limit, int maxEditDistance) const {
+        context.reset();
+        auto& state = context.state_;
+        state = LookupContext::LookupState{};
+        state.input = input;
+        state.verbosity = verbosity;
+        state.limit = limit;
+        state.ranked = verbosity == Verbosity::Top;
+        state.maxEditDistance = maxEditDistance;
+
+        // Skip this check if maxDictionaryWordLength_ is 0 (unknown: a store without metadata).
+        // It is in bytes, which bounds the characters of a UTF-8 word too.
+        state.inputLen = textLength(input);
+        return maxDictionaryWordLength_ == 0 ||
+               state.inputLen - maxEditDistance <= maxDictionaryWordLength_;
+    }
+
+    // Bigram entries share the store's frequency table but are not words.
+    static bool probesExactMatch(std::string_view input) { return !isBigramKey(input); }
+
+    // Records the exact match, if any, and seeds the candidate arena with the input prefix.
+    // Returns false if the lookup is already complete.
+    bool acceptExactMatch(LookupContext& context, std::optional<int64_t> exactFreq) const {
+        auto& state = context.state_;
+        if (exactFreq.has_value()) {
+            context.pushResult(state.input, 0, *exactFreq);
+            if (state.verbosity == Verbosity::Closest || (state.ranked && state.limit == 1)) {
                 return false;
             }
         }
 
+        if (state.maxEditDistance == 0) {
+            return false;
+        }
+
+        // Inputs up to 64 characters are verified with the bit-parallel kernel, whose match masks
+        // are built once here; longer ones fall back to the scalar DP.
+        if (utf8()) {
+            state.bitParallel = context.pattern_.assignUtf8(state.input);
+            if (!state.bitParallel) {
+                detail::decodeUtf8(state.input, context.inputCodePoints_);
+            }
+        } else {
+            state.bitParallel = context.pattern_.assign(state.input);
+        }
+        state.maxEditDistance2 = state.maxEditDistance;
+        state.inputPrefixLen = std::min(state.inputLen, prefixLength_);
+        std::string_view inputPrefix = state.input.substr(0, prefixBytes(state.input));
+        context.candidates_.append(inputPrefix, static_cast<uint64_t>(deleteHash(inputPrefix)));
         return true;
     }
 
-    static int damerauLevenshteinDistance(std::string_view s1, std::string_view s2,
-                                          int maxDistance) {
-        int len1 = static_cast<int>(s1.size());
-        int len2 = static_cast<int>(s2.size());
+    // Candidates are generated breadth first, so each level (all deletes of one length) is
+    // contiguous in the arena. Prepares the next level, whose buckets are then probed with one
+    // multi-bucket call so stores can answer them in a single round trip. Returns false once
+    // no level is left that can produce suggestions.
+    bool beginLevel(LookupContext& context) const {
+        detail::PhaseTimer timer(context.lookupStats_.generateTime);
+        auto& state = context.state_;
+        auto& candidates = context.candidates_;
+        if (state.levelBegin >= candidates.size()) {
+            return false;
+        }
+        state.levelEnd = candidates.size();
+        state.candidateLen = textLength(candidates.view(state.levelBegin));
+        state.lengthDiff = state.inputPrefixLen - state.candidateLen;
+        if (state.lengthDiff > state.maxEditDistance2) {
+            return false;
+        }
+        context.prepareLevel(state.levelBegin, state.levelEnd);
+        state.lastHash = 0;
+        state.lastCandidates = {};
+        return true;
+    }
 
-        if (std::abs(len1 - len2) > maxDistance) {
-            return maxDistance + 1;
+    // One bucket row of the current level; the candidate-independent checks run here.
+    VisitControl probeRow(LookupContext& context, DeleteHash hash, std::string_view suggestion,
+                          const int64_t* freq) const {
+        auto& state = context.state_;
+        detail::countMetric(context.lookupStats_.termsScanned);
+        int suggestionLen = static_cast<int>(suggestion.size());
+        if (utf8()) {
+            // Most rows fail the length check; those too long by their lead bytes alone never
+            // need their characters counted.
+            auto leads = static_cast<int>(detail::utf8LeadBytes(suggestion));
+            if (leads - state.inputLen > state.maxEditDistance2) {
+                return VisitControl::Continue;
+            }
+            suggestionLen = leads == suggestionLen ? leads : textLength(suggestion);
+        }
+        int lengthDelta = std::abs(suggestionLen - state.inputLen);
+        if (lengthDelta > state.maxEditDistance2 || suggestion == state.input) {
+            return VisitControl::Continue;
+        }
+        // A term first met at this level is at least lengthDiff edits away: one within fewer
+        // edits shares a delete with a shorter candidate and was considered at an earlier level.
+        if (state.ranked && freq && context.resultCount_ == state.limit) {
+            const Suggestion& last = context.result(state.limit - 1);
+            int levelBound = std::max(1, state.lengthDiff);
+            if (*freq <= last.frequency && std::max(levelBound, lengthDelta) >= last.distance) {
+                // Cannot displace the last result. The rest of a frequency-ordered bucket is no
+                // more frequent, so if the level bound alone rules this term out, it rules them
+                // all out.
+                return levelBound >= last.distance ? VisitControl::SkipBucket
+                                                   : VisitControl::Continue;
+            }
+        }
+        // Rows of one bucket usually arrive together; resolve the hash once per run.
+        if (hash != state.lastHash || state.lastCandidates.empty()) {
+            state.lastHash = hash;
+            state.lastCandidates = context.levelCandidates(hash);
+        }
+        for (const auto& candidate : state.lastCandidates) {
+            consider(context, candidate.term, suggestion, suggestionLen, freq);
+        }
+        return VisitControl::Continue;
+    }
+
+    // Checks of a bucket term against the candidate delete it was found under. Candidates of
+    // one level share their length.
+    void consider(LookupContext& context, std::string_view candidate, std::string_view suggestion,
+                  int suggestionLen, const int64_t* frequency) const {
+        auto& state = context.state_;
+        int candidateLen = state.candidateLen;
+        ++context.probeStats_.rows;
+
+        // A term is never shorter than its deletes, and one of equal length is the delete.
+        if (suggestionLen < candidateLen ||
+            (suggestionLen == candidateLen && suggestion != candidate)) {
+            ++context.probeStats_.collisions;
+            detail::countMetric(context.lookupStats_.prefixRejects);
+            return;
         }
 
-        std::vector<int> previous(len2 + 1);
-        std::vector<int> current(len2 + 1);
+        int suggPrefixLen = std::min(suggestionLen, prefixLength_);
+        if (suggPrefixLen > state.inputPrefixLen &&
+            (suggPrefixLen - candidateLen) > state.maxEditDistance2) {
+            detail::countMetric(context.lookupStats_.prefixRejects);
+            return;
+        }
 
-        for (int j = 0; j <= len2; ++j) {
-            previous[j] = j;
+        if (!deleteInPrefix(candidate, suggestion.substr(0, prefixBytes(suggestion)))) {
+            ++context.probeStats_.collisions;
+            detail::countMetric(context.lookupStats_.prefixRejects);
+            return;
         }
 
-        for (int i = 1; i <= len1; ++i) {
-            current[0] = i;
-            int minRow = i;
+        if (!context.considerSuggestion(suggestion, TermDictionaryView::hashTerm(suggestion))) {
+            return;
+        }
 
-            for (int j = 1; j <= len2; ++j) {
-                int cost = (s1[i - 1] == s2[j - 1]) ? 0 : 1;
-                current[j] =
-                    std::min({previous[j] + 1, current[j - 1] + 1, previous[j - 1] + cost});
+        // A term no more frequent than the last ranked result must be strictly closer.
+        int bound = state.maxEditDistance2;
+        if (state.ranked && frequency && context.resultCount_ == state.limit &&
+            *frequency <= context.result(state.limit - 1).frequency) {
+            bound = state.maxEditDistance2 - 1;
+        }
+        if (bound < 0) {
+            return;
+        }
 
-                if (i > 1 && j > 1 && s1[i - 1] == s2[j - 2] && s1[i - 2] == s2[j - 1]) {
-                    current[j] = std::min(current[j], previous[len2] + 1);
+        detail::countMetric(context.lookupStats_.distanceComputations);
+        int distance = verifyDistance(context, suggestion, bound);
+        if (distance < 0 || distance > bound) {
+            return;
+        }
+
+        int64_t suggestionFreq =
+            frequency ? *frequency : store_->getFrequency(suggestion).value_or(0);
+
+        if (state.ranked) {
+            if (context.insertRanked(state.limit, suggestion, distance, suggestionFreq) &&
+                context.resultCount_ == state.limit) {
+                state.maxEditDistance2 = context.result(state.limit - 1).distance;
+            }
+        } else if (state.verbosity == Verbosity::Closest) {
+            if (distance < state.maxEditDistance2) {
+                context.clearResults();
+                state.maxEditDistance2 = distance;
+                context.pushResult(suggestion, distance, suggestionFreq);
+            } else if (distance == state.maxEditDistance2) {
+                context.pushResult(suggestion, distance, suggestionFreq);
+            }
+        } else {
+            context.pushResult(suggestion, distance, suggestionFreq);
+        }
+    }
+
+    int verifyDistance(LookupContext& context, std::string_view suggestion, int bound) const {
+        const auto& state = context.state_;
+        if (!utf8()) {
+            return state.bitParallel ? context.pattern_.distance(suggestion, bound)
+                                     : detail::scalarDistance(state.input, suggestion, bound,
+                                                              context.distanceRows_);
+        }
+        if (state.bitParallel) {
+            return context.pattern_.distanceUtf8(suggestion, bound);
+        }
+        detail::decodeUtf8(suggestion, context.textCodePoints_);
+        return detail::scalarDistance(std::u32string_view(context.inputCodePoints_),
+                                      std::u32string_view(context.textCodePoints_), bound,
+                                      context.distanceRows_);
+    }
+
+    // Generates the next level from the deletes of the current one, if it can still matter.
+    void endLevel(LookupContext& context) const {
+        detail::PhaseTimer timer(context.lookupStats_.generateTime);
+        auto& state = context.state_;
+        auto& candidates = context.candidates_;
+        int candidateLen = state.candidateLen;
+        if (state.lengthDiff < maxEditDistance_ && candidateLen <= prefixLength_ &&
+            (state.verbosity == Verbosity::All || state.lengthDiff < state.maxEditDistance2)) {
+            for (size_t candidateIndex = state.levelBegin; candidateIndex < state.levelEnd;
+                 ++candidateIndex) {
+                // Appending deletes may reallocate the arena, so work from a copy.
+                context.scratch_.assign(candidates.view(candidateIndex));
+                const std::string& source = context.scratch_;
+
+                for (size_t i = 0, width = 1; i < source.size(); i += width) {
+                    width = utf8() ? detail::utf8SequenceLength(source, i) : 1;
+                    std::string& buffer = candidates.pending();
+                    size_t begin = buffer.size();
+                    buffer.append(source, 0, i);
+                    buffer.append(source, i + width);
+                    std::string_view deleteWord(buffer.data() + begin, buffer.size() - begin);
+
+                    auto hash = static_cast<uint64_t>(deleteHash(deleteWord));
+                    auto index = static_cast<uint32_t>(candidates.size());
+                    bool inserted = context.candidateSet_.insert(
+                        static_cast<uint32_t>(hash), index,
+                        [&](uint32_t other) { return candidates.view(other) == deleteWord; });
+                    if (inserted) {
+                        candidates.commit(hash);
+                    } else {
+                        candidates.rollback();
+                    }
                 }
+            }
+        }
+        state.levelBegin = state.levelEnd;
+    }
+
+    std::span<const Suggestion> finishLookup(LookupContext& context) const {
+        detail::PhaseTimer timer(context.lookupStats_.finishTime);
+        detail::countMetric(context.lookupStats_.candidates, context.candidates_.size());
+        // Ranked results are already in order.
+        if (context.state_.verbosity == Verbosity::Closest && context.resultCount_ > 0) {
+            auto begin = context.results_.begin();
+            auto end = begin + static_cast<std::ptrdiff_t>(context.resultCount_);
+            std::sort(begin, end, [](const Suggestion& a, const Suggestion& b) {
+                if (a.distance != b.distance) {
+                    return a.distance < b.distance;
+                }
+                return a.frequency > b.frequency;
+            });
+
+            int minDist = begin->distance;
+            end = std::remove_if(begin + 1, end,
+                                 [minDist](const Suggestion& s) { return s.distance != minDist; });
+            context.resultCount_ = static_cast<size_t>(end - begin);
+        }
+
+        return context.results();
+    }
+
+    // Generates the deletes of `terms` on several threads and hands them to the store in one
+    // addDeletes() call, ordered by hash. Each worker buckets its output by the top hash bits;
+    // each partition is then gathered into its slice of the final array and sorted there, so
+    // the concatenated partitions are globally ordered.
+    void writeDeletes(const std::vector<DictionaryEntry>& entries, const BuildOptions& options) {
+        if (entries.empty()) {
+            return;
+        }
+
+        size_t threads = options.threads != 0 ? options.threads
+                                              : std::max(1u, std::thread::hardware_concurrency());
+        threads = std::clamp<size_t>(threads, 1, std::max<size_t>(1, entries.size() / 64));
+
+        int partitionBits = 0;
+        while ((size_t{1} << partitionBits) < threads * 4 && partitionBits < 16) {
+            ++partitionBits;
+        }
+        size_t partitions = size_t{1} << partitionBits;
+        auto partitionOf = [this, partitionBits](DeleteHash hash) -> size_t {
+            return partitionBits == 0 ? 0 : hashOrderKey(hash) >> (64 - partitionBits);
+        };
+
+        // generated[t][p]: deletes produced by worker t that fall into partition p.
+        std::vector<std::vector<std::vector<DeletePosting>>> generated(
+            threads, std::vector<std::vector<DeletePosting>>(partitions));
+        runParallel(threads, [&](size_t t) {
+            size_t begin = entries.size() * t / threads;
+            size_t end = entries.size() * (t + 1) / threads;
+            std::string word;
+            std::vector<DeleteHash> hashes;
+            for (size_t i = begin; i < end; ++i) {
+                hashes.clear();
+                generateDeleteHashes(entries[i].term, word, hashes);
+                for (DeleteHash hash : hashes) {
+                    generated[t][partitionOf(hash)].push_back(
+                        DeletePosting{hash, static_cast<uint32_t>(i)});
+                }
+            }
+        });
 
-                minRow = std::min(minRow, current[j]);
+        std::vector<size_t> partitionBegin(partitions + 1, 0);
+        for (size_t p = 0; p < partitions; ++p) {
+            partitionBegin[p + 1] = partitionBegin[p];
+            for (const auto& perThread : generated) {
+                partitionBegin[p + 1] += perThread[p].size();
             }
+        }
 
-            if (minRow > maxDistance) {
-                return maxDistance + 1;
+        std::vector<DeletePosting> postings(partitionBegin.back());
+        std::atomic<size_t> nextPartition{0};
+        runParallel(threads, [&](size_t) {
+            for (size_t p = nextPartition.fetch_add(1); p < partitions;
+                 p = nextPartition.fetch_add(1)) {
+                auto out = postings.begin() + static_cast<std::ptrdiff_t>(partitionBegin[p]);
+                auto first = out;
+                for (auto& perThread : generated) {
+                    out = std::copy(perThread[p].begin(), perThread[p].end(), out);
+                    std::vector<DeletePosting>().swap(perThread[p]);
+                }
+                std::sort(first, out, [](const DeletePosting& a, const DeletePosting& b) {
+                    return a.hash != b.hash ? a.hash < b.hash : a.term < b.term;
+                });
             }
+        });
 
-            std::swap(previous, current);
+        std::vector<std::string_view> terms;
+        terms.reserve(entries.size());
+        for (const auto& entry : entries) {
+            terms.push_back(entry.term);
         }
+        store_->addDeletes(terms, postings);
+    }
 
-        int distance = previous[len2];
-        return (distance > maxDistance) ? maxDistance + 1 : distance;
+    // Hashes of every delete of the key's prefix: each set of at most maxEditDistance_
+    // positions is removed from the prefix exactly once (positions strictly increasing), and
+    // repeats caused by repeated letters collapse in the final sort. Distinct deletes with equal
+    // hashes share a bucket anyway. `word` is scratch space reused across calls.
+    void appendDeleteHashes(std::string_view key, std::string& word,
+                            std::vector<DeleteHash>& hashes) const {
+        word.assign(key.substr(0, static_cast<size_t>(prefixLength_)));
+        hashes.push_back(deleteHash(word));
+        appendShorterDeletes(word, 0, 1, hashes);
+        std::sort(hashes.begin(), hashes.end());
+        hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+    }
+
+    void appendShorterDeletes(std::string& word, size_t start, int editDistance,
+                              std::vector<DeleteHash>& hashes) const {
+        if (editDistance > maxEditDistance_) {
+            return;
+        }
+        for (size_t i = start; i < word.size(); ++i) {
+            char removed = word[i];
+            word.erase(i, 1);
+            hashes.push_back(deleteHash(word));
+            appendShorterDeletes(word, i, editDistance + 1, hashes);
+            word.insert(i, 1, removed);
+        }
+    }
+
+    // appendDeleteHashes() for an edit distance and prefix length fixed at compile time. Each
+    // level builds its deletes in a stack buffer of PrefixLen chars, moving from one delete to
+    // the next by restoring a single letter, and the recursion depth is a template parameter,
+    // so the levels unroll. Produces exactly the hashes of the generic version.
+    template <int MaxEdit, int PrefixLen>
+    void appendDeleteHashesFixed(std::string_view key, std::string& /*word*/,
+                                 std::vector<DeleteHash>& hashes) const {
+        char prefix[PrefixLen];
+        size_t length = std::min(key.size(), static_cast<size_t>(PrefixLen));
+        std::copy_n(key.data(), length, prefix);
+        hashes.push_back(deleteHash(std::string_view(prefix, length)));
+        appendShorterDeletesFixed<MaxEdit, PrefixLen, 1>(prefix, length, 0, hashes);
+        std::sort(hashes.begin(), hashes.end());
+        hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+    }
+
+    template <int MaxEdit, int PrefixLen, int Depth>
+    void appendShorterDeletesFixed(const char* word, size_t length, size_t start,
+                                   std::vector<DeleteHash>& hashes) const {
+        if (start >= length) {
+            return;
+        }
+        // shorter = word without word[i], starting at i = start.
+        char shorter[PrefixLen];
+        std::copy_n(word, start, shorter);
+        std::copy(word + start + 1, word + length, shorter + start);
+        for (size_t i = start; i < length; ++i) {
+            hashes.push_back(deleteHash(std::string_view(shorter, length - 1)));
+            if constexpr (Depth < MaxEdit) {
+                appendShorterDeletesFixed<MaxEdit, PrefixLen, Depth + 1>(shorter, length - 1, i,
+                                                                         hashes);
+            }
+            if (i + 1 < length) {
+                shorter[i] = word[i];
+            }
+        }
+    }
+
+    using DeleteGenerator = void (SymSpell::*)(std::string_view, std::string&,
+                                               std::vector<DeleteHash>&) const;
+
+    // Common configurations get a specialised delete generator; the rest use the generic one.
+    static DeleteGenerator selectDeleteGenerator(int maxEditDistance, int prefixLength) {
+        if (maxEditDistance == 1 && prefixLength == 7) {
+            return &SymSpell::appendDeleteHashesFixed<1, 7>;
+        }
+        if (maxEditDistance == 2 && prefixLength == 7) {
+            return &SymSpell::appendDeleteHashesFixed<2, 7>;
+        }
+        if (maxEditDistance == 3 && prefixLength == 8) {
+            return &SymSpell::appendDeleteHashesFixed<3, 8>;
+        }
+        return &SymSpell::appendDeleteHashes;
+    }
+
+    void generateDeleteHashes(std::string_view key, std::string& word,
+                              std::vector<DeleteHash>& hashes) const {
+        if (utf8() && !detail::isAscii(key.substr(0, prefixBytes(key)))) {
+            appendUtf8DeleteHashes(key, word, hashes);
+            return;
+        }
+        (this->*deleteGenerator_)(key, word, hashes);
+    }
+
+    // appendDeleteHashes() over the code points of a non-ASCII prefix: each delete removes
+    // whole UTF-8 sequences.
+    void appendUtf8DeleteHashes(std::string_view key, std::string& word,
+                                std::vector<DeleteHash>& hashes) const {
+        word.assign(key.substr(0, prefixBytes(key)));
+        hashes.push_back(deleteHash(word));
+        appendShorterUtf8Deletes(word, 0, 1, hashes);
+        std::sort(hashes.begin(), hashes.end());
+        hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+    }
+
+    void appendShorterUtf8Deletes(std::string& word, size_t start, int editDistance,
+                                  std::vector<DeleteHash>& hashes) const {
+        if (editDistance > maxEditDistance_) {
+            return;
+        }
+        for (size_t i = start; i < word.size();) {
+            size_t width = detail::utf8SequenceLength(word, i);
+            char removed[4];
+            word.copy(removed, width, i);
+            word.erase(i, width);
+            hashes.push_back(deleteHash(word));
+            appendShorterUtf8Deletes(word, i, editDistance + 1, hashes);
+            word.insert(i, removed, width);
+            i += width;
+        }
+    }
+
+    bool utf8() const { return encoding_ == TextEncoding::Utf8; }
+
+    // Length in characters of the encoding.
+    int textLength(std::string_view s) const {
+        return static_cast<int>(utf8() ? detail::utf8Length(s) : s.size());
+    }
+
+    // Bytes of the first prefixLength_ characters of `s`.
+    size_t prefixBytes(std::string_view s) const {
+        size_t prefix = std::min(s.size(), static_cast<size_t>(prefixLength_));
+        return utf8() && !detail::isAscii(s.substr(0, prefix)) ? detail::utf8PrefixBytes(s, prefix)
+                                                                : prefix;
+    }
+
+    // Runs fn(0..threads-1), using the calling thread for index 0. Rethrows the first failure.
+    template <typename Fn> static void runParallel(size_t threads, Fn&& fn) {
+        if (threads <= 1) {
+            fn(size_t{0});
+            return;
+        }
+        std::exception_ptr failure;
+        std::mutex failureMutex;
+        auto guarded = [&](size_t t) {
+            try {
+                fn(t);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(failureMutex);
+                if (!failure) {
+                    failure = std::current_exception();
+                }
+            }
+        };
+        std::vector<std::thread> pool;
+        pool.reserve(threads - 1);
+        for (size_t t = 1; t < threads; ++t) {
+            pool.emplace_back(guarded, t);
+        }
+        guarded(0);
+        for (auto& thread : pool) {
+            thread.join();
+        }
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+    }
+
+    // Bits of the hash kept by compaction; the two low bits then carry the length tag alone.
+    static uint64_t calculateCompactMask(const HashOptions& options) {
+        if (options.bits != 32 && options.bits != 64) {
+            throw std::invalid_argument("HashOptions::bits must be 32 or 64");
+        }
+        if (options.compactLevel < 0 || options.compactLevel > options.bits - 8) {
+            throw std::invalid_argument("HashOptions::compactLevel out of range");
+        }
+        uint64_t all = options.bits == 64 ? ~uint64_t{0} : uint64_t{0xFFFFFFFFu};
+        return options.compactLevel == 0 ? all : (all >> options.compactLevel) & ~uint64_t{3};
+    }
+
+    // FNV-1a of the delete, with min(length, 3) in the low two bits. The 32-bit variant
+    // reproduces the hashes of earlier versions, including their sign-extended bytes.
+    DeleteHash deleteHash(std::string_view s) const {
+        uint64_t lenMask = std::min<uint64_t>(s.size(), 3);
+        if (hashOptions_.bits == 32) {
+            uint32_t hash = 2166136261u;
+            for (char c : s) {
+                hash ^= static_cast<uint32_t>(c);
+                hash *= 16777619u;
+            }
+            return static_cast<int32_t>((hash & static_cast<uint32_t>(compactMask_)) | lenMask);
+        }
+        uint64_t hash = 14695981039346656037ull;
+        for (char c : s) {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 1099511628211ull;
+        }
+        return static_cast<DeleteHash>((hash & compactMask_) | lenMask);
+    }
+
+    // Maps hashes to 64-bit keys that sort like the hashes themselves and spread over the full
+    // range, whatever the width and compaction, so their top bits partition the postings.
+    uint64_t hashOrderKey(DeleteHash hash) const {
+        int keyBits = hashOptions_.bits - hashOptions_.compactLevel;
+        // Uncompacted hashes are signed; compacted ones lie in [0, 2^keyBits).
+        uint64_t bias = hashOptions_.compactLevel == 0 ? uint64_t{1} << (keyBits - 1) : 0;
+        return (static_cast<uint64_t>(hash) + bias) << (64 - keyBits);
+    }
+
+    // Whether the letters of `deleteWord` occur in order within the suggestion's prefix, which
+    // every term reached through one of its own deletes satisfies. With TextEncoding::Utf8 the
+    // bytes are compared anyway: a delete's code points in order imply its bytes in order, so
+    // the check only lets through more terms for the distance check to reject.
+    static bool deleteInPrefix(std::string_view deleteWord, std::string_view suggestionPrefix) {
+        size_t suggLen = suggestionPrefix.size();
+        size_t j = 0;
+        for (char delChar : deleteWord) {
+            while (j < suggLen && delChar != suggestionPrefix[j]) {
+                ++j;
+            }
+            if (j == suggLen) {
+                return false;
+            }
+        }
+        return true;
     }
 
     std::unique_ptr<ISymSpellStore> store_;
+    IAsyncSymSpellStore* asyncStore_; // store_ itself, if it implements the async reads.
     int maxEditDistance_;
     int prefixLength_;
-    uint32_t compactMask_;
+    HashOptions hashOptions_;
+    TextEncoding encoding_;
+    uint64_t compactMask_;
+    DeleteGenerator deleteGenerator_;
     int maxDictionaryWordLength_;
+    DictionaryMetadata metadata_;
     int64_t countThreshold_ = 1;
-    std::unordered_map<std::string, int64_t> belowThresholdWords_;
+    // Hashes string_view keys directly, so probing the staging area never builds a string.
+    struct StagedWordHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view word) const {
+            return std::hash<std::string_view>{}(word);
+        }
+    };
+
+    std::unordered_map<std::string, int64_t, StagedWordHash, std::equal_to<>> belowThresholdWords_;
+    size_t stagingCapacity_ = SIZE_MAX;
+    uint64_t stagingEvictions_ = 0;
+    std::unique_ptr<LookupCache> cache_;
+    // Bumped by every dictionary change; cached results from older versions are ignored.
+    uint64_t dictionaryVersion_ = 0;
 };
 
 } // namespace yams::symspell
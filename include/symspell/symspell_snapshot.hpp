@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <symspell/flat_index.hpp>
+#include <symspell/result.hpp>
+#include <symspell/symspell.hpp>
+#include <symspell/term_dictionary.hpp>
+
+namespace yams::symspell {
+
+// Versioned binary snapshot of a frozen MemoryStore. The file is a fixed header followed by
+// 8-byte aligned sections that mirror the in-memory layout exactly (term arena, term index,
+// frequency array, flat delete index), so a snapshot is usable straight from mmap without
+// parsing or allocation. Snapshots are written in native byte order; loading on a host with
+// a different byte order fails with ErrorCode::InvalidFormat. Version 2 widened delete hashes
+// to 64 bits and records the HashOptions the index was built with. Version 3 adds the term
+// length histogram and the text encoding, so SymSpell restores the dictionary's metadata from
+// a snapshot. Version 4 records the smallest bigram count. Files of earlier versions are
+// rejected and must be rewritten.
+struct SnapshotHeader {
+    static constexpr char kMagic[8] = {'S', 'Y', 'M', 'S', 'N', 'A', 'P', '\0'};
+    static constexpr uint32_t kVersion = 4;
+    static constexpr uint32_t kByteOrderMark = 0x01020304u;
+
+    // Bits of `flags`.
+    static constexpr uint32_t kFrequencyOrderedBuckets = 1u; // Written from BucketOrder::Frequency.
+    static constexpr uint32_t kUtf8Text = 2u;                // Built with TextEncoding::Utf8.
+
+    enum Section : uint32_t {
+        TermChars,
+        TermOffsets,
+        TermHashes,
+        TermSlots,
+        Frequencies,
+        BucketSlots,
+        BucketIds,
+        LengthHistogram, // uint64_t words per byte length; see writeSnapshot().
+        SectionCount
+    };
+
+    struct SectionRef {
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    int32_t maxEditDistance;
+    int32_t prefixLength;
+    int32_t maxWordLength;
+    uint32_t flags;
+    int32_t hashBits;
+    int32_t compactLevel;
+    uint64_t termCount; // Every interned term, bigram keys included; see LengthHistogram.
+    uint64_t bucketCount;
+    int64_t minBigramCount; // Smallest positive bigram frequency; 0 if there are no bigrams.
+    SectionRef sections[SectionCount];
+};
+
+// Writes `store` to `path`. The store must have been frozen with MemoryStore::freeze().
+// `hashOptions` and `encoding` are those of the SymSpell that built it, recorded for readers.
+// The length histogram and maxWordLength cover the terms with a positive frequency, without
+// bigram entries, like the metadata of the other stores.
+Result<void> writeSnapshot(const MemoryStore& store, const std::string& path,
+                           const HashOptions& hashOptions = {},
+                           TextEncoding encoding = TextEncoding::Bytes);
+
+// Writes the frozen MemoryStore of `spell` with its build parameters.
+Result<void> writeSnapshot(const SymSpell& spell, const std::string& path);
+
+// Read-only ISymSpellStore over a memory-mapped snapshot. All views point into the mapping,
+// which stays alive for the lifetime of the store. Write operations throw std::logic_error.
+class SnapshotStore : public ISymSpellStore {
+public:
+    ~SnapshotStore() override;
+
+    SnapshotStore(const SnapshotStore&) = delete;
+    SnapshotStore& operator=(const SnapshotStore&) = delete;
+    SnapshotStore(SnapshotStore&&) = delete;
+    SnapshotStore& operator=(SnapshotStore&&) = delete;
+
+    static Result<std::unique_ptr<SnapshotStore>> open(const std::string& path);
+
+    void addDelete(DeleteHash hash, std::string_view term) override;
+    std::vector<std::string> getTerms(DeleteHash hash) override;
+    void visitTerms(DeleteHash hash, TermVisitor visitor) override;
+    void visitTermsMulti(std::span<const DeleteHash> hashes, MultiTermVisitor visitor) override;
+    void visitTermsByFrequency(std::span<const DeleteHash> hashes,
+                               RankedTermVisitor visitor) override;
+    void setFrequency(std::string_view term, int64_t freq) override;
+    std::optional<int64_t> getFrequency(std::string_view term) override;
+    bool termExists(std::string_view term) override;
+    bool supportsConcurrentReads() const override { return true; }
+    std::optional<DictionaryMetadata> loadMetadata() override;
+    std::optional<int64_t> minBigramFrequency() override;
+    bool bucketsOrderedByFrequency() const override {
+        return (header_->flags & SnapshotHeader::kFrequencyOrderedBuckets) != 0;
+    }
+
+    const SnapshotHeader& header() const { return *header_; }
+    HashOptions hashOptions() const {
+        return HashOptions{header_->hashBits, header_->compactLevel};
+    }
+    size_t termCount() const { return terms_.size(); }
+
+    // Bytes of the mapping by role, laid out as in the frozen MemoryStore it was written from.
+    // None of it is on the heap.
+    MemoryUsage memoryUsage() const {
+        MemoryUsage usage;
+        usage.termBytes = terms_.chars().size_bytes() + terms_.offsets().size_bytes() +
+                          terms_.hashes().size_bytes() + frequencies_.size_bytes();
+        usage.deleteIndexBytes = deletes_.ids().size_bytes();
+        usage.hashTableBytes = terms_.slots().size_bytes() + deletes_.slots().size_bytes();
+        return usage;
+    }
+
+private:
+    SnapshotStore() = default;
+
+    Result<void> bind(const std::string& path);
+
+    const void* mapping_ = nullptr;
+    size_t mappingSize_ = 0;
+    std::unique_ptr<uint64_t[]> buffer_; // Used where mmap is unavailable.
+    const SnapshotHeader* header_ = nullptr;
+    TermDictionaryView terms_;
+    std::span<const int64_t> frequencies_;
+    FlatDeleteIndexView deletes_;
+    std::span<const uint64_t> lengthHistogram_;
+};
+
+} // namespace yams::symspell
@@ -1,9 +1,14 @@
 #pragma once
 
 #include <sqlite3.h>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
+#include <symspell/metrics.hpp>
 #include <symspell/symspell.hpp>
 #include <symspell/result.hpp>
 
@@ -13,9 +18,34 @@ using yams::symspell::Result;
 using yams::symspell::Error;
 using yams::symspell::ErrorCode;
 
+struct BulkImportOptions {
+    // PRAGMA values for the import window, restored by endBulkImport(). An empty string leaves
+    // the pragma unchanged. journal_mode cannot leave WAL while reader connections are open.
+    std::string journalMode;
+    std::string synchronous = "OFF";
+    // Deletes buffered before they are sorted by hash and written.
+    size_t deleteBufferRows = size_t{1} << 16;
+};
+
+// Layout of the deletes. Rows keeps one (delete_hash, term_id) row per delete in
+// symspell_deletes. Packed keeps one row per delete hash in symspell_postings, holding the
+// bucket's term ids as a BLOB of delta-encoded varints, so a bucket is a single rowid lookup
+// and the table is several times smaller.
+enum class SQLiteSchema { Rows, Packed };
+
+struct SQLiteStoreOptions {
+    // PRAGMA mmap_size in bytes for the main connection and every pooled reader. Negative
+    // leaves the connection default.
+    int64_t mmapSize = -1;
+    // PRAGMA cache_size: pages if positive, KiB if negative. 0 leaves the connection default.
+    int64_t cacheSize = 0;
+};
+
 class SQLiteStore : public ISymSpellStore {
 public:
-    SQLiteStore(sqlite3* db, int maxEditDistance = 2, int prefixLength = 7);
+    // The schema is detected from the database: Packed if symspell_postings exists.
+    SQLiteStore(sqlite3* db, int maxEditDistance = 2, int prefixLength = 7,
+                const SQLiteStoreOptions& options = {});
     ~SQLiteStore() override;
 
     SQLiteStore(const SQLiteStore&) = delete;
@@ -23,29 +53,142 @@ public:
     SQLiteStore(SQLiteStore&&) = delete;
     SQLiteStore& operator=(SQLiteStore&&) = delete;
 
-    static Result<void> initializeDatabase(sqlite3* db);
+    // Creates the tables of `schema` and the metadata table if missing. Packed migrates an
+    // existing Rows layout: the rows are packed into symspell_postings and symspell_deletes is
+    // dropped, in one transaction; run VACUUM afterwards to return the freed pages. Rows leaves
+    // a database that is already packed as it is.
+    static Result<void> initializeDatabase(sqlite3* db, SQLiteSchema schema = SQLiteSchema::Rows);
+    static SQLiteSchema detectSchema(sqlite3* db);
 
-    void addDelete(int hash, std::string_view term) override;
-    std::vector<std::string> getTerms(int hash) override;
+    void addDelete(DeleteHash hash, std::string_view term) override;
+    void addDeletes(std::span<const std::string_view> terms,
+                    std::span<const DeletePosting> postings) override;
+    std::vector<std::string> getTerms(DeleteHash hash) override;
+    void visitTerms(DeleteHash hash, TermVisitor visitor) override;
+    void visitTermsMulti(std::span<const DeleteHash> hashes, MultiTermVisitor visitor) override;
+    // Delete rows are removed by primary key; the ON DELETE CASCADE on term_id is not relied
+    // on, since it needs foreign_keys enabled and would scan the deletes table per term.
+    void removeDelete(DeleteHash hash, std::string_view term) override;
+    void removeDeletes(std::string_view term, std::span<const DeleteHash> hashes) override;
+    bool removeTerm(std::string_view term) override;
     void setFrequency(std::string_view term, int64_t freq) override;
     std::optional<int64_t> getFrequency(std::string_view term) override;
     bool termExists(std::string_view term) override;
+    bool supportsConcurrentReads() const override { return concurrentReads_; }
+
+    // Metadata is kept in symspell_metadata, one key/value row per field, created on the first
+    // save if initializeDatabase() did not. Databases written before it existed report the term
+    // count and length histogram of symspell_terms, with unknown build parameters.
+    //
+    // saveMetadata() writes at once only when the build parameters or the longest term
+    // change. Term counts are kept in memory until flushMetadata(), commitTransaction(),
+    // endBulkImport() or destruction, so single-term writes do not pay for them; after a crash
+    // in between, only the counts are stale. After rollbackTransaction() the counts are
+    // re-derived from symspell_terms whenever they are written.
+    std::optional<DictionaryMetadata> loadMetadata() override;
+    void saveMetadata(const DictionaryMetadata& metadata) override;
+    void flushMetadata() override;
+    std::optional<int64_t> minBigramFrequency() override;
+    SQLiteSchema schema() const { return packed_ ? SQLiteSchema::Packed : SQLiteSchema::Rows; }
+
+    // Switches the database to WAL and serves reads from a pool of read-only connections, one
+    // per concurrently reading thread, each with its own prepared statements. `maxReaders`
+    // caps the pool (0 = unbounded); callers beyond the cap wait for a free reader. Requires
+    // a file-backed database. Reads issued while the main connection has a transaction open
+    // still go through it, so writers see their own uncommitted changes.
+    //
+    // Without this mode reads share the main connection's statements and are serialized by a
+    // mutex: concurrent lookups are safe but do not run in parallel.
+    Result<void> enableConcurrentReads(size_t maxReaders = 0);
+
+    // Import window for building large dictionaries. Applies the pragmas in `options`, opens a
+    // transaction unless one is already open, and caches term ids in memory. addDelete() then
+    // buffers rows, which are sorted by hash and written with multi-row INSERTs whenever the
+    // buffer fills, before the next bucket read, and at endBulkImport(). endBulkImport() commits
+    // the transaction it opened and restores the previous pragmas.
+    Result<void> beginBulkImport(const BulkImportOptions& options = {});
+    Result<void> endBulkImport();
+    bool importing() const { return importing_; }
 
     void beginTransaction();
     void commitTransaction();
     void rollbackTransaction();
 
+    // Read counters and the time reads spent in sqlite3_step(); zero unless built with
+    // YAMS_SYMSPELL_METRICS (see metrics.hpp).
+    StoreMetrics metrics() const { return counters_.snapshot(); }
+    void resetMetrics() { counters_.reset(); }
+
 private:
+    struct Reader;
+    class ReaderLease;
+    struct PackedWriter;
+
+    struct DeleteRow {
+        DeleteHash hash;
+        int64_t termId;
+    };
+
+    struct TermIdHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view term) const {
+            return std::hash<std::string_view>{}(term);
+        }
+    };
+
     sqlite3* db_;
+    SQLiteStoreOptions options_;
+    bool packed_ = false;
     sqlite3_stmt* addDeleteStmt_ = nullptr;
-    sqlite3_stmt* getTermsStmt_ = nullptr;
+    sqlite3_stmt* addDeleteRowStmt_ = nullptr;
+    sqlite3_stmt* addDeleteRowsStmt_ = nullptr;
+    sqlite3_stmt* getTermIdStmt_ = nullptr;
+    sqlite3_stmt* removeDeleteStmt_ = nullptr;
+    sqlite3_stmt* removeTermStmt_ = nullptr;
     sqlite3_stmt* setFrequencyStmt_ = nullptr;
-    sqlite3_stmt* getFrequencyStmt_ = nullptr;
-    sqlite3_stmt* termExistsStmt_ = nullptr;
+    sqlite3_stmt* saveMetadataStmt_ = nullptr;
+    // Metadata as last written, and the newer counts not written yet.
+    std::optional<DictionaryMetadata> savedMetadata_;
+    DictionaryMetadata pendingMetadata_;
+    bool metadataPending_ = false;
+    // Set by rollbackTransaction(): written counts are taken from symspell_terms.
+    bool recountMetadata_ = false;
+    std::unique_ptr<PackedWriter> packedWriter_;
+    std::unique_ptr<Reader> primary_;
+    std::mutex primaryMutex_;
     bool inTransaction_ = false;
 
+    bool concurrentReads_ = false;
+    size_t maxReaders_ = 0;
+    std::vector<std::unique_ptr<Reader>> readers_;
+    std::vector<Reader*> idleReaders_;
+    std::mutex poolMutex_;
+    std::condition_variable poolAvailable_;
+
+    bool importing_ = false;
+    bool ownsImportTransaction_ = false;
+    BulkImportOptions importOptions_;
+    std::string savedJournalMode_;
+    std::string savedSynchronous_;
+    std::unordered_map<std::string, int64_t, TermIdHash, std::equal_to<>> termIds_;
+    std::vector<DeleteRow> pendingDeletes_;
+    detail::StoreCounters counters_;
+
+    static Result<void> migrateToPacked(sqlite3* db);
+    Result<void> applyPragmas(sqlite3* connection) const;
     Result<void> prepareStatements();
     void finalizeStatements();
+    Result<Reader*> openReader();
+    Reader* acquireReader();
+    void releaseReader(Reader* reader);
+
+    std::optional<int64_t> termId(std::string_view term);
+    Result<void> writeDeleteRows(std::span<const DeleteRow> rows);
+    Result<void> removePackedDeletes(int64_t termId, std::span<const DeleteHash> hashes);
+    void writeMetadata(const DictionaryMetadata& metadata);
+    bool countTerms(DictionaryMetadata& metadata);
+    Result<void> flushPendingDeletes();
+    void flushBeforeRead();
 };
 
 } // namespace yams::symspell
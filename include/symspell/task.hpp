@@ -0,0 +1,178 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <semaphore>
+#include <type_traits>
+#include <utility>
+
+namespace yams::symspell {
+
+template <typename T> class Task;
+
+namespace detail {
+
+// Resumes whoever awaited the finished task, or returns to the resumer if nobody did.
+struct TaskFinalAwaiter {
+    bool await_ready() const noexcept { return false; }
+    template <typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> done) noexcept {
+        if (auto continuation = done.promise().continuation) {
+            return continuation;
+        }
+        return std::noop_coroutine();
+    }
+    void await_resume() const noexcept {}
+};
+
+struct TaskPromiseBase {
+    std::coroutine_handle<> continuation;
+    std::exception_ptr error;
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    TaskFinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() noexcept { error = std::current_exception(); }
+
+    void rethrowIfFailed() const {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+template <typename T> struct TaskPromise : TaskPromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object() noexcept;
+    template <typename U> void return_value(U&& result) { value.emplace(std::forward<U>(result)); }
+
+    T take() {
+        rethrowIfFailed();
+        return std::move(*value);
+    }
+};
+
+template <> struct TaskPromise<void> : TaskPromiseBase {
+    Task<void> get_return_object() noexcept;
+    void return_void() const noexcept {}
+
+    void take() const { rethrowIfFailed(); }
+};
+
+} // namespace detail
+
+// Lazily started coroutine producing a T. Nothing runs until the task is awaited (or passed
+// to syncWait()); the awaiting coroutine is resumed by symmetric transfer when it finishes,
+// on whatever thread completed its last suspension. Exceptions propagate to the awaiter. A
+// task is move-only and can be awaited once.
+template <typename T = void> class [[nodiscard]] Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+
+    Task() = default;
+    explicit Task(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle) {}
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            destroy();
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() { destroy(); }
+
+    bool await_ready() const noexcept { return !handle_ || handle_.done(); }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle_.promise().continuation = awaiting;
+        return handle_;
+    }
+
+    T await_resume() { return handle_.promise().take(); }
+
+private:
+    void destroy() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+template <typename T> Task<T> detail::TaskPromise<T>::get_return_object() noexcept {
+    return Task<T>(std::coroutine_handle<TaskPromise>::from_promise(*this));
+}
+
+inline Task<void> detail::TaskPromise<void>::get_return_object() noexcept {
+    return Task<void>(std::coroutine_handle<TaskPromise>::from_promise(*this));
+}
+
+namespace detail {
+
+// Driver coroutine of syncWait(): signals the semaphore from its final suspend point.
+struct SyncWaitDriver {
+    struct promise_type {
+        std::binary_semaphore* done = nullptr;
+
+        SyncWaitDriver get_return_object() noexcept {
+            return SyncWaitDriver{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        auto final_suspend() const noexcept {
+            struct Signal {
+                bool await_ready() const noexcept { return false; }
+                void await_suspend(std::coroutine_handle<promise_type> self) const noexcept {
+                    self.promise().done->release();
+                }
+                void await_resume() const noexcept {}
+            };
+            return Signal{};
+        }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+template <typename T, typename Result>
+SyncWaitDriver runSyncWait(Task<T>& task, std::optional<Result>& result,
+                           std::exception_ptr& error) {
+    try {
+        if constexpr (std::is_void_v<T>) {
+            co_await std::move(task);
+            result.emplace(true);
+        } else {
+            result.emplace(co_await std::move(task));
+        }
+    } catch (...) {
+        error = std::current_exception();
+    }
+}
+
+} // namespace detail
+
+// Runs `task` to completion, blocking the calling thread while it is suspended on work that
+// completes elsewhere, and returns its result. For callers outside any event loop.
+template <typename T> T syncWait(Task<T> task) {
+    std::binary_semaphore done(0);
+    std::optional<std::conditional_t<std::is_void_v<T>, bool, T>> result;
+    std::exception_ptr error;
+    auto driver = detail::runSyncWait(task, result, error);
+    driver.handle.promise().done = &done;
+    driver.handle.resume();
+    done.acquire();
+    driver.handle.destroy();
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    if constexpr (!std::is_void_v<T>) {
+        return std::move(*result);
+    }
+}
+
+} // namespace yams::symspell
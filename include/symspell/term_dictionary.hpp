@@ -0,0 +1,164 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace yams::symspell {
+
+using TermId = uint32_t;
+
+// Read-only view over interned term storage. It does not own its memory, so the same lookup
+// code serves TermDictionary and memory-mapped snapshots.
+//
+// Layout: `chars` holds all terms back to back, term `id` spans
+// [offsets[id], offsets[id + 1]), `hashes[id]` caches hashTerm() of that term and `slots` is
+// an open-addressed, power-of-two sized index where each slot holds id + 1 (0 = empty).
+class TermDictionaryView {
+public:
+    TermDictionaryView() = default;
+    TermDictionaryView(std::span<const char> chars, std::span<const uint32_t> offsets,
+                       std::span<const uint32_t> hashes, std::span<const uint32_t> slots)
+        : chars_(chars), offsets_(offsets), hashes_(hashes), slots_(slots) {}
+
+    size_t size() const { return hashes_.size(); }
+    bool empty() const { return hashes_.empty(); }
+
+    std::string_view term(TermId id) const {
+        return std::string_view(chars_.data() + offsets_[id], offsets_[id + 1] - offsets_[id]);
+    }
+
+    std::optional<TermId> find(std::string_view term) const {
+        if (slots_.empty()) {
+            return std::nullopt;
+        }
+        uint32_t hash = hashTerm(term);
+        size_t mask = slots_.size() - 1;
+        for (size_t i = hash & mask;; i = (i + 1) & mask) {
+            uint32_t slot = slots_[i];
+            if (slot == 0) {
+                return std::nullopt;
+            }
+            TermId id = slot - 1;
+            if (hashes_[id] == hash && this->term(id) == term) {
+                return id;
+            }
+        }
+    }
+
+    std::span<const char> chars() const { return chars_; }
+    std::span<const uint32_t> offsets() const { return offsets_; }
+    std::span<const uint32_t> hashes() const { return hashes_; }
+    std::span<const uint32_t> slots() const { return slots_; }
+
+    static uint32_t hashTerm(std::string_view term) {
+        uint32_t hash = 2166136261u;
+        for (char c : term) {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+private:
+    std::span<const char> chars_;
+    std::span<const uint32_t> offsets_;
+    std::span<const uint32_t> hashes_;
+    std::span<const uint32_t> slots_;
+};
+
+// Interned term storage: every distinct term is copied once into a contiguous arena and
+// identified by a dense TermId. Lookups by string_view go through an open-addressed index of
+// ids, so they never allocate. Arena offsets are 32-bit, which caps the arena at 4 GiB of
+// term text.
+class TermDictionary {
+public:
+    TermDictionary() : offsets_{0} {}
+
+    size_t size() const { return hashes_.size(); }
+    bool empty() const { return hashes_.empty(); }
+
+    std::string_view term(TermId id) const { return view().term(id); }
+    std::optional<TermId> find(std::string_view term) const { return view().find(term); }
+
+    TermDictionaryView view() const {
+        return TermDictionaryView(chars_, offsets_, hashes_, slots_);
+    }
+
+    // Returns the id of `term`, appending it to the arena if it is not present yet.
+    TermId intern(std::string_view term) {
+        if (auto id = find(term)) {
+            return *id;
+        }
+
+        if (chars_.size() + term.size() > UINT32_MAX || hashes_.size() >= UINT32_MAX - 1) {
+            throw std::length_error("TermDictionary capacity exceeded");
+        }
+
+        auto id = static_cast<TermId>(hashes_.size());
+        chars_.insert(chars_.end(), term.begin(), term.end());
+        offsets_.push_back(static_cast<uint32_t>(chars_.size()));
+        hashes_.push_back(TermDictionaryView::hashTerm(term));
+
+        if ((hashes_.size() * 4) > (slots_.size() * 3)) {
+            rehash(slots_.empty() ? 16 : slots_.size() * 2);
+        } else {
+            insertSlot(id);
+        }
+        return id;
+    }
+
+    void reserve(size_t terms, size_t bytes) {
+        chars_.reserve(bytes);
+        offsets_.reserve(terms + 1);
+        hashes_.reserve(terms);
+    }
+
+    void shrinkToFit() {
+        chars_.shrink_to_fit();
+        offsets_.shrink_to_fit();
+        hashes_.shrink_to_fit();
+    }
+
+    // Heap bytes of the arena with its offsets and term hashes, and of the id index.
+    size_t storageBytes() const {
+        return chars_.capacity() + (offsets_.capacity() + hashes_.capacity()) * sizeof(uint32_t);
+    }
+    size_t indexBytes() const { return slots_.capacity() * sizeof(uint32_t); }
+
+    // Size of the id index once `terms` terms have been interned.
+    static size_t indexSlotsFor(size_t terms) {
+        size_t slots = 16;
+        while (terms * 4 > slots * 3) {
+            slots *= 2;
+        }
+        return slots;
+    }
+
+private:
+    void insertSlot(TermId id) {
+        size_t mask = slots_.size() - 1;
+        size_t i = hashes_[id] & mask;
+        while (slots_[i] != 0) {
+            i = (i + 1) & mask;
+        }
+        slots_[i] = id + 1;
+    }
+
+    void rehash(size_t capacity) {
+        slots_.assign(capacity, 0);
+        for (TermId id = 0; id < hashes_.size(); ++id) {
+            insertSlot(id);
+        }
+    }
+
+    std::vector<char> chars_;
+    std::vector<uint32_t> offsets_;
+    std::vector<uint32_t> hashes_;
+    std::vector<uint32_t> slots_;
+};
+
+} // namespace yams::symspell
@@ -0,0 +1,435 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <symspell/symspell.hpp>
+
+namespace yams::symspell {
+
+struct TieredStoreOptions {
+    // Memory budget for cached delete buckets (term bytes plus per-entry overhead).
+    size_t bucketBytes = size_t{64} << 20;
+    // Number of cached term frequencies.
+    size_t maxTerms = size_t{1} << 18;
+    // Independently locked shards per cache.
+    size_t shards = 16;
+};
+
+struct TieredStoreStats {
+    uint64_t bucketHits = 0;
+    uint64_t bucketMisses = 0;
+    uint64_t termHits = 0;
+    uint64_t termMisses = 0;
+    uint64_t rejected = 0; // Fetched entries the admission policy kept out of the cache.
+    size_t cachedBuckets = 0;
+    size_t cachedTerms = 0;
+};
+
+namespace detail {
+
+struct HotKeyHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view key) const { return std::hash<std::string_view>{}(key); }
+    size_t operator()(DeleteHash key) const {
+        // Delete hashes carry a length tag in their low bits; remix before use.
+        auto k = static_cast<uint64_t>(key);
+        uint64_t x = (k ^ (k >> 32)) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(x ^ (x >> 29));
+    }
+};
+
+// Sharded LRU cache with TinyLFU admission: every access is counted in a small count-min
+// sketch whose counters are halved periodically, and a new entry only displaces the LRU
+// victim if it has been requested more often recently. One-off probes therefore never push
+// out the hot set. Values are returned by copy, so they should be cheap to copy.
+template <typename Key, typename Value> class HotCache {
+public:
+    HotCache(size_t budget, size_t shards)
+        : shards_(std::clamp<size_t>(shards, 1, std::max<size_t>(budget, 1))) {
+        size_t perShard = std::max<size_t>(1, budget / shards_.size());
+        size_t counters = 64;
+        while (counters < perShard * 2 && counters < (size_t{1} << 22)) {
+            counters *= 2;
+        }
+        for (auto& shard : shards_) {
+            shard.budget = perShard;
+            shard.sketch.assign(counters, 0);
+            shard.sampleLimit = counters * 8;
+        }
+    }
+
+    template <typename K> std::optional<Value> find(const K& key) {
+        size_t hash = HotKeyHash{}(key);
+        Shard& shard = shardFor(hash);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.record(hash);
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) {
+            ++shard.misses;
+            return std::nullopt;
+        }
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        ++shard.hits;
+        return it->second->value;
+    }
+
+    // True if an entry for `key` would currently be admitted. Lets callers skip building a
+    // value that would be rejected anyway.
+    template <typename K> bool wouldAdmit(const K& key, size_t weight) const {
+        size_t hash = HotKeyHash{}(key);
+        const Shard& shard = shardFor(hash);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.admits(hash, weight);
+    }
+
+    template <typename K> void insert(const K& key, Value value, size_t weight) {
+        size_t hash = HotKeyHash{}(key);
+        Shard& shard = shardFor(hash);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (auto it = shard.index.find(key); it != shard.index.end()) {
+            shard.used -= it->second->weight;
+            shard.lru.erase(it->second);
+            shard.index.erase(it);
+        }
+        if (!shard.admits(hash, weight)) {
+            ++shard.rejected;
+            return;
+        }
+        while (!shard.lru.empty() && shard.used + weight > shard.budget) {
+            shard.used -= shard.lru.back().weight;
+            shard.index.erase(shard.lru.back().key);
+            shard.lru.pop_back();
+        }
+        shard.lru.push_front(Node{Key(key), std::move(value), weight, hash});
+        shard.index.emplace(shard.lru.front().key, shard.lru.begin());
+        shard.used += weight;
+    }
+
+    // Applies `update` to the cached value of `key`, if any.
+    template <typename K, typename Update> void update(const K& key, Update&& update) {
+        Shard& shard = shardFor(HotKeyHash{}(key));
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (auto it = shard.index.find(key); it != shard.index.end()) {
+            update(it->second->value);
+        }
+    }
+
+    template <typename K> void erase(const K& key) {
+        Shard& shard = shardFor(HotKeyHash{}(key));
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (auto it = shard.index.find(key); it != shard.index.end()) {
+            shard.used -= it->second->weight;
+            shard.lru.erase(it->second);
+            shard.index.erase(it);
+        }
+    }
+
+    void clear() {
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.index.clear();
+            shard.lru.clear();
+            shard.used = 0;
+        }
+    }
+
+    struct Counters {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t rejected = 0;
+        size_t size = 0;
+    };
+
+    Counters counters() const {
+        Counters total;
+        for (const auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total.hits += shard.hits;
+            total.misses += shard.misses;
+            total.rejected += shard.rejected;
+            total.size += shard.lru.size();
+        }
+        return total;
+    }
+
+private:
+    struct Node {
+        Key key;
+        Value value;
+        size_t weight;
+        size_t hash;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<Node> lru;
+        std::unordered_map<Key, typename std::list<Node>::iterator, HotKeyHash, std::equal_to<>>
+            index;
+        std::vector<uint8_t> sketch;
+        size_t samples = 0;
+        size_t sampleLimit = 0;
+        size_t budget = 0;
+        size_t used = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t rejected = 0;
+
+        size_t slot(size_t hash, int row) const {
+            uint64_t x = (hash + static_cast<uint64_t>(row) * 0x9E3779B97F4A7C15ull) *
+                         0xBF58476D1CE4E5B9ull;
+            return static_cast<size_t>(x >> 32) & (sketch.size() - 1);
+        }
+
+        void record(size_t hash) {
+            for (int row = 0; row < 4; ++row) {
+                uint8_t& counter = sketch[slot(hash, row)];
+                counter = static_cast<uint8_t>(std::min(counter + 1, 15));
+            }
+            if (++samples >= sampleLimit) {
+                for (auto& counter : sketch) {
+                    counter >>= 1;
+                }
+                samples = 0;
+            }
+        }
+
+        uint8_t estimate(size_t hash) const {
+            uint8_t result = 15;
+            for (int row = 0; row < 4; ++row) {
+                result = std::min(result, sketch[slot(hash, row)]);
+            }
+            return result;
+        }
+
+        bool admits(size_t hash, size_t weight) const {
+            if (weight > budget) {
+                return false;
+            }
+            if (used + weight <= budget || lru.empty()) {
+                return true;
+            }
+            return estimate(hash) > estimate(lru.back().hash);
+        }
+    };
+
+    Shard& shardFor(size_t hash) { return shards_[(hash >> 7) % shards_.size()]; }
+    const Shard& shardFor(size_t hash) const { return shards_[(hash >> 7) % shards_.size()]; }
+
+    std::vector<Shard> shards_;
+};
+
+} // namespace detail
+
+// Read-through / write-through cache over another store, typically a SQLiteStore whose full
+// delete index does not fit in memory. Delete buckets and term frequencies are fetched from
+// the backing store on demand and kept in bounded in-memory caches guarded by a TinyLFU
+// admission policy, so the frequently probed part of the index is served from RAM while
+// one-off probes go to the backing store without evicting it.
+//
+// Writes go to the backing store first and then update or drop the affected cache entries.
+// Reads are thread-safe whenever the backing store's are.
+class TieredStore : public ISymSpellStore {
+public:
+    explicit TieredStore(std::unique_ptr<ISymSpellStore> backing,
+                         const TieredStoreOptions& options = {})
+        : backing_(std::move(backing)), buckets_(options.bucketBytes, options.shards),
+          frequencies_(options.maxTerms, options.shards) {
+        if (!backing_) {
+            throw std::invalid_argument("TieredStore requires a backing store");
+        }
+    }
+
+    ISymSpellStore& backing() { return *backing_; }
+    const ISymSpellStore& backing() const { return *backing_; }
+
+    void addDelete(DeleteHash hash, std::string_view term) override {
+        backing_->addDelete(hash, term);
+        buckets_.erase(hash);
+    }
+
+    void addDeletes(std::span<const std::string_view> terms,
+                    std::span<const DeletePosting> postings) override {
+        backing_->addDeletes(terms, postings);
+        for (size_t i = 0; i < postings.size(); ++i) {
+            if (i == 0 || postings[i].hash != postings[i - 1].hash) {
+                buckets_.erase(postings[i].hash);
+            }
+        }
+    }
+
+    void removeDelete(DeleteHash hash, std::string_view term) override {
+        backing_->removeDelete(hash, term);
+        buckets_.erase(hash);
+    }
+
+    void removeDeletes(std::string_view term, std::span<const DeleteHash> hashes) override {
+        backing_->removeDeletes(term, hashes);
+        for (DeleteHash hash : hashes) {
+            buckets_.erase(hash);
+        }
+    }
+
+    bool removeTerm(std::string_view term) override {
+        frequencies_.erase(term);
+        return backing_->removeTerm(term);
+    }
+
+    std::vector<std::string> getTerms(DeleteHash hash) override {
+        return *bucket(hash);
+    }
+
+    void visitTerms(DeleteHash hash, TermVisitor visitor) override {
+        auto terms = bucket(hash);
+        for (const auto& term : *terms) {
+            if (!visitor(term)) {
+                return;
+            }
+        }
+    }
+
+    void visitTermsMulti(std::span<const DeleteHash> hashes, MultiTermVisitor visitor) override {
+        std::vector<DeleteHash> missing;
+        for (DeleteHash hash : hashes) {
+            auto terms = buckets_.find(hash);
+            if (!terms) {
+                missing.push_back(hash);
+                continue;
+            }
+            for (const auto& term : **terms) {
+                auto freq = frequencies_.find(std::string_view(term));
+                if (!visitor(hash, term, freq ? &*freq : nullptr)) {
+                    return;
+                }
+            }
+        }
+        if (missing.empty()) {
+            return;
+        }
+
+        // Fetch the misses in one backing probe, collecting rows only for buckets the admission
+        // policy would keep. A bucket is cached only if the probe ran to completion.
+        std::unordered_map<DeleteHash, std::vector<std::string>> fetched;
+        for (DeleteHash hash : missing) {
+            if (buckets_.wouldAdmit(hash, kBucketOverhead)) {
+                fetched.emplace(hash, std::vector<std::string>());
+            }
+        }
+        bool completed = true;
+        backing_->visitTermsMulti(missing, [&](DeleteHash hash, std::string_view term,
+                                               const int64_t* freq) {
+            if (auto it = fetched.find(hash); it != fetched.end()) {
+                it->second.emplace_back(term);
+            }
+            if (freq) {
+                frequencies_.insert(term, *freq, 1);
+            }
+            completed = visitor(hash, term, freq);
+            return completed;
+        });
+        if (completed) {
+            for (auto& [hash, terms] : fetched) {
+                cacheBucket(hash, std::move(terms));
+            }
+        }
+    }
+
+    void setFrequency(std::string_view term, int64_t freq) override {
+        backing_->setFrequency(term, freq);
+        frequencies_.update(term, [freq](int64_t& cached) { cached = freq; });
+    }
+
+    std::optional<int64_t> getFrequency(std::string_view term) override {
+        if (auto freq = frequencies_.find(term)) {
+            return *freq;
+        }
+        auto freq = backing_->getFrequency(term);
+        if (freq) {
+            frequencies_.insert(term, *freq, 1);
+        }
+        return freq;
+    }
+
+    bool termExists(std::string_view term) override {
+        if (frequencies_.find(term)) {
+            return true;
+        }
+        return backing_->termExists(term);
+    }
+
+    bool supportsConcurrentReads() const override { return backing_->supportsConcurrentReads(); }
+
+    // Cached buckets keep the backing order and cached frequencies follow setFrequency().
+    bool bucketsOrderedByFrequency() const override {
+        return backing_->bucketsOrderedByFrequency();
+    }
+
+    std::optional<DictionaryMetadata> loadMetadata() override { return backing_->loadMetadata(); }
+    void saveMetadata(const DictionaryMetadata& metadata) override {
+        backing_->saveMetadata(metadata);
+    }
+    void flushMetadata() override { backing_->flushMetadata(); }
+    std::optional<int64_t> minBigramFrequency() override {
+        return backing_->minBigramFrequency();
+    }
+
+    // Drops every cached entry, e.g. after the backing store was modified directly.
+    void clearCache() {
+        buckets_.clear();
+        frequencies_.clear();
+    }
+
+    TieredStoreStats stats() const {
+        auto buckets = buckets_.counters();
+        auto terms = frequencies_.counters();
+        TieredStoreStats result;
+        result.bucketHits = buckets.hits;
+        result.bucketMisses = buckets.misses;
+        result.termHits = terms.hits;
+        result.termMisses = terms.misses;
+        result.rejected = buckets.rejected + terms.rejected;
+        result.cachedBuckets = buckets.size;
+        result.cachedTerms = terms.size;
+        return result;
+    }
+
+private:
+    using Bucket = std::shared_ptr<const std::vector<std::string>>;
+
+    // Approximate heap overhead of one cached bucket beyond its term bytes.
+    static constexpr size_t kBucketOverhead = 96;
+
+    Bucket bucket(DeleteHash hash) {
+        if (auto cached = buckets_.find(hash)) {
+            return *cached;
+        }
+        auto terms = backing_->getTerms(hash);
+        return cacheBucket(hash, std::move(terms));
+    }
+
+    Bucket cacheBucket(DeleteHash hash, std::vector<std::string> terms) {
+        size_t weight = kBucketOverhead;
+        for (const auto& term : terms) {
+            weight += term.size() + sizeof(std::string);
+        }
+        auto value = std::make_shared<const std::vector<std::string>>(std::move(terms));
+        buckets_.insert(hash, value, weight);
+        return value;
+    }
+
+    std::unique_ptr<ISymSpellStore> backing_;
+    detail::HotCache<DeleteHash, Bucket> buckets_;
+    detail::HotCache<std::string, int64_t> frequencies_;
+};
+
+} // namespace yams::symspell
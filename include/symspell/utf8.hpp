@@ -0,0 +1,138 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace yams::symspell::detail {
+
+// Lenient UTF-8 helpers for TextEncoding::Utf8. A byte that does not start a well-formed
+// sequence (stray continuation bytes, truncated or out-of-range sequences) is a character of
+// its own, decoded to 0x110000 + byte so it never equals a real code point. Overlong forms
+// and surrogates are not rejected; they only need to decode the same way every time.
+
+inline constexpr uint64_t kHighBits = 0x8080808080808080ull;
+
+inline bool isAscii(std::string_view s) {
+    const char* p = s.data();
+    size_t n = s.size();
+    for (; n >= 8; p += 8, n -= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        if (word & kHighBits) {
+            return false;
+        }
+    }
+    for (; n > 0; ++p, --n) {
+        if (static_cast<unsigned char>(*p) >= 0x80) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Bytes of the character starting at s[i].
+inline size_t utf8SequenceLength(std::string_view s, size_t i) {
+    auto lead = static_cast<unsigned char>(s[i]);
+    if (lead < 0x80) {
+        return 1;
+    }
+    size_t length = lead >= 0xF5 ? 0 : lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC2 ? 2 : 0;
+    if (length == 0 || i + length > s.size()) {
+        return 1;
+    }
+    for (size_t k = 1; k < length; ++k) {
+        if ((static_cast<unsigned char>(s[i + k]) & 0xC0) != 0x80) {
+            return 1;
+        }
+    }
+    return length;
+}
+
+// Decodes the character at s[i] and advances i past it.
+inline char32_t decodeUtf8(std::string_view s, size_t& i) {
+    auto lead = static_cast<unsigned char>(s[i]);
+    size_t length = utf8SequenceLength(s, i);
+    if (length == 1) {
+        ++i;
+        return lead < 0x80 ? char32_t{lead} : char32_t{0x110000} + lead;
+    }
+    char32_t cp = lead & (0x7F >> length);
+    for (size_t k = 1; k < length; ++k) {
+        cp = (cp << 6) | (static_cast<unsigned char>(s[i + k]) & 0x3F);
+    }
+    i += length;
+    return cp;
+}
+
+// Number of characters of `s`. Runs of eight ASCII bytes are counted a word at a time.
+inline size_t utf8Length(std::string_view s) {
+    size_t count = 0;
+    for (size_t i = 0; i < s.size();) {
+        if (i + 8 <= s.size()) {
+            uint64_t word;
+            std::memcpy(&word, s.data() + i, 8);
+            if (!(word & kHighBits)) {
+                i += 8;
+                count += 8;
+                continue;
+            }
+        }
+        i += static_cast<unsigned char>(s[i]) < 0x80 ? 1 : utf8SequenceLength(s, i);
+        ++count;
+    }
+    return count;
+}
+
+// Bytes of `s` other than continuation bytes (10xxxxxx), counted a word at a time: the exact
+// length of well-formed UTF-8, and a lower bound of utf8Length() otherwise, since a stray
+// continuation byte is a character of its own.
+inline size_t utf8LeadBytes(std::string_view s) {
+    // One bit per continuation byte, summed by a multiply: no popcount instruction needed.
+    auto count = [](uint64_t word) {
+        uint64_t bits = (word & ~(word << 1) & kHighBits) >> 7;
+        return static_cast<size_t>((bits * 0x0101010101010101ull) >> 56);
+    };
+    size_t continuations = 0;
+    size_t i = 0;
+    for (; i + 8 <= s.size(); i += 8) {
+        uint64_t word;
+        std::memcpy(&word, s.data() + i, 8);
+        continuations += count(word);
+    }
+    size_t rest = s.size() - i;
+    if (rest > 0 && s.size() >= 8) {
+        // Reload the last eight bytes and shift out those already counted; zeros come in.
+        uint64_t word;
+        std::memcpy(&word, s.data() + s.size() - 8, 8);
+        auto shift = static_cast<unsigned>(8 - rest) * 8;
+        continuations += count(std::endian::native == std::endian::little ? word >> shift
+                                                                           : word << shift);
+    } else {
+        for (; i < s.size(); ++i) {
+            continuations += (static_cast<unsigned char>(s[i]) & 0xC0) == 0x80;
+        }
+    }
+    return s.size() - continuations;
+}
+
+// Bytes of the first `characters` characters of `s` (all of it if it is shorter).
+inline size_t utf8PrefixBytes(std::string_view s, size_t characters) {
+    size_t i = 0;
+    for (; characters > 0 && i < s.size(); --characters) {
+        i += utf8SequenceLength(s, i);
+    }
+    return i;
+}
+
+// Replaces `out` with the characters of `s`.
+inline void decodeUtf8(std::string_view s, std::u32string& out) {
+    out.clear();
+    for (size_t i = 0; i < s.size();) {
+        out.push_back(decodeUtf8(s, i));
+    }
+}
+
+} // namespace yams::symspell::detail
@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <fstream>
+#include <symspell/dictionary_loader.hpp>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace yams::symspell {
+
+namespace {
+
+// Read-only mapping of a whole file. Empty files and mapping failures leave it invalid, and
+// the caller falls back to streaming.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+#ifndef _WIN32
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat st{};
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+            size_ = static_cast<size_t>(st.st_size);
+            void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping != MAP_FAILED) {
+                data_ = static_cast<const char*>(mapping);
+                madvise(mapping, size_, MADV_SEQUENTIAL);
+            }
+        }
+        ::close(fd);
+#else
+        (void)path;
+#endif
+    }
+
+    ~MappedFile() {
+#ifndef _WIN32
+        if (data_) {
+            munmap(const_cast<char*>(data_), size_);
+        }
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool valid() const { return data_ != nullptr; }
+    std::string_view text() const { return std::string_view(data_, size_); }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Feeds `in` to `consume(buffer, final)` in chunks of about `chunkBytes`. `consume` returns
+// how many leading bytes it used; the rest is carried over to the front of the next chunk.
+template <typename Consume>
+void readChunks(std::istream& in, size_t chunkBytes, Consume&& consume) {
+    chunkBytes = std::max<size_t>(chunkBytes, 1);
+    std::string buffer;
+    size_t carried = 0;
+    for (;;) {
+        buffer.resize(carried + chunkBytes);
+        in.read(buffer.data() + carried, static_cast<std::streamsize>(chunkBytes));
+        size_t filled = carried + static_cast<size_t>(in.gcount());
+        bool final = !in;
+        std::string_view view(buffer.data(), filled);
+        size_t used = consume(view, final);
+        if (final) {
+            return;
+        }
+        carried = filled - used;
+        std::copy(buffer.begin() + static_cast<std::ptrdiff_t>(used),
+                  buffer.begin() + static_cast<std::ptrdiff_t>(filled), buffer.begin());
+    }
+}
+
+Error openError(const std::string& path) {
+    return Error(ErrorCode::IoError, "Failed to open " + path);
+}
+
+} // namespace
+
+LoadStats loadFrequencies(SymSpell& spell, std::istream& in, const LoadOptions& options) {
+    LoadStats stats;
+    std::vector<DictionaryEntry> entries;
+    readChunks(in, options.chunkBytes, [&](std::string_view chunk, bool final) {
+        size_t used = chunk.size();
+        if (!final) {
+            size_t newline = chunk.rfind('\n');
+            used = newline == std::string_view::npos ? 0 : newline + 1;
+        }
+        entries.clear();
+        detail::parseFrequencyText(chunk.substr(0, used), stats,
+                                   [&](std::string_view term, int64_t count) {
+                                       entries.push_back(DictionaryEntry{term, count});
+                                   });
+        stats.termsAdded += spell.createDictionary(std::span<const DictionaryEntry>(entries),
+                                                   options.build);
+        return used;
+    });
+    return stats;
+}
+
+LoadStats loadCorpus(SymSpell& spell, std::istream& in, const LoadOptions& options) {
+    CorpusTokenizer tokenizer(options.lowercase);
+    readChunks(in, options.chunkBytes, [&](std::string_view chunk, bool final) {
+        size_t used = CorpusTokenizer::completeTokens(chunk, final);
+        tokenizer.add(chunk.substr(0, used));
+        return used;
+    });
+    auto entries = tokenizer.entries();
+    LoadStats stats;
+    stats.bytes = tokenizer.bytes();
+    stats.tokens = tokenizer.tokens();
+    stats.entries = entries.size();
+    stats.termsAdded = spell.createDictionary(std::span<const DictionaryEntry>(entries),
+                                              options.build);
+    return stats;
+}
+
+Result<LoadStats> loadFrequencyFile(SymSpell& spell, const std::string& path,
+                                    const LoadOptions& options) {
+    MappedFile mapped(path);
+    if (mapped.valid()) {
+        return Result<LoadStats>(loadFrequencies(spell, mapped.text(), options));
+    }
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return Result<LoadStats>(openError(path));
+    }
+    return Result<LoadStats>(loadFrequencies(spell, in, options));
+}
+
+Result<LoadStats> loadCorpusFile(SymSpell& spell, const std::string& path,
+                                 const LoadOptions& options) {
+    MappedFile mapped(path);
+    if (mapped.valid()) {
+        return Result<LoadStats>(loadCorpus(spell, mapped.text(), options));
+    }
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return Result<LoadStats>(openError(path));
+    }
+    return Result<LoadStats>(loadCorpus(spell, in, options));
+}
+
+} // namespace yams::symspell
@@ -0,0 +1,350 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include <symspell/symspell_snapshot.hpp>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace yams::symspell {
+
+namespace {
+
+constexpr uint64_t kSectionAlignment = 8;
+
+uint64_t alignUp(uint64_t value) {
+    return (value + kSectionAlignment - 1) & ~(kSectionAlignment - 1);
+}
+
+template <typename T> std::span<const T> sectionSpan(const char* base, const SnapshotHeader& header,
+                                                     SnapshotHeader::Section section) {
+    const auto& ref = header.sections[section];
+    return std::span<const T>(reinterpret_cast<const T*>(base + ref.offset), ref.size / sizeof(T));
+}
+
+bool isPowerOfTwo(size_t n) {
+    return n != 0 && (n & (n - 1)) == 0;
+}
+
+Result<void> writeSnapshot(const MemoryStore& store, const std::string& path,
+                           int maxEditDistance, const HashOptions& hashOptions,
+                           TextEncoding encoding) {
+    if (!store.frozen()) {
+        return Result<void>(Error(ErrorCode::InternalError, "Snapshot requires a frozen store"));
+    }
+
+    auto terms = store.terms();
+    auto frequencies = store.frequencies();
+    auto deletes = store.deleteIndex();
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, SnapshotHeader::kMagic, sizeof(header.magic));
+    header.version = SnapshotHeader::kVersion;
+    header.byteOrder = SnapshotHeader::kByteOrderMark;
+    header.maxEditDistance = maxEditDistance;
+    header.prefixLength = store.prefixLength();
+    header.termCount = terms.size();
+    header.bucketCount = store.bucketCount();
+    header.flags = store.bucketsOrderedByFrequency() ? SnapshotHeader::kFrequencyOrderedBuckets : 0;
+    if (encoding == TextEncoding::Utf8) {
+        header.flags |= SnapshotHeader::kUtf8Text;
+    }
+    header.hashBits = hashOptions.bits;
+    header.compactLevel = hashOptions.compactLevel;
+
+    // Words only: bigram keys, tombstones and terms without a frequency are not counted.
+    std::vector<uint64_t> histogram;
+    for (TermId id = 0; id < terms.size(); ++id) {
+        std::string_view term = terms.term(id);
+        if (frequencies[id] <= 0) {
+            continue;
+        }
+        if (SymSpell::isBigramKey(term)) {
+            if (header.minBigramCount == 0 || frequencies[id] < header.minBigramCount) {
+                header.minBigramCount = frequencies[id];
+            }
+            continue;
+        }
+        if (histogram.size() <= term.size()) {
+            histogram.resize(term.size() + 1);
+        }
+        ++histogram[term.size()];
+    }
+    header.maxWordLength = histogram.empty() ? 0 : static_cast<int32_t>(histogram.size() - 1);
+
+    struct Payload {
+        const void* data;
+        uint64_t size;
+    };
+    const Payload payloads[SnapshotHeader::SectionCount] = {
+        {terms.chars().data(), terms.chars().size_bytes()},
+        {terms.offsets().data(), terms.offsets().size_bytes()},
+        {terms.hashes().data(), terms.hashes().size_bytes()},
+        {terms.slots().data(), terms.slots().size_bytes()},
+        {frequencies.data(), frequencies.size_bytes()},
+        {deletes.slots().data(), deletes.slots().size_bytes()},
+        {deletes.ids().data(), deletes.ids().size_bytes()},
+        {histogram.data(), histogram.size() * sizeof(uint64_t)},
+    };
+
+    uint64_t offset = alignUp(sizeof(SnapshotHeader));
+    for (uint32_t i = 0; i < SnapshotHeader::SectionCount; ++i) {
+        header.sections[i] = {offset, payloads[i].size};
+        offset = alignUp(offset + payloads[i].size);
+    }
+
+    // Write to a temporary file and rename, so readers never map a partially written snapshot.
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return Result<void>(Error(ErrorCode::IoError, "Failed to open " + tmpPath));
+        }
+
+        static constexpr char kPadding[kSectionAlignment] = {};
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        uint64_t written = sizeof(header);
+        for (uint32_t i = 0; i < SnapshotHeader::SectionCount; ++i) {
+            out.write(kPadding, static_cast<std::streamsize>(header.sections[i].offset - written));
+            if (payloads[i].size > 0) {
+                out.write(static_cast<const char*>(payloads[i].data),
+                          static_cast<std::streamsize>(payloads[i].size));
+            }
+            written = header.sections[i].offset + payloads[i].size;
+        }
+        out.write(kPadding, static_cast<std::streamsize>(offset - written));
+
+        if (!out.flush()) {
+            std::remove(tmpPath.c_str());
+            return Result<void>(Error(ErrorCode::IoError, "Failed to write " + tmpPath));
+        }
+    }
+
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        return Result<void>(Error(ErrorCode::IoError, "Failed to rename snapshot to " + path));
+    }
+
+    return Result<void>();
+}
+
+} // namespace
+
+Result<void> writeSnapshot(const MemoryStore& store, const std::string& path,
+                           const HashOptions& hashOptions, TextEncoding encoding) {
+    return writeSnapshot(store, path, store.maxEditDistance(), hashOptions, encoding);
+}
+
+Result<void> writeSnapshot(const SymSpell& spell, const std::string& path) {
+    const auto* store = dynamic_cast<const MemoryStore*>(&spell.store());
+    if (!store) {
+        return Result<void>(Error(ErrorCode::InternalError, "Snapshot requires a MemoryStore"));
+    }
+    // The metadata's edit distance is the smallest any term was built with.
+    return writeSnapshot(*store, path, spell.metadata().maxEditDistance, spell.hashOptions(),
+                         spell.encoding());
+}
+
+Result<std::unique_ptr<SnapshotStore>> SnapshotStore::open(const std::string& path) {
+    std::unique_ptr<SnapshotStore> store(new SnapshotStore());
+    auto result = store->bind(path);
+    if (!result) {
+        return Result<std::unique_ptr<SnapshotStore>>(result.error());
+    }
+    return Result<std::unique_ptr<SnapshotStore>>(std::move(store));
+}
+
+SnapshotStore::~SnapshotStore() {
+#ifndef _WIN32
+    if (mapping_) {
+        munmap(const_cast<void*>(mapping_), mappingSize_);
+    }
+#endif
+}
+
+Result<void> SnapshotStore::bind(const std::string& path) {
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return Result<void>(Error(ErrorCode::IoError, "Failed to open " + path));
+    }
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(SnapshotHeader))) {
+        ::close(fd);
+        return Result<void>(Error(ErrorCode::InvalidFormat, "Snapshot too small: " + path));
+    }
+
+    mappingSize_ = static_cast<size_t>(st.st_size);
+    void* mapping = mmap(nullptr, mappingSize_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        mappingSize_ = 0;
+        return Result<void>(Error(ErrorCode::IoError, "Failed to mmap " + path));
+    }
+    mapping_ = mapping;
+#else
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        return Result<void>(Error(ErrorCode::IoError, "Failed to open " + path));
+    }
+    mappingSize_ = static_cast<size_t>(in.tellg());
+    if (mappingSize_ < sizeof(SnapshotHeader)) {
+        return Result<void>(Error(ErrorCode::InvalidFormat, "Snapshot too small: " + path));
+    }
+    buffer_.reset(new uint64_t[(mappingSize_ + sizeof(uint64_t) - 1) / sizeof(uint64_t)]);
+    in.seekg(0);
+    if (!in.read(reinterpret_cast<char*>(buffer_.get()),
+                 static_cast<std::streamsize>(mappingSize_))) {
+        return Result<void>(Error(ErrorCode::IoError, "Failed to read " + path));
+    }
+    mapping_ = buffer_.get();
+#endif
+
+    const char* base = static_cast<const char*>(mapping_);
+    header_ = reinterpret_cast<const SnapshotHeader*>(base);
+
+    if (std::memcmp(header_->magic, SnapshotHeader::kMagic, sizeof(header_->magic)) != 0) {
+        return Result<void>(Error(ErrorCode::InvalidFormat, "Not a SymSpell snapshot: " + path));
+    }
+    if (header_->byteOrder != SnapshotHeader::kByteOrderMark) {
+        return Result<void>(Error(ErrorCode::InvalidFormat, "Snapshot byte order mismatch"));
+    }
+    if (header_->version != SnapshotHeader::kVersion) {
+        return Result<void>(Error(ErrorCode::InvalidFormat,
+                                  "Unsupported snapshot version " +
+                                      std::to_string(header_->version)));
+    }
+
+    for (const auto& section : header_->sections) {
+        if (section.offset % kSectionAlignment != 0 || section.offset > mappingSize_ ||
+            section.size > mappingSize_ - section.offset) {
+            return Result<void>(Error(ErrorCode::InvalidFormat, "Snapshot section out of bounds"));
+        }
+    }
+
+    terms_ = TermDictionaryView(sectionSpan<char>(base, *header_, SnapshotHeader::TermChars),
+                                sectionSpan<uint32_t>(base, *header_, SnapshotHeader::TermOffsets),
+                                sectionSpan<uint32_t>(base, *header_, SnapshotHeader::TermHashes),
+                                sectionSpan<uint32_t>(base, *header_, SnapshotHeader::TermSlots));
+    frequencies_ = sectionSpan<int64_t>(base, *header_, SnapshotHeader::Frequencies);
+    deletes_ = FlatDeleteIndexView(
+        sectionSpan<FlatBucketSlot>(base, *header_, SnapshotHeader::BucketSlots),
+        sectionSpan<TermId>(base, *header_, SnapshotHeader::BucketIds));
+    lengthHistogram_ = sectionSpan<uint64_t>(base, *header_, SnapshotHeader::LengthHistogram);
+
+    // Cheap consistency checks only; the sections are used in place.
+    bool consistent = terms_.size() == header_->termCount && frequencies_.size() == terms_.size() &&
+                      terms_.offsets().size() == terms_.size() + 1 &&
+                      terms_.offsets().back() <= terms_.chars().size() &&
+                      (terms_.slots().empty() || isPowerOfTwo(terms_.slots().size())) &&
+                      (deletes_.slots().empty() || isPowerOfTwo(deletes_.slots().size()));
+    if (!consistent) {
+        return Result<void>(Error(ErrorCode::InvalidFormat, "Snapshot sections are inconsistent"));
+    }
+
+    return Result<void>();
+}
+
+std::optional<int64_t> SnapshotStore::minBigramFrequency() {
+    if (header_->minBigramCount == 0) {
+        return std::nullopt;
+    }
+    return header_->minBigramCount;
+}
+
+std::optional<DictionaryMetadata> SnapshotStore::loadMetadata() {
+    DictionaryMetadata metadata;
+    metadata.maxEditDistance = header_->maxEditDistance;
+    metadata.prefixLength = header_->prefixLength;
+    metadata.hashOptions = hashOptions();
+    metadata.encoding = (header_->flags & SnapshotHeader::kUtf8Text) != 0 ? TextEncoding::Utf8
+                                                                          : TextEncoding::Bytes;
+    metadata.maxWordLength = header_->maxWordLength;
+    metadata.minBigramCount = header_->minBigramCount;
+    metadata.lengthHistogram.assign(lengthHistogram_.begin(), lengthHistogram_.end());
+    for (uint64_t count : lengthHistogram_) {
+        metadata.termCount += count;
+    }
+    return metadata;
+}
+
+void SnapshotStore::addDelete(DeleteHash hash, std::string_view term) {
+    (void)hash;
+    (void)term;
+    throw std::logic_error("SnapshotStore is read-only");
+}
+
+std::vector<std::string> SnapshotStore::getTerms(DeleteHash hash) {
+    std::vector<std::string> result;
+    auto ids = deletes_.find(hash);
+    result.reserve(ids.size());
+    for (TermId id : ids) {
+        result.emplace_back(terms_.term(id));
+    }
+    return result;
+}
+
+void SnapshotStore::visitTerms(DeleteHash hash, TermVisitor visitor) {
+    for (TermId id : deletes_.find(hash)) {
+        if (!visitor(terms_.term(id))) {
+            return;
+        }
+    }
+}
+
+void SnapshotStore::visitTermsMulti(std::span<const DeleteHash> hashes, MultiTermVisitor visitor) {
+    for (DeleteHash hash : hashes) {
+        for (TermId id : deletes_.find(hash)) {
+            const int64_t* freq = &frequencies_[id];
+            if (*freq == MemoryStore::kNoFrequency) {
+                freq = nullptr;
+            }
+            if (!visitor(hash, terms_.term(id), freq)) {
+                return;
+            }
+        }
+    }
+}
+
+void SnapshotStore::visitTermsByFrequency(std::span<const DeleteHash> hashes,
+                                          RankedTermVisitor visitor) {
+    for (DeleteHash hash : hashes) {
+        for (TermId id : deletes_.find(hash)) {
+            int64_t freq = frequencies_[id] != MemoryStore::kNoFrequency ? frequencies_[id] : 0;
+            auto control = visitor(hash, terms_.term(id), freq);
+            if (control == VisitControl::Stop) {
+                return;
+            }
+            if (control == VisitControl::SkipBucket) {
+                break;
+            }
+        }
+    }
+}
+
+void SnapshotStore::setFrequency(std::string_view term, int64_t freq) {
+    (void)term;
+    (void)freq;
+    throw std::logic_error("SnapshotStore is read-only");
+}
+
+std::optional<int64_t> SnapshotStore::getFrequency(std::string_view term) {
+    auto id = terms_.find(term);
+    if (id && frequencies_[*id] != MemoryStore::kNoFrequency) {
+        return frequencies_[*id];
+    }
+    return std::nullopt;
+}
+
+bool SnapshotStore::termExists(std::string_view term) {
+    return getFrequency(term).has_value();
+}
+
+} // namespace yams::symspell
@@ -1,5 +1,11 @@
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <chrono>
 #include <cstring>
 #include <iostream>
+#include <iterator>
+#include <tuple>
 #include <symspell/symspell_sqlite.hpp>
 
 namespace yams::symspell {
@@ -23,17 +29,38 @@ constexpr const char* kCreateDeletesTable = R"(
     ) WITHOUT ROWID
 )";
 
-constexpr const char* kCreateTermsIndex = R"(
-    CREATE INDEX IF NOT EXISTS idx_symspell_terms_term ON symspell_terms(term)
+// Packed layout: the delete hash is the rowid, so a bucket is one lookup in the table B-tree
+// and its term ids sit in the leaf page that holds the key.
+constexpr const char* kCreatePostingsTable = R"(
+    CREATE TABLE IF NOT EXISTS symspell_postings (
+        delete_hash INTEGER PRIMARY KEY,
+        term_ids BLOB NOT NULL
+    )
+)";
+
+constexpr const char* kCreateMetadataTable = R"(
+    CREATE TABLE IF NOT EXISTS symspell_metadata (
+        key TEXT PRIMARY KEY,
+        value
+    ) WITHOUT ROWID
 )";
 
-constexpr const char* kCreateDeletesHashIndex = R"(
-    CREATE INDEX IF NOT EXISTS idx_symspell_deletes_hash ON symspell_deletes(delete_hash)
+// Earlier versions also indexed symspell_terms(term), which duplicates the index behind its
+// UNIQUE constraint.
+constexpr const char* kDropTermsIndex = R"(
+    DROP INDEX IF EXISTS idx_symspell_terms_term
+)";
+
+// Earlier versions created an index on delete_hash. The primary key already starts with
+// delete_hash, so the index only slowed down inserts.
+constexpr const char* kDropDeletesHashIndex = R"(
+    DROP INDEX IF EXISTS idx_symspell_deletes_hash
 )";
 
 constexpr const char* kInsertOrUpdateTerm = R"(
     INSERT INTO symspell_terms (term, frequency) VALUES (?, ?)
-    ON CONFLICT(term) DO UPDATE SET frequency = frequency + excluded.frequency
+    ON CONFLICT(term) DO UPDATE SET frequency = excluded.frequency
+    RETURNING id
 )";
 
 constexpr const char* kAddDelete = R"(
@@ -41,12 +68,117 @@ constexpr const char* kAddDelete = R"(
     VALUES (?, (SELECT id FROM symspell_terms WHERE term = ?))
 )";
 
+constexpr const char* kAddDeleteRow = R"(
+    INSERT OR IGNORE INTO symspell_deletes (delete_hash, term_id) VALUES (?, ?)
+)";
+
+constexpr const char* kGetTermId = R"(
+    SELECT id FROM symspell_terms WHERE term = ?
+)";
+
+constexpr const char* kRemoveDelete = R"(
+    DELETE FROM symspell_deletes WHERE delete_hash = ? AND term_id = ?
+)";
+
+constexpr const char* kRemoveTerm = R"(
+    DELETE FROM symspell_terms WHERE term = ?
+)";
+
+// Rows per multi-row INSERT; two parameters each, well below SQLITE_MAX_VARIABLE_NUMBER.
+constexpr size_t kDeleteRowsPerInsert = 128;
+
+std::string multiRowAddDelete(size_t rows) {
+    std::string sql = "INSERT OR IGNORE INTO symspell_deletes (delete_hash, term_id) VALUES ";
+    for (size_t i = 0; i < rows; ++i) {
+        sql += i == 0 ? "(?, ?)" : ", (?, ?)";
+    }
+    return sql;
+}
+
 constexpr const char* kGetTerms = R"(
     SELECT t.term FROM symspell_terms t
     INNER JOIN symspell_deletes d ON t.id = d.term_id
     WHERE d.delete_hash = ?
 )";
 
+// Probes several delete hashes per query. The IN list has a fixed size so the statement can be
+// prepared once; short batches repeat their last hash, which IN ignores.
+constexpr size_t kHashesPerProbe = 64;
+
+std::string multiHashGetTerms(size_t hashes) {
+    std::string sql = "SELECT d.delete_hash, t.term, t.frequency FROM symspell_deletes d "
+                      "INNER JOIN symspell_terms t ON t.id = d.term_id "
+                      "WHERE d.delete_hash IN (";
+    for (size_t i = 0; i < hashes; ++i) {
+        sql += i == 0 ? "?" : ", ?";
+    }
+    return sql + ")";
+}
+
+constexpr const char* kReadPostings = R"(
+    SELECT term_ids FROM symspell_postings WHERE delete_hash = ?
+)";
+
+constexpr const char* kWritePostings = R"(
+    INSERT OR REPLACE INTO symspell_postings (delete_hash, term_ids) VALUES (?, ?)
+)";
+
+constexpr const char* kRemovePostings = R"(
+    DELETE FROM symspell_postings WHERE delete_hash = ?
+)";
+
+// Resolves the term ids of packed buckets like multiHashGetTerms, with one statement per
+// arity: a batch uses the shortest that holds it, so the many buckets of one or a few terms
+// do not pay for the padding of the longest.
+constexpr size_t kIdProbeArities[] = {1, 8, 256};
+constexpr size_t kIdsPerProbe = kIdProbeArities[std::size(kIdProbeArities) - 1];
+
+std::string multiIdGetTerms(size_t ids) {
+    std::string sql = "SELECT id, term, frequency FROM symspell_terms WHERE id IN (";
+    for (size_t i = 0; i < ids; ++i) {
+        sql += i == 0 ? "?" : ", ?";
+    }
+    return sql + ")";
+}
+
+std::string multiHashGetPostings(size_t hashes) {
+    std::string sql = "SELECT delete_hash, term_ids FROM symspell_postings WHERE delete_hash IN (";
+    for (size_t i = 0; i < hashes; ++i) {
+        sql += i == 0 ? "?" : ", ?";
+    }
+    return sql + ")";
+}
+
+std::string multiRowWritePostings(size_t rows) {
+    std::string sql = "INSERT OR REPLACE INTO symspell_postings (delete_hash, term_ids) VALUES ";
+    for (size_t i = 0; i < rows; ++i) {
+        sql += i == 0 ? "(?, ?)" : ", (?, ?)";
+    }
+    return sql;
+}
+
+constexpr const char* kSaveMetadata = R"(
+    INSERT OR REPLACE INTO symspell_metadata (key, value) VALUES
+        ('max_edit_distance', ?1), ('prefix_length', ?2), ('hash_bits', ?3),
+        ('compact_level', ?4), ('encoding', ?5), ('max_word_length', ?6), ('term_count', ?7),
+        ('length_histogram', ?8), ('min_bigram_count', ?9)
+)";
+
+constexpr const char* kLoadMetadata = R"(
+    SELECT key, value FROM symspell_metadata
+)";
+
+// Byte lengths of the terms without bigram keys, for databases written without metadata.
+constexpr const char* kTermLengths = R"(
+    SELECT length(CAST(term AS BLOB)), COUNT(*) FROM symspell_terms
+    WHERE instr(term, char(31)) = 0 GROUP BY 1
+)";
+
+// Smallest bigram count; scans symspell_terms, so it is only run when the smallest one grows.
+constexpr const char* kMinBigramFrequency = R"(
+    SELECT MIN(frequency) FROM symspell_terms WHERE instr(term, char(31)) > 0 AND frequency > 0
+)";
+
 constexpr const char* kGetFrequency = R"(
     SELECT frequency FROM symspell_terms WHERE term = ?
 )";
@@ -55,10 +187,513 @@ constexpr const char* kTermExists = R"(
     SELECT 1 FROM symspell_terms WHERE term = ? LIMIT 1
 )";
 
+// Readers held by the current thread, so reads issued from inside a visitTerms callback reuse
+// the outer reader instead of waiting on the pool (or re-locking the primary connection).
+struct ActiveReader {
+    const void* store;
+    void* reader;
+    int depth;
+};
+
+thread_local std::vector<ActiveReader> tActiveReaders;
+
+Result<void> prepare(sqlite3* db, const char* sql, sqlite3_stmt** stmt, const char* name) {
+    if (sqlite3_prepare_v2(db, sql, -1, stmt, nullptr) != SQLITE_OK) {
+        return Result<void>(Error(ErrorCode::DatabaseError, std::string("Failed to prepare ") +
+                                                                name + " statement: " +
+                                                                sqlite3_errmsg(db)));
+    }
+    return Result<void>();
+}
+
+Result<void> exec(sqlite3* db, const std::string& sql) {
+    char* errMsg = nullptr;
+    if (sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        std::string msg = "Failed to execute \"" + sql + "\": " + (errMsg ? errMsg : "");
+        sqlite3_free(errMsg);
+        return Result<void>(Error(ErrorCode::DatabaseError, std::move(msg)));
+    }
+    return Result<void>();
+}
+
+// Runs a pragma and returns the first column of its result (empty if it returns no row).
+// Values are spliced into the SQL, so only plain identifiers and (negative) numbers are
+// accepted.
+Result<std::string> pragma(sqlite3* db, const char* name, const std::string& value = {}) {
+    auto digits = value.begin() + (value.size() > 1 && value[0] == '-' ? 1 : 0);
+    bool plain = std::all_of(digits, value.end(),
+                             [](unsigned char c) { return std::isalnum(c) != 0; });
+    if (!plain) {
+        return Result<std::string>(
+            Error(ErrorCode::DatabaseError, "Invalid value for PRAGMA " + std::string(name)));
+    }
+
+    std::string sql = std::string("PRAGMA ") + name + (value.empty() ? "" : "=" + value);
+    sqlite3_stmt* stmt = nullptr;
+    if (auto r = prepare(db, sql.c_str(), &stmt, name); !r) {
+        return Result<std::string>(r.error());
+    }
+    std::string result;
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        result = text ? text : "";
+    }
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_ROW && rc != SQLITE_DONE) {
+        return Result<std::string>(Error(ErrorCode::DatabaseError,
+                                         "Failed to run " + sql + ": " + sqlite3_errmsg(db)));
+    }
+    return Result<std::string>(std::move(result));
+}
+
+// sqlite3_step(), adding its duration to `time` in metrics builds.
+int timedStep(sqlite3_stmt* stmt, std::chrono::nanoseconds& time) {
+    detail::PhaseTimer timer(time);
+    return sqlite3_step(stmt);
+}
+
+bool tableExists(sqlite3* db, const char* name) {
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, "SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = ?",
+                           -1, &stmt, nullptr) != SQLITE_OK) {
+        return false;
+    }
+    sqlite3_bind_text(stmt, 1, name, -1, SQLITE_STATIC);
+    bool exists = sqlite3_step(stmt) == SQLITE_ROW;
+    sqlite3_finalize(stmt);
+    return exists;
+}
+
+// Term ids of a packed bucket, ascending, each stored as the LEB128 varint of its difference
+// to the previous id.
+void encodePostings(std::span<const int64_t> ids, std::string& out) {
+    out.clear();
+    uint64_t previous = 0;
+    for (int64_t id : ids) {
+        uint64_t delta = static_cast<uint64_t>(id) - previous;
+        previous = static_cast<uint64_t>(id);
+        for (; delta >= 0x80; delta >>= 7) {
+            out.push_back(static_cast<char>(delta | 0x80));
+        }
+        out.push_back(static_cast<char>(delta));
+    }
+}
+
+// Calls `onId(id)` for the ids of a packed bucket until it returns false. A truncated trailing
+// varint is ignored.
+template <typename OnId>
+bool decodePostings(const void* blob, size_t size, OnId&& onId) {
+    const auto* p = static_cast<const unsigned char*>(blob);
+    const auto* end = p + size;
+    uint64_t id = 0;
+    while (p < end) {
+        uint64_t delta = 0;
+        unsigned shift = 0;
+        for (; p < end && (*p & 0x80) && shift < 63; ++p, shift += 7) {
+            delta |= static_cast<uint64_t>(*p & 0x7F) << shift;
+        }
+        if (p == end) {
+            break;
+        }
+        delta |= static_cast<uint64_t>(*p++) << shift;
+        id += delta;
+        if (!onId(static_cast<int64_t>(id))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+struct StatementGuard {
+    sqlite3_stmt* stmt = nullptr;
+    ~StatementGuard() { sqlite3_finalize(stmt); }
+};
+
 } // namespace
 
-Result<void> SQLiteStore::initializeDatabase(sqlite3* db) {
+// A connection plus its read statements. The primary reader wraps the store's own connection;
+// pooled readers own a read-only connection to the same database file. With the packed
+// layout getTerms and getTermsMulti return posting BLOBs, resolved through getTermsByIds.
+struct SQLiteStore::Reader {
+    sqlite3* db = nullptr;
+    bool ownsDb = false;
+    sqlite3_stmt* getTerms = nullptr;
+    sqlite3_stmt* getTermsMulti = nullptr;
+    sqlite3_stmt* getTermsByIds[std::size(kIdProbeArities)] = {};
+    sqlite3_stmt* getFrequency = nullptr;
+    sqlite3_stmt* termExists = nullptr;
+
+    Reader(sqlite3* connection, bool owns) : db(connection), ownsDb(owns) {}
+
+    ~Reader() {
+        for (sqlite3_stmt* stmt : {getTerms, getTermsMulti, getFrequency, termExists}) {
+            if (stmt) {
+                sqlite3_finalize(stmt);
+            }
+        }
+        for (sqlite3_stmt* stmt : getTermsByIds) {
+            if (stmt) {
+                sqlite3_finalize(stmt);
+            }
+        }
+        if (ownsDb) {
+            sqlite3_close(db);
+        }
+    }
+
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    Result<void> prepareStatements(bool packed) {
+        if (auto r = prepare(db, packed ? kReadPostings : kGetTerms, &getTerms, "getTerms"); !r) {
+            return r;
+        }
+        std::string multi = packed ? multiHashGetPostings(kHashesPerProbe)
+                                   : multiHashGetTerms(kHashesPerProbe);
+        if (auto r = prepare(db, multi.c_str(), &getTermsMulti, "getTermsMulti"); !r) {
+            return r;
+        }
+        if (packed) {
+            for (size_t i = 0; i < std::size(kIdProbeArities); ++i) {
+                std::string byIds = multiIdGetTerms(kIdProbeArities[i]);
+                if (auto r = prepare(db, byIds.c_str(), &getTermsByIds[i], "getTermsByIds"); !r) {
+                    return r;
+                }
+            }
+        }
+        if (auto r = prepare(db, kGetFrequency, &getFrequency, "getFrequency"); !r) {
+            return r;
+        }
+        return prepare(db, kTermExists, &termExists, "termExists");
+    }
+
+    // Calls `onTerm(id, term, frequency)` for the terms with the given rowids, in no particular
+    // order, until it returns false; ids without a term are skipped. One statement per
+    // kIdsPerProbe ids, of the shortest arity that holds them; short batches repeat their last
+    // id, which IN ignores.
+    template <typename OnTerm>
+    bool visitTermsByIds(std::span<const int64_t> ids, std::chrono::nanoseconds& stepTime,
+                         OnTerm&& onTerm) {
+        bool more = true;
+        for (size_t begin = 0; begin < ids.size() && more; begin += kIdsPerProbe) {
+            size_t count = std::min(kIdsPerProbe, ids.size() - begin);
+            size_t statement = 0;
+            while (kIdProbeArities[statement] < count) {
+                ++statement;
+            }
+            size_t arity = kIdProbeArities[statement];
+            sqlite3_stmt* stmt = getTermsByIds[statement];
+            for (size_t i = 0; i < arity; ++i) {
+                sqlite3_bind_int64(stmt, static_cast<int>(i) + 1,
+                                   ids[begin + std::min(i, count - 1)]);
+            }
+            while (more && timedStep(stmt, stepTime) == SQLITE_ROW) {
+                const char* term = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+                if (term) {
+                    auto len = static_cast<size_t>(sqlite3_column_bytes(stmt, 1));
+                    more = onTerm(sqlite3_column_int64(stmt, 0), std::string_view(term, len),
+                                  sqlite3_column_int64(stmt, 2));
+                }
+            }
+            sqlite3_reset(stmt);
+        }
+        return more;
+    }
+};
+
+// RAII access to a reader for one store operation: a pooled reader in concurrent mode, or the
+// primary connection under its mutex otherwise.
+class SQLiteStore::ReaderLease {
+public:
+    explicit ReaderLease(SQLiteStore& store) : store_(store) {
+        for (auto& active : tActiveReaders) {
+            if (active.store == &store) {
+                reader_ = static_cast<Reader*>(active.reader);
+                ++active.depth;
+                return;
+            }
+        }
+
+        if (store.concurrentReads_ && sqlite3_get_autocommit(store.db_) != 0) {
+            reader_ = store.acquireReader();
+        }
+        if (!reader_) {
+            lock_ = std::unique_lock<std::mutex>(store.primaryMutex_);
+            reader_ = store.primary_.get();
+        }
+        tActiveReaders.push_back(ActiveReader{&store, reader_, 1});
+    }
+
+    ~ReaderLease() {
+        auto it = std::find_if(tActiveReaders.begin(), tActiveReaders.end(),
+                               [this](const ActiveReader& a) { return a.store == &store_; });
+        if (--it->depth > 0) {
+            return;
+        }
+        tActiveReaders.erase(it);
+        if (reader_ != store_.primary_.get()) {
+            store_.releaseReader(reader_);
+        }
+    }
+
+    ReaderLease(const ReaderLease&) = delete;
+    ReaderLease& operator=(const ReaderLease&) = delete;
+
+    Reader& reader() const { return *reader_; }
+
+private:
+    SQLiteStore& store_;
+    Reader* reader_ = nullptr;
+    std::unique_lock<std::mutex> lock_;
+};
+
+// Write statements of the packed layout and buffers reused across calls. addRows() reads the
+// buckets it changes with one delete_hash IN (...) probe per kHashesPerProbe hashes and
+// rewrites them with multi-row INSERT OR REPLACE statements.
+struct SQLiteStore::PackedWriter {
+    sqlite3* db;
+    sqlite3_stmt* read = nullptr;
+    sqlite3_stmt* readMulti = nullptr;
+    sqlite3_stmt* write = nullptr;
+    sqlite3_stmt* writeMulti = nullptr;
+    sqlite3_stmt* remove = nullptr;
+    std::vector<int64_t> ids;
+    std::string blob;
+    std::vector<DeleteHash> hashes;
+    std::vector<std::vector<int64_t>> buckets;
+    std::vector<DeleteHash> changed;
+    std::vector<std::string> blobs;
+
+    explicit PackedWriter(sqlite3* connection) : db(connection) {}
+
+    ~PackedWriter() {
+        for (sqlite3_stmt* stmt : {read, readMulti, write, writeMulti, remove}) {
+            sqlite3_finalize(stmt);
+        }
+    }
+
+    PackedWriter(const PackedWriter&) = delete;
+    PackedWriter& operator=(const PackedWriter&) = delete;
+
+    Result<void> prepareStatements() {
+        std::string multiRead = multiHashGetPostings(kHashesPerProbe);
+        std::string multiWrite = multiRowWritePostings(kHashesPerProbe);
+        for (auto [sql, stmt, name] :
+             {std::tuple{kReadPostings, &read, "readPostings"},
+              std::tuple{multiRead.c_str(), &readMulti, "readPostingsMulti"},
+              std::tuple{kWritePostings, &write, "writePostings"},
+              std::tuple{multiWrite.c_str(), &writeMulti, "writePostingsMulti"},
+              std::tuple{kRemovePostings, &remove, "removePostings"}}) {
+            if (auto r = prepare(db, sql, stmt, name); !r) {
+                return r;
+            }
+        }
+        return Result<void>();
+    }
+
+    Result<void> fail(const char* what) const {
+        return Result<void>(
+            Error(ErrorCode::DatabaseError, std::string(what) + ": " + sqlite3_errmsg(db)));
+    }
+
+    // Replaces `ids` with the bucket of `hash`.
+    Result<void> load(DeleteHash hash) {
+        ids.clear();
+        sqlite3_bind_int64(read, 1, hash);
+        int rc = sqlite3_step(read);
+        if (rc == SQLITE_ROW) {
+            decodePostings(sqlite3_column_blob(read, 0),
+                           static_cast<size_t>(sqlite3_column_bytes(read, 0)), [&](int64_t id) {
+                               ids.push_back(id);
+                               return true;
+                           });
+        }
+        sqlite3_reset(read);
+        if (rc != SQLITE_ROW && rc != SQLITE_DONE) {
+            return fail("Failed to read postings");
+        }
+        return Result<void>();
+    }
+
+    // Writes `ids` as the bucket of `hash`, removing the row when it is empty.
+    Result<void> store(DeleteHash hash) {
+        int rc;
+        if (ids.empty()) {
+            sqlite3_bind_int64(remove, 1, hash);
+            rc = sqlite3_step(remove);
+            sqlite3_reset(remove);
+        } else {
+            encodePostings(ids, blob);
+            sqlite3_bind_int64(write, 1, hash);
+            sqlite3_bind_blob(write, 2, blob.data(), static_cast<int>(blob.size()),
+                              SQLITE_STATIC);
+            rc = sqlite3_step(write);
+            sqlite3_reset(write);
+        }
+        if (rc != SQLITE_DONE) {
+            return fail("Failed to write postings");
+        }
+        return Result<void>();
+    }
+
+    // Adds rows ordered by hash. A bucket is only rewritten if one of its ids is new.
+    Result<void> addRows(std::span<const DeleteRow> rows) {
+        for (size_t begin = 0; begin < rows.size();) {
+            hashes.clear();
+            size_t end = begin;
+            for (; end < rows.size(); ++end) {
+                if (hashes.empty() || rows[end].hash != hashes.back()) {
+                    if (hashes.size() == kHashesPerProbe) {
+                        break;
+                    }
+                    hashes.push_back(rows[end].hash);
+                }
+            }
+            if (auto r = loadBuckets(); !r) {
+                return r;
+            }
+
+            changed.clear();
+            for (size_t i = begin, bucket = 0; i < end; ++bucket) {
+                auto& merged = buckets[bucket];
+                size_t before = merged.size();
+                for (; i < end && rows[i].hash == hashes[bucket]; ++i) {
+                    merged.push_back(rows[i].termId);
+                }
+                std::sort(merged.begin(), merged.end());
+                merged.erase(std::unique(merged.begin(), merged.end()), merged.end());
+                if (merged.size() != before) {
+                    encodePostings(merged, blobs[changed.size()]);
+                    changed.push_back(hashes[bucket]);
+                }
+            }
+            if (auto r = storeChanged(); !r) {
+                return r;
+            }
+            begin = end;
+        }
+        return Result<void>();
+    }
+
+private:
+    // Fills buckets[i] with the stored ids of hashes[i]; hashes are ascending.
+    Result<void> loadBuckets() {
+        if (buckets.size() < hashes.size()) {
+            buckets.resize(kHashesPerProbe);
+            blobs.resize(kHashesPerProbe);
+        }
+        for (size_t i = 0; i < hashes.size(); ++i) {
+            buckets[i].clear();
+        }
+        sqlite3_stmt* stmt = hashes.size() == 1 ? read : readMulti;
+        int params = sqlite3_bind_parameter_count(stmt);
+        for (int i = 0; i < params; ++i) {
+            sqlite3_bind_int64(stmt, i + 1, hashes[std::min<size_t>(i, hashes.size() - 1)]);
+        }
+        int column = stmt == read ? 0 : 1;
+        int rc;
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            size_t bucket = 0;
+            if (stmt == readMulti) {
+                auto it = std::lower_bound(hashes.begin(), hashes.end(),
+                                           sqlite3_column_int64(stmt, 0));
+                bucket = static_cast<size_t>(it - hashes.begin());
+            }
+            decodePostings(sqlite3_column_blob(stmt, column),
+                           static_cast<size_t>(sqlite3_column_bytes(stmt, column)),
+                           [&](int64_t id) {
+                               buckets[bucket].push_back(id);
+                               return true;
+                           });
+        }
+        sqlite3_reset(stmt);
+        if (rc != SQLITE_DONE) {
+            return fail("Failed to read postings");
+        }
+        return Result<void>();
+    }
+
+    // Writes blobs[i] as the bucket of changed[i].
+    Result<void> storeChanged() {
+        sqlite3_stmt* stmt = changed.size() == kHashesPerProbe ? writeMulti : write;
+        for (size_t begin = 0; begin < changed.size();) {
+            size_t count = stmt == writeMulti ? kHashesPerProbe : 1;
+            for (size_t j = 0; j < count; ++j) {
+                int param = static_cast<int>(2 * j);
+                const std::string& encoded = blobs[begin + j];
+                sqlite3_bind_int64(stmt, param + 1, changed[begin + j]);
+                sqlite3_bind_blob(stmt, param + 2, encoded.data(),
+                                  static_cast<int>(encoded.size()), SQLITE_STATIC);
+            }
+            int rc = sqlite3_step(stmt);
+            sqlite3_reset(stmt);
+            if (rc != SQLITE_DONE) {
+                return fail("Failed to write postings");
+            }
+            begin += count;
+        }
+        return Result<void>();
+    }
+};
+
+// Packs the rows of symspell_deletes into symspell_postings and drops the old table. Runs in
+// a savepoint, so a failure leaves the database as it was.
+Result<void> SQLiteStore::migrateToPacked(sqlite3* db) {
+    if (auto r = exec(db, "SAVEPOINT symspell_migrate"); !r) {
+        return r;
+    }
+    auto migrate = [db]() -> Result<void> {
+        PackedWriter writer(db);
+        if (auto r = writer.prepareStatements(); !r) {
+            return r;
+        }
+        StatementGuard select;
+        if (auto r = prepare(db,
+                             "SELECT delete_hash, term_id FROM symspell_deletes "
+                             "ORDER BY delete_hash, term_id",
+                             &select.stmt, "selectDeletes");
+            !r) {
+            return r;
+        }
+
+        std::vector<DeleteRow> rows;
+        int rc;
+        while ((rc = sqlite3_step(select.stmt)) == SQLITE_ROW) {
+            rows.push_back(DeleteRow{sqlite3_column_int64(select.stmt, 0),
+                                     sqlite3_column_int64(select.stmt, 1)});
+            // A bucket split across batches is merged by the second one.
+            if (rows.size() == BulkImportOptions{}.deleteBufferRows) {
+                if (auto r = writer.addRows(rows); !r) {
+                    return r;
+                }
+                rows.clear();
+            }
+        }
+        if (rc != SQLITE_DONE) {
+            return writer.fail("Failed to read deletes");
+        }
+        if (auto r = writer.addRows(rows); !r) {
+            return r;
+        }
+        sqlite3_finalize(select.stmt);
+        select.stmt = nullptr;
+        return exec(db, "DROP TABLE symspell_deletes");
+    };
+
+    auto result = migrate();
+    if (!result) {
+        (void)exec(db, "ROLLBACK TO symspell_migrate");
+    }
+    if (auto r = exec(db, "RELEASE symspell_migrate"); !r && result) {
+        return r;
+    }
+    return result;
+}
+
+Result<void> SQLiteStore::initializeDatabase(sqlite3* db, SQLiteSchema schema) {
     char* errMsg = nullptr;
+    bool packed = schema == SQLiteSchema::Packed || detectSchema(db) == SQLiteSchema::Packed;
 
     if (sqlite3_exec(db, kCreateTermsTable, nullptr, nullptr, &errMsg) != SQLITE_OK) {
         std::string msg = "Failed to create terms table: ";
@@ -67,31 +702,51 @@ Result<void> SQLiteStore::initializeDatabase(sqlite3* db) {
         return Result<void>(Error(ErrorCode::DatabaseError, std::move(msg)));
     }
 
-    if (sqlite3_exec(db, kCreateDeletesTable, nullptr, nullptr, &errMsg) != SQLITE_OK) {
+    if (sqlite3_exec(db, packed ? kCreatePostingsTable : kCreateDeletesTable, nullptr, nullptr,
+                     &errMsg) != SQLITE_OK) {
         std::string msg = "Failed to create deletes table: ";
         msg += errMsg;
         sqlite3_free(errMsg);
         return Result<void>(Error(ErrorCode::DatabaseError, std::move(msg)));
     }
 
-    if (sqlite3_exec(db, kCreateTermsIndex, nullptr, nullptr, &errMsg) != SQLITE_OK) {
-        std::string msg = "Failed to create terms index: ";
+    if (sqlite3_exec(db, kCreateMetadataTable, nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        std::string msg = "Failed to create metadata table: ";
+        msg += errMsg;
+        sqlite3_free(errMsg);
+        return Result<void>(Error(ErrorCode::DatabaseError, std::move(msg)));
+    }
+
+    if (sqlite3_exec(db, kDropTermsIndex, nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        std::string msg = "Failed to drop terms index: ";
         msg += errMsg;
         sqlite3_free(errMsg);
     }
 
-    if (sqlite3_exec(db, kCreateDeletesHashIndex, nullptr, nullptr, &errMsg) != SQLITE_OK) {
-        std::string msg = "Failed to create deletes hash index: ";
+    if (sqlite3_exec(db, kDropDeletesHashIndex, nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        std::string msg = "Failed to drop deletes hash index: ";
         msg += errMsg;
         sqlite3_free(errMsg);
     }
 
+    if (packed && tableExists(db, "symspell_deletes")) {
+        return migrateToPacked(db);
+    }
     return Result<void>();
 }
 
-SQLiteStore::SQLiteStore(sqlite3* db, int maxEditDistance, int prefixLength) : db_(db) {
+SQLiteSchema SQLiteStore::detectSchema(sqlite3* db) {
+    return tableExists(db, "symspell_postings") ? SQLiteSchema::Packed : SQLiteSchema::Rows;
+}
+
+SQLiteStore::SQLiteStore(sqlite3* db, int maxEditDistance, int prefixLength,
+                         const SQLiteStoreOptions& options)
+    : db_(db), options_(options), packed_(detectSchema(db) == SQLiteSchema::Packed) {
     (void)maxEditDistance;
     (void)prefixLength;
+    if (auto r = applyPragmas(db_); !r) {
+        throw std::runtime_error(r.error().message);
+    }
     auto result = prepareStatements();
     if (!result) {
         throw std::runtime_error("Failed to prepare SQLite statements");
@@ -99,42 +754,70 @@ SQLiteStore::SQLiteStore(sqlite3* db, int maxEditDistance, int prefixLength) : d
 }
 
 SQLiteStore::~SQLiteStore() {
+    if (importing_) {
+        if (auto r = endBulkImport(); !r) {
+            std::cerr << r.error().message << std::endl;
+        }
+    }
+    flushMetadata();
     finalizeStatements();
 }
 
+Result<void> SQLiteStore::applyPragmas(sqlite3* connection) const {
+    if (options_.mmapSize >= 0) {
+        if (auto r = pragma(connection, "mmap_size", std::to_string(options_.mmapSize)); !r) {
+            return Result<void>(r.error());
+        }
+    }
+    if (options_.cacheSize != 0) {
+        if (auto r = pragma(connection, "cache_size", std::to_string(options_.cacheSize)); !r) {
+            return Result<void>(r.error());
+        }
+    }
+    return Result<void>();
+}
+
 Result<void> SQLiteStore::prepareStatements() {
-    if (sqlite3_prepare_v2(db_, kInsertOrUpdateTerm, -1, &setFrequencyStmt_, nullptr) !=
-        SQLITE_OK) {
-        return Result<void>(
-            Error(ErrorCode::DatabaseError,
-                  std::string("Failed to prepare setFrequency statement: ") + sqlite3_errmsg(db_)));
+    if (auto r = prepare(db_, kInsertOrUpdateTerm, &setFrequencyStmt_, "setFrequency"); !r) {
+        return r;
     }
 
-    if (sqlite3_prepare_v2(db_, kAddDelete, -1, &addDeleteStmt_, nullptr) != SQLITE_OK) {
-        return Result<void>(
-            Error(ErrorCode::DatabaseError,
-                  std::string("Failed to prepare addDelete statement: ") + sqlite3_errmsg(db_)));
+    if (auto r = prepare(db_, kGetTermId, &getTermIdStmt_, "getTermId"); !r) {
+        return r;
     }
 
-    if (sqlite3_prepare_v2(db_, kGetTerms, -1, &getTermsStmt_, nullptr) != SQLITE_OK) {
-        return Result<void>(
-            Error(ErrorCode::DatabaseError,
-                  std::string("Failed to prepare getTerms statement: ") + sqlite3_errmsg(db_)));
+    if (auto r = prepare(db_, kRemoveTerm, &removeTermStmt_, "removeTerm"); !r) {
+        return r;
     }
 
-    if (sqlite3_prepare_v2(db_, kGetFrequency, -1, &getFrequencyStmt_, nullptr) != SQLITE_OK) {
-        return Result<void>(
-            Error(ErrorCode::DatabaseError,
-                  std::string("Failed to prepare getFrequency statement: ") + sqlite3_errmsg(db_)));
+    if (packed_) {
+        packedWriter_ = std::make_unique<PackedWriter>(db_);
+        if (auto r = packedWriter_->prepareStatements(); !r) {
+            return r;
+        }
+        primary_ = std::make_unique<Reader>(db_, false);
+        return primary_->prepareStatements(true);
     }
 
-    if (sqlite3_prepare_v2(db_, kTermExists, -1, &termExistsStmt_, nullptr) != SQLITE_OK) {
-        return Result<void>(
-            Error(ErrorCode::DatabaseError,
-                  std::string("Failed to prepare termExists statement: ") + sqlite3_errmsg(db_)));
+    if (auto r = prepare(db_, kAddDelete, &addDeleteStmt_, "addDelete"); !r) {
+        return r;
     }
 
-    return Result<void>();
+    if (auto r = prepare(db_, kAddDeleteRow, &addDeleteRowStmt_, "addDeleteRow"); !r) {
+        return r;
+    }
+
+    std::string addDeleteRows = multiRowAddDelete(kDeleteRowsPerInsert);
+    if (auto r = prepare(db_, addDeleteRows.c_str(), &addDeleteRowsStmt_, "addDeleteRows"); !r) {
+        return r;
+    }
+
+    if (auto r = prepare(db_, kRemoveDelete, &removeDeleteStmt_, "removeDelete"); !r) {
+        return r;
+    }
+
+    primary_ = std::make_unique<Reader>(db_, false);
+    return primary_->prepareStatements(false);
 }
 
 void SQLiteStore::finalizeStatements() {
@@ -142,30 +825,133 @@ void SQLiteStore::finalizeStatements() {
         sqlite3_finalize(setFrequencyStmt_);
         setFrequencyStmt_ = nullptr;
     }
-    if (addDeleteStmt_) {
-        sqlite3_finalize(addDeleteStmt_);
-        addDeleteStmt_ = nullptr;
+    for (sqlite3_stmt** stmt :
+         {&saveMetadataStmt_, &addDeleteStmt_, &addDeleteRowStmt_, &addDeleteRowsStmt_,
+          &getTermIdStmt_, &removeDeleteStmt_, &removeTermStmt_}) {
+        if (*stmt) {
+            sqlite3_finalize(*stmt);
+            *stmt = nullptr;
+        }
     }
-    if (getTermsStmt_) {
-        sqlite3_finalize(getTermsStmt_);
-        getTermsStmt_ = nullptr;
+    packedWriter_.reset();
+    primary_.reset();
+    idleReaders_.clear();
+    readers_.clear();
+}
+
+Result<void> SQLiteStore::enableConcurrentReads(size_t maxReaders) {
+    const char* filename = sqlite3_db_filename(db_, "main");
+    if (!filename || filename[0] == '\0') {
+        return Result<void>(
+            Error(ErrorCode::DatabaseError, "Concurrent reads require a file-backed database"));
     }
-    if (getFrequencyStmt_) {
-        sqlite3_finalize(getFrequencyStmt_);
-        getFrequencyStmt_ = nullptr;
+
+    sqlite3_stmt* stmt = nullptr;
+    if (auto r = prepare(db_, "PRAGMA journal_mode=WAL", &stmt, "journal_mode"); !r) {
+        return r;
+    }
+    bool wal = false;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char* mode = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        wal = mode && std::strcmp(mode, "wal") == 0;
     }
-    if (termExistsStmt_) {
-        sqlite3_finalize(termExistsStmt_);
-        termExistsStmt_ = nullptr;
+    sqlite3_finalize(stmt);
+    if (!wal) {
+        return Result<void>(Error(ErrorCode::DatabaseError, "Failed to enable WAL journal mode"));
     }
+
+    std::lock_guard<std::mutex> lock(poolMutex_);
+    maxReaders_ = maxReaders;
+    if (readers_.empty()) {
+        auto reader = openReader();
+        if (!reader) {
+            return Result<void>(reader.error());
+        }
+        idleReaders_.push_back(reader.value());
+    }
+    concurrentReads_ = true;
+    return Result<void>();
 }
 
-void SQLiteStore::addDelete(int hash, std::string_view term) {
+Result<SQLiteStore::Reader*> SQLiteStore::openReader() {
+    sqlite3* connection = nullptr;
+    const char* filename = sqlite3_db_filename(db_, "main");
+    int rc = sqlite3_open_v2(filename, &connection, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX,
+                             nullptr);
+    if (rc != SQLITE_OK) {
+        std::string msg = std::string("Failed to open reader connection: ") +
+                          (connection ? sqlite3_errmsg(connection) : sqlite3_errstr(rc));
+        sqlite3_close(connection);
+        return Result<Reader*>(Error(ErrorCode::DatabaseError, std::move(msg)));
+    }
+    sqlite3_busy_timeout(connection, 5000);
+    if (auto r = applyPragmas(connection); !r) {
+        sqlite3_close(connection);
+        return Result<Reader*>(r.error());
+    }
+
+    auto reader = std::make_unique<Reader>(connection, true);
+    if (auto r = reader->prepareStatements(packed_); !r) {
+        return Result<Reader*>(r.error());
+    }
+    readers_.push_back(std::move(reader));
+    return Result<Reader*>(readers_.back().get());
+}
+
+SQLiteStore::Reader* SQLiteStore::acquireReader() {
+    std::unique_lock<std::mutex> lock(poolMutex_);
+    while (idleReaders_.empty()) {
+        if (maxReaders_ == 0 || readers_.size() < maxReaders_) {
+            auto reader = openReader();
+            if (!reader) {
+                std::cerr << reader.error().message << std::endl;
+                return nullptr;
+            }
+            return reader.value();
+        }
+        poolAvailable_.wait(lock);
+    }
+    Reader* reader = idleReaders_.back();
+    idleReaders_.pop_back();
+    return reader;
+}
+
+void SQLiteStore::releaseReader(Reader* reader) {
+    {
+        std::lock_guard<std::mutex> lock(poolMutex_);
+        idleReaders_.push_back(reader);
+    }
+    poolAvailable_.notify_one();
+}
+
+void SQLiteStore::addDelete(DeleteHash hash, std::string_view term) {
+    if (importing_) {
+        if (auto id = termId(term)) {
+            pendingDeletes_.push_back(DeleteRow{hash, *id});
+            if (pendingDeletes_.size() >= importOptions_.deleteBufferRows) {
+                if (auto r = flushPendingDeletes(); !r) {
+                    std::cerr << r.error().message << std::endl;
+                }
+            }
+        }
+        return;
+    }
+
+    if (packed_) {
+        if (auto id = termId(term)) {
+            DeleteRow row{hash, *id};
+            if (auto r = packedWriter_->addRows(std::span<const DeleteRow>(&row, 1)); !r) {
+                std::cerr << r.error().message << std::endl;
+            }
+        }
+        return;
+    }
+
     if (!addDeleteStmt_) {
         return;
     }
 
-    sqlite3_bind_int(addDeleteStmt_, 1, hash);
+    sqlite3_bind_int64(addDeleteStmt_, 1, hash);
     sqlite3_bind_text(addDeleteStmt_, 2, term.data(), static_cast<int>(term.size()), SQLITE_STATIC);
 
     sqlite3_step(addDeleteStmt_);
@@ -173,27 +959,432 @@ void SQLiteStore::addDelete(int hash, std::string_view term) {
     sqlite3_clear_bindings(addDeleteStmt_);
 }
 
-std::vector<std::string> SQLiteStore::getTerms(int hash) {
-    std::vector<std::string> result;
+void SQLiteStore::addDeletes(std::span<const std::string_view> terms,
+                             std::span<const DeletePosting> postings) {
+    std::vector<std::optional<int64_t>> ids;
+    ids.reserve(terms.size());
+    for (auto term : terms) {
+        ids.push_back(termId(term));
+    }
+
+    std::vector<DeleteRow> rows;
+    rows.reserve(postings.size());
+    for (const auto& posting : postings) {
+        if (const auto& id = ids[posting.term]) {
+            rows.push_back(DeleteRow{posting.hash, *id});
+        }
+    }
+    // Postings are ordered by hash, which is the order of the primary key.
+    auto byKey = [](const DeleteRow& a, const DeleteRow& b) {
+        return a.hash != b.hash ? a.hash < b.hash : a.termId < b.termId;
+    };
+    if (!std::is_sorted(rows.begin(), rows.end(), byKey)) {
+        std::sort(rows.begin(), rows.end(), byKey);
+    }
+
+    // Outside an import window, a savepoint keeps the batch in one transaction whether or not
+    // the caller has one open.
+    bool savepoint = !importing_;
+    if (savepoint) {
+        if (auto r = exec(db_, "SAVEPOINT symspell_add_deletes"); !r) {
+            std::cerr << r.error().message << std::endl;
+            return;
+        }
+    }
+    auto result = writeDeleteRows(rows);
+    if (!result) {
+        std::cerr << result.error().message << std::endl;
+    }
+    if (savepoint) {
+        if (!result) {
+            (void)exec(db_, "ROLLBACK TO symspell_add_deletes");
+        }
+        if (auto r = exec(db_, "RELEASE symspell_add_deletes"); !r) {
+            std::cerr << r.error().message << std::endl;
+        }
+    }
+}
+
+void SQLiteStore::removeDelete(DeleteHash hash, std::string_view term) {
+    removeDeletes(term, std::span<const DeleteHash>(&hash, 1));
+}
+
+void SQLiteStore::removeDeletes(std::string_view term, std::span<const DeleteHash> hashes) {
+    if (!(packed_ ? packedWriter_ != nullptr : removeDeleteStmt_ != nullptr) || hashes.empty()) {
+        return;
+    }
+    // Buffered rows of this term must reach the table before they can be deleted.
+    flushBeforeRead();
+    auto id = termId(term);
+    if (!id) {
+        return;
+    }
+
+    bool savepoint = !importing_;
+    if (savepoint) {
+        if (auto r = exec(db_, "SAVEPOINT symspell_remove_deletes"); !r) {
+            std::cerr << r.error().message << std::endl;
+            return;
+        }
+    }
+    bool failed = false;
+    if (packed_) {
+        if (auto r = removePackedDeletes(*id, hashes); !r) {
+            std::cerr << r.error().message << std::endl;
+            failed = true;
+        }
+    } else {
+        for (DeleteHash hash : hashes) {
+            sqlite3_bind_int64(removeDeleteStmt_, 1, hash);
+            sqlite3_bind_int64(removeDeleteStmt_, 2, *id);
+            int rc = sqlite3_step(removeDeleteStmt_);
+            sqlite3_reset(removeDeleteStmt_);
+            if (rc != SQLITE_DONE) {
+                std::cerr << "Failed to remove delete: " << sqlite3_errmsg(db_) << std::endl;
+                failed = true;
+                break;
+            }
+        }
+    }
+    if (savepoint) {
+        if (failed) {
+            (void)exec(db_, "ROLLBACK TO symspell_remove_deletes");
+        }
+        if (auto r = exec(db_, "RELEASE symspell_remove_deletes"); !r) {
+            std::cerr << r.error().message << std::endl;
+        }
+    }
+}
+
+bool SQLiteStore::removeTerm(std::string_view term) {
+    if (!removeTermStmt_) {
+        return false;
+    }
+    flushBeforeRead();
+
+    sqlite3_bind_text(removeTermStmt_, 1, term.data(), static_cast<int>(term.size()),
+                      SQLITE_STATIC);
+    int rc = sqlite3_step(removeTermStmt_);
+    sqlite3_reset(removeTermStmt_);
+    sqlite3_clear_bindings(removeTermStmt_);
+    if (rc != SQLITE_DONE) {
+        std::cerr << "Failed to remove term: " << sqlite3_errmsg(db_) << std::endl;
+        return false;
+    }
+
+    if (importing_) {
+        if (auto it = termIds_.find(term); it != termIds_.end()) {
+            termIds_.erase(it);
+        }
+    }
+    return sqlite3_changes(db_) > 0;
+}
+
+std::optional<int64_t> SQLiteStore::termId(std::string_view term) {
+    if (importing_) {
+        if (auto it = termIds_.find(term); it != termIds_.end()) {
+            return it->second;
+        }
+    }
+
+    sqlite3_bind_text(getTermIdStmt_, 1, term.data(), static_cast<int>(term.size()),
+                      SQLITE_STATIC);
+    std::optional<int64_t> id;
+    if (sqlite3_step(getTermIdStmt_) == SQLITE_ROW) {
+        id = sqlite3_column_int64(getTermIdStmt_, 0);
+    }
+    sqlite3_reset(getTermIdStmt_);
+    sqlite3_clear_bindings(getTermIdStmt_);
+
+    if (importing_ && id) {
+        termIds_.emplace(std::string(term), *id);
+    }
+    return id;
+}
+
+Result<void> SQLiteStore::writeDeleteRows(std::span<const DeleteRow> rows) {
+    if (packed_) {
+        return packedWriter_->addRows(rows);
+    }
+
+    size_t i = 0;
+    for (; i + kDeleteRowsPerInsert <= rows.size(); i += kDeleteRowsPerInsert) {
+        for (size_t j = 0; j < kDeleteRowsPerInsert; ++j) {
+            int param = static_cast<int>(2 * j);
+            sqlite3_bind_int64(addDeleteRowsStmt_, param + 1, rows[i + j].hash);
+            sqlite3_bind_int64(addDeleteRowsStmt_, param + 2, rows[i + j].termId);
+        }
+        int rc = sqlite3_step(addDeleteRowsStmt_);
+        sqlite3_reset(addDeleteRowsStmt_);
+        if (rc != SQLITE_DONE) {
+            return Result<void>(Error(ErrorCode::DatabaseError,
+                                      std::string("Failed to insert deletes: ") +
+                                          sqlite3_errmsg(db_)));
+        }
+    }
+
+    for (; i < rows.size(); ++i) {
+        sqlite3_bind_int64(addDeleteRowStmt_, 1, rows[i].hash);
+        sqlite3_bind_int64(addDeleteRowStmt_, 2, rows[i].termId);
+        int rc = sqlite3_step(addDeleteRowStmt_);
+        sqlite3_reset(addDeleteRowStmt_);
+        if (rc != SQLITE_DONE) {
+            return Result<void>(Error(ErrorCode::DatabaseError,
+                                      std::string("Failed to insert delete: ") +
+                                          sqlite3_errmsg(db_)));
+        }
+    }
+    return Result<void>();
+}
+
+Result<void> SQLiteStore::removePackedDeletes(int64_t termId, std::span<const DeleteHash> hashes) {
+    PackedWriter& writer = *packedWriter_;
+    for (DeleteHash hash : hashes) {
+        if (auto r = writer.load(hash); !r) {
+            return r;
+        }
+        auto it = std::lower_bound(writer.ids.begin(), writer.ids.end(), termId);
+        if (it == writer.ids.end() || *it != termId) {
+            continue;
+        }
+        writer.ids.erase(it);
+        if (auto r = writer.store(hash); !r) {
+            return r;
+        }
+    }
+    return Result<void>();
+}
 
-    if (!getTermsStmt_) {
-        return result;
+Result<void> SQLiteStore::flushPendingDeletes() {
+    std::sort(pendingDeletes_.begin(), pendingDeletes_.end(),
+              [](const DeleteRow& a, const DeleteRow& b) {
+                  return a.hash != b.hash ? a.hash < b.hash : a.termId < b.termId;
+              });
+    auto last = std::unique(pendingDeletes_.begin(), pendingDeletes_.end(),
+                            [](const DeleteRow& a, const DeleteRow& b) {
+                                return a.hash == b.hash && a.termId == b.termId;
+                            });
+    pendingDeletes_.erase(last, pendingDeletes_.end());
+
+    auto result = writeDeleteRows(pendingDeletes_);
+    pendingDeletes_.clear();
+    return result;
+}
+
+Result<void> SQLiteStore::beginBulkImport(const BulkImportOptions& options) {
+    if (importing_) {
+        return Result<void>(Error(ErrorCode::InternalError, "Bulk import already in progress"));
     }
 
-    sqlite3_bind_int(getTermsStmt_, 1, hash);
+    auto journalMode = pragma(db_, "journal_mode");
+    auto synchronous = pragma(db_, "synchronous");
+    if (!journalMode) {
+        return Result<void>(journalMode.error());
+    }
+    if (!synchronous) {
+        return Result<void>(synchronous.error());
+    }
 
-    while (sqlite3_step(getTermsStmt_) == SQLITE_ROW) {
-        const char* term = reinterpret_cast<const char*>(sqlite3_column_text(getTermsStmt_, 0));
-        if (term) {
-            result.push_back(term);
+    // journal_mode can only change outside a transaction, so pragmas go first.
+    if (!options.journalMode.empty()) {
+        auto mode = pragma(db_, "journal_mode", options.journalMode);
+        if (!mode) {
+            return Result<void>(mode.error());
+        }
+        std::string requested = options.journalMode;
+        std::transform(requested.begin(), requested.end(), requested.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (mode.value() != requested) {
+            return Result<void>(Error(ErrorCode::DatabaseError,
+                                      "Failed to set journal_mode to " + options.journalMode));
+        }
+    }
+    if (!options.synchronous.empty()) {
+        if (auto r = pragma(db_, "synchronous", options.synchronous); !r) {
+            (void)pragma(db_, "journal_mode", journalMode.value());
+            return Result<void>(r.error());
         }
     }
 
-    sqlite3_reset(getTermsStmt_);
+    ownsImportTransaction_ = sqlite3_get_autocommit(db_) != 0;
+    if (ownsImportTransaction_) {
+        if (auto r = exec(db_, "BEGIN TRANSACTION"); !r) {
+            (void)pragma(db_, "synchronous", synchronous.value());
+            (void)pragma(db_, "journal_mode", journalMode.value());
+            return r;
+        }
+    }
+
+    savedJournalMode_ = journalMode.value();
+    savedSynchronous_ = synchronous.value();
+    importOptions_ = options;
+    importOptions_.deleteBufferRows = std::max<size_t>(1, options.deleteBufferRows);
+    importing_ = true;
+    return Result<void>();
+}
+
+Result<void> SQLiteStore::endBulkImport() {
+    if (!importing_) {
+        return Result<void>();
+    }
+
+    auto result = flushPendingDeletes();
+    flushMetadata();
+    if (ownsImportTransaction_) {
+        if (result) {
+            result = exec(db_, "COMMIT");
+        }
+        if (!result) {
+            (void)exec(db_, "ROLLBACK");
+        }
+    }
 
+    if (!importOptions_.synchronous.empty()) {
+        (void)pragma(db_, "synchronous", savedSynchronous_);
+    }
+    if (!importOptions_.journalMode.empty()) {
+        (void)pragma(db_, "journal_mode", savedJournalMode_);
+    }
+
+    importing_ = false;
+    ownsImportTransaction_ = false;
+    termIds_.clear();
+    std::vector<DeleteRow>().swap(pendingDeletes_);
+    return result;
+}
+
+std::vector<std::string> SQLiteStore::getTerms(DeleteHash hash) {
+    std::vector<std::string> result;
+    visitTerms(hash, [&](std::string_view term) {
+        result.emplace_back(term);
+        return true;
+    });
     return result;
 }
 
+void SQLiteStore::visitTerms(DeleteHash hash, TermVisitor visitor) {
+    flushBeforeRead();
+    ReaderLease lease(*this);
+    sqlite3_stmt* stmt = lease.reader().getTerms;
+
+    sqlite3_bind_int64(stmt, 1, hash);
+
+    // Column text stays valid until the next step/reset, which covers the visitor call.
+    std::chrono::nanoseconds stepTime{0};
+    uint64_t rows = 0;
+    if (packed_) {
+        std::vector<int64_t> ids;
+        if (timedStep(stmt, stepTime) == SQLITE_ROW) {
+            decodePostings(sqlite3_column_blob(stmt, 0),
+                           static_cast<size_t>(sqlite3_column_bytes(stmt, 0)), [&](int64_t id) {
+                               ids.push_back(id);
+                               return true;
+                           });
+        }
+        sqlite3_reset(stmt);
+        lease.reader().visitTermsByIds(ids, stepTime,
+                                       [&](int64_t, std::string_view term, int64_t) {
+                                           ++rows;
+                                           return visitor(term);
+                                       });
+    }
+    while (!packed_ && timedStep(stmt, stepTime) == SQLITE_ROW) {
+        const char* term = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        if (!term) {
+            continue;
+        }
+        ++rows;
+        auto len = static_cast<size_t>(sqlite3_column_bytes(stmt, 0));
+        if (!visitor(std::string_view(term, len))) {
+            break;
+        }
+    }
+
+    sqlite3_reset(stmt);
+    counters_.recordProbe(1, rows);
+    counters_.recordStepTime(stepTime);
+}
+
+void SQLiteStore::visitTermsMulti(std::span<const DeleteHash> hashes, MultiTermVisitor visitor) {
+    flushBeforeRead();
+    ReaderLease lease(*this);
+    sqlite3_stmt* stmt = lease.reader().getTermsMulti;
+
+    std::chrono::nanoseconds stepTime{0};
+    uint64_t rows = 0;
+    bool stopped = false;
+    // Packed buckets of one probe, as (term id, delete hash) sorted by id, and their ids.
+    std::vector<std::pair<int64_t, DeleteHash>> postings;
+    std::vector<int64_t> ids;
+    for (size_t begin = 0; begin < hashes.size() && !stopped; begin += kHashesPerProbe) {
+        size_t count = std::min(kHashesPerProbe, hashes.size() - begin);
+        for (size_t i = 0; i < kHashesPerProbe; ++i) {
+            sqlite3_bind_int64(stmt, static_cast<int>(i) + 1,
+                               hashes[begin + std::min(i, count - 1)]);
+        }
+
+        // A term shared by several of the buckets is read once and visited for each.
+        if (packed_) {
+            postings.clear();
+            while (timedStep(stmt, stepTime) == SQLITE_ROW) {
+                DeleteHash rowHash = sqlite3_column_int64(stmt, 0);
+                decodePostings(sqlite3_column_blob(stmt, 1),
+                               static_cast<size_t>(sqlite3_column_bytes(stmt, 1)),
+                               [&](int64_t id) {
+                                   postings.emplace_back(id, rowHash);
+                                   return true;
+                               });
+            }
+            sqlite3_reset(stmt);
+            std::sort(postings.begin(), postings.end());
+            ids.clear();
+            for (const auto& posting : postings) {
+                if (ids.empty() || ids.back() != posting.first) {
+                    ids.push_back(posting.first);
+                }
+            }
+            stopped = !lease.reader().visitTermsByIds(
+                ids, stepTime, [&](int64_t id, std::string_view term, int64_t frequency) {
+                    auto it = std::lower_bound(
+                        postings.begin(), postings.end(), id,
+                        [](const auto& posting, int64_t key) { return posting.first < key; });
+                    for (; it != postings.end() && it->first == id; ++it) {
+                        ++rows;
+                        if (!visitor(it->second, term, &frequency)) {
+                            return false;
+                        }
+                    }
+                    return true;
+                });
+            continue;
+        }
+        while (!packed_ && timedStep(stmt, stepTime) == SQLITE_ROW) {
+            const char* term = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+            if (!term) {
+                continue;
+            }
+            ++rows;
+            auto len = static_cast<size_t>(sqlite3_column_bytes(stmt, 1));
+            int64_t frequency = sqlite3_column_int64(stmt, 2);
+            if (!visitor(sqlite3_column_int64(stmt, 0), std::string_view(term, len), &frequency)) {
+                stopped = true;
+                break;
+            }
+        }
+        sqlite3_reset(stmt);
+    }
+    counters_.recordProbe(hashes.size(), rows);
+    counters_.recordStepTime(stepTime);
+}
+
+void SQLiteStore::flushBeforeRead() {
+    if (importing_ && !pendingDeletes_.empty()) {
+        if (auto r = flushPendingDeletes(); !r) {
+            std::cerr << r.error().message << std::endl;
+        }
+    }
+}
+
 void SQLiteStore::setFrequency(std::string_view term, int64_t freq) {
     if (!setFrequencyStmt_) {
         return;
@@ -203,52 +1394,218 @@ void SQLiteStore::setFrequency(std::string_view term, int64_t freq) {
                       SQLITE_STATIC);
     sqlite3_bind_int64(setFrequencyStmt_, 2, freq);
 
-    sqlite3_step(setFrequencyStmt_);
+    if (sqlite3_step(setFrequencyStmt_) == SQLITE_ROW && importing_) {
+        termIds_.insert_or_assign(std::string(term), sqlite3_column_int64(setFrequencyStmt_, 0));
+    }
     sqlite3_reset(setFrequencyStmt_);
     sqlite3_clear_bindings(setFrequencyStmt_);
 }
 
 std::optional<int64_t> SQLiteStore::getFrequency(std::string_view term) {
-    if (!getFrequencyStmt_) {
-        return std::nullopt;
-    }
+    ReaderLease lease(*this);
+    sqlite3_stmt* stmt = lease.reader().getFrequency;
 
-    sqlite3_bind_text(getFrequencyStmt_, 1, term.data(), static_cast<int>(term.size()),
-                      SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 1, term.data(), static_cast<int>(term.size()), SQLITE_STATIC);
 
     int64_t result = 0;
     bool found = false;
 
-    if (sqlite3_step(getFrequencyStmt_) == SQLITE_ROW) {
-        result = sqlite3_column_int64(getFrequencyStmt_, 0);
+    std::chrono::nanoseconds stepTime{0};
+    if (timedStep(stmt, stepTime) == SQLITE_ROW) {
+        result = sqlite3_column_int64(stmt, 0);
         found = true;
     }
 
-    sqlite3_reset(getFrequencyStmt_);
-    sqlite3_clear_bindings(getFrequencyStmt_);
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    counters_.recordStepTime(stepTime);
 
     return found ? std::optional<int64_t>(result) : std::nullopt;
 }
 
 bool SQLiteStore::termExists(std::string_view term) {
-    if (!termExistsStmt_) {
-        return false;
-    }
+    ReaderLease lease(*this);
+    sqlite3_stmt* stmt = lease.reader().termExists;
 
-    sqlite3_bind_text(termExistsStmt_, 1, term.data(), static_cast<int>(term.size()),
-                      SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 1, term.data(), static_cast<int>(term.size()), SQLITE_STATIC);
 
     bool exists = false;
-    if (sqlite3_step(termExistsStmt_) == SQLITE_ROW) {
+    std::chrono::nanoseconds stepTime{0};
+    if (timedStep(stmt, stepTime) == SQLITE_ROW) {
         exists = true;
     }
 
-    sqlite3_reset(termExistsStmt_);
-    sqlite3_clear_bindings(termExistsStmt_);
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    counters_.recordStepTime(stepTime);
 
     return exists;
 }
 
+std::optional<DictionaryMetadata> SQLiteStore::loadMetadata() {
+    flushBeforeRead();
+    DictionaryMetadata metadata;
+    bool found = false;
+    StatementGuard stmt;
+    if (tableExists(db_, "symspell_metadata") &&
+        sqlite3_prepare_v2(db_, kLoadMetadata, -1, &stmt.stmt, nullptr) == SQLITE_OK) {
+        while (sqlite3_step(stmt.stmt) == SQLITE_ROW) {
+            found = true;
+            std::string_view key(reinterpret_cast<const char*>(sqlite3_column_text(stmt.stmt, 0)),
+                                 static_cast<size_t>(sqlite3_column_bytes(stmt.stmt, 0)));
+            auto number = static_cast<int>(sqlite3_column_int64(stmt.stmt, 1));
+            const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt.stmt, 1));
+            std::string_view value(text ? text : "",
+                                   static_cast<size_t>(sqlite3_column_bytes(stmt.stmt, 1)));
+            if (key == "max_edit_distance") {
+                metadata.maxEditDistance = number;
+            } else if (key == "prefix_length") {
+                metadata.prefixLength = number;
+            } else if (key == "hash_bits") {
+                metadata.hashOptions.bits = number;
+            } else if (key == "compact_level") {
+                metadata.hashOptions.compactLevel = number;
+            } else if (key == "encoding") {
+                metadata.encoding = value == "utf8" ? TextEncoding::Utf8 : TextEncoding::Bytes;
+            } else if (key == "max_word_length") {
+                metadata.maxWordLength = number;
+            } else if (key == "term_count") {
+                metadata.termCount = static_cast<uint64_t>(sqlite3_column_int64(stmt.stmt, 1));
+            } else if (key == "min_bigram_count") {
+                metadata.minBigramCount = sqlite3_column_int64(stmt.stmt, 1);
+            } else if (key == "length_histogram") {
+                // Space-separated counts, indexed by length.
+                const char* p = value.data();
+                const char* end = p + value.size();
+                while (p < end) {
+                    uint64_t count = 0;
+                    auto [next, ec] = std::from_chars(p, end, count);
+                    if (ec != std::errc()) {
+                        break;
+                    }
+                    metadata.lengthHistogram.push_back(count);
+                    p = next + (next < end ? 1 : 0);
+                }
+            }
+        }
+    }
+    if (found) {
+        savedMetadata_ = metadata;
+        return metadata;
+    }
+
+    if (!countTerms(metadata) || (metadata.termCount == 0 && metadata.minBigramCount == 0)) {
+        return std::nullopt;
+    }
+    metadata.maxWordLength = static_cast<int>(metadata.lengthHistogram.size() - 1);
+    metadata.maxEditDistance = 0;
+    metadata.prefixLength = 0;
+    return metadata;
+}
+
+bool SQLiteStore::countTerms(DictionaryMetadata& metadata) {
+    auto minimum = minBigramFrequency();
+    StatementGuard stmt;
+    if (sqlite3_prepare_v2(db_, kTermLengths, -1, &stmt.stmt, nullptr) != SQLITE_OK) {
+        return false;
+    }
+    metadata.minBigramCount = minimum.value_or(0);
+    metadata.termCount = 0;
+    metadata.lengthHistogram.clear();
+    while (sqlite3_step(stmt.stmt) == SQLITE_ROW) {
+        auto length = static_cast<size_t>(sqlite3_column_int64(stmt.stmt, 0));
+        auto count = static_cast<uint64_t>(sqlite3_column_int64(stmt.stmt, 1));
+        if (metadata.lengthHistogram.size() <= length) {
+            metadata.lengthHistogram.resize(length + 1);
+        }
+        metadata.lengthHistogram[length] = count;
+        metadata.termCount += count;
+    }
+    return true;
+}
+
+std::optional<int64_t> SQLiteStore::minBigramFrequency() {
+    flushBeforeRead();
+    StatementGuard stmt;
+    if (sqlite3_prepare_v2(db_, kMinBigramFrequency, -1, &stmt.stmt, nullptr) != SQLITE_OK ||
+        sqlite3_step(stmt.stmt) != SQLITE_ROW ||
+        sqlite3_column_type(stmt.stmt, 0) == SQLITE_NULL) {
+        return std::nullopt;
+    }
+    return sqlite3_column_int64(stmt.stmt, 0);
+}
+
+void SQLiteStore::saveMetadata(const DictionaryMetadata& metadata) {
+    const DictionaryMetadata* saved = savedMetadata_ ? &*savedMetadata_ : nullptr;
+    if (saved && saved->maxEditDistance == metadata.maxEditDistance &&
+        saved->prefixLength == metadata.prefixLength &&
+        saved->hashOptions == metadata.hashOptions && saved->encoding == metadata.encoding &&
+        saved->maxWordLength == metadata.maxWordLength) {
+        pendingMetadata_ = metadata;
+        metadataPending_ = true;
+        return;
+    }
+    writeMetadata(metadata);
+}
+
+void SQLiteStore::flushMetadata() {
+    if (metadataPending_) {
+        writeMetadata(pendingMetadata_);
+    }
+}
+
+void SQLiteStore::writeMetadata(const DictionaryMetadata& given) {
+    metadataPending_ = false;
+    const DictionaryMetadata* source = &given;
+    DictionaryMetadata recounted;
+    if (recountMetadata_) {
+        recounted = given;
+        if (countTerms(recounted)) {
+            source = &recounted;
+        }
+    }
+    const DictionaryMetadata& metadata = *source;
+    if (!saveMetadataStmt_) {
+        if (auto r = exec(db_, kCreateMetadataTable); !r) {
+            std::cerr << r.error().message << std::endl;
+            return;
+        }
+        if (auto r = prepare(db_, kSaveMetadata, &saveMetadataStmt_, "saveMetadata"); !r) {
+            std::cerr << r.error().message << std::endl;
+            return;
+        }
+    }
+
+    std::string histogram;
+    for (uint64_t count : metadata.lengthHistogram) {
+        histogram += histogram.empty() ? "" : " ";
+        histogram += std::to_string(count);
+    }
+    const char* encoding = metadata.encoding == TextEncoding::Utf8 ? "utf8" : "bytes";
+    sqlite3_stmt* stmt = saveMetadataStmt_;
+    sqlite3_bind_int(stmt, 1, metadata.maxEditDistance);
+    sqlite3_bind_int(stmt, 2, metadata.prefixLength);
+    sqlite3_bind_int(stmt, 3, metadata.hashOptions.bits);
+    sqlite3_bind_int(stmt, 4, metadata.hashOptions.compactLevel);
+    sqlite3_bind_text(stmt, 5, encoding, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 6, metadata.maxWordLength);
+    sqlite3_bind_int64(stmt, 7, static_cast<int64_t>(metadata.termCount));
+    sqlite3_bind_text(stmt, 8, histogram.data(), static_cast<int>(histogram.size()),
+                      SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, 9, metadata.minBigramCount);
+    int rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    if (rc == SQLITE_DONE) {
+        savedMetadata_ = metadata;
+    } else {
+        std::cerr << "Failed to save metadata: " << sqlite3_errmsg(db_) << std::endl;
+        savedMetadata_.reset();
+        // A rolled-back transaction may have taken the table with it; recreate it next time.
+        sqlite3_finalize(saveMetadataStmt_);
+        saveMetadataStmt_ = nullptr;
+    }
+}
+
 void SQLiteStore::beginTransaction() {
     if (!inTransaction_) {
         char* errMsg = nullptr;
@@ -263,6 +1620,7 @@ void SQLiteStore::beginTransaction() {
 
 void SQLiteStore::commitTransaction() {
     if (inTransaction_) {
+        flushMetadata();
         char* errMsg = nullptr;
         if (sqlite3_exec(db_, "COMMIT", nullptr, nullptr, &errMsg) != SQLITE_OK) {
             std::cerr << "Failed to commit transaction: " << errMsg << std::endl;
@@ -278,6 +1636,12 @@ void SQLiteStore::rollbackTransaction() {
     if (inTransaction_) {
         sqlite3_exec(db_, "ROLLBACK", nullptr, nullptr, nullptr);
         inTransaction_ = false;
+        // The counts handed to saveMetadata() still include the rolled-back terms, so from now
+        // on every write re-derives them from symspell_terms, and the next save rewrites every
+        // key.
+        savedMetadata_.reset();
+        metadataPending_ = false;
+        recountMetadata_ = true;
     }
 }
 
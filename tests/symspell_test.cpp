@@ -1,16 +1,65 @@
 #include <sqlite3.h>
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
 #include <chrono>
+#include <fstream>
 #include <iostream>
+#include <map>
 #include <mutex>
+#include <set>
+#include <sstream>
 #include <string>
 #include <thread>
+#include <tuple>
 #include <vector>
+#include <symspell/compound.hpp>
+#include <symspell/dictionary_loader.hpp>
+#include <symspell/live_dictionary.hpp>
+#include <symspell/offload_store.hpp>
+#include <symspell/sharded_store.hpp>
 #include <symspell/symspell.hpp>
+#include <symspell/symspell_snapshot.hpp>
 #include <symspell/symspell_sqlite.hpp>
+#include <symspell/tiered_store.hpp>
 
 using namespace yams::symspell;
 
+// Global allocation counter used to check that context-based lookups do not allocate.
+static std::atomic<size_t> gAllocations{0};
+
+void* operator new(std::size_t size) {
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
 void testBasicLookup() {
     std::cout << "Running testBasicLookup... " << std::flush;
 
@@ -99,6 +148,117 @@ void testFrequencyAccumulation() {
     std::cout << "PASSED" << std::endl;
 }
 
+void testDictionaryRemoval() {
+    std::cout << "Running testDictionaryRemoval... " << std::flush;
+
+    auto hasTerm = [](const std::vector<Suggestion>& suggestions, std::string_view term) {
+        return std::any_of(suggestions.begin(), suggestions.end(),
+                           [&](const Suggestion& s) { return s.term == term; });
+    };
+
+    {
+        auto memory = std::make_unique<MemoryStore>(2, 7);
+        auto* store = memory.get();
+        SymSpell spell(std::move(memory), 2, 7);
+        spell.createDictionaryEntry("hello", 1000);
+        spell.createDictionaryEntry("help", 500);
+        spell.createDictionaryEntry("hollow", 200);
+        assert(hasTerm(spell.lookup("hellp", Verbosity::All), "hello"));
+
+        assert(spell.removeDictionaryEntry("hello"));
+        assert(!spell.removeDictionaryEntry("hello"));
+        assert(!store->termExists("hello") && store->termCount() == 2);
+        auto suggestions = spell.lookup("hellp", Verbosity::All);
+        assert(!hasTerm(suggestions, "hello") && hasTerm(suggestions, "help"));
+
+        // A removed term comes back when added again, and freeze() compacts the tombstones.
+        spell.createDictionaryEntry("hello", 7);
+        assert(spell.lookup("hello", Verbosity::Top)[0].frequency == 7);
+        assert(spell.removeDictionaryEntry("hollow"));
+        store->freeze();
+        assert(store->termCount() == 2 && store->getFrequency("help") == 500);
+        assert(!hasTerm(spell.lookup("hollw", Verbosity::All), "hollow"));
+        assert(spell.lookup("hellp", Verbosity::Closest).size() == 2);
+
+        bool threw = false;
+        try {
+            spell.removeDictionaryEntry("help");
+        } catch (const std::logic_error&) {
+            threw = true;
+        }
+        assert(threw);
+    }
+
+    {
+        // Decrements demote a word below the threshold to the staging area and back.
+        SymSpell spell(std::make_unique<MemoryStore>(2, 7), 2, 7);
+        spell.setCountThreshold(10);
+        spell.createDictionaryEntry("tree", 15);
+        assert(spell.decrementDictionaryEntry("tree", 3));
+        assert(spell.lookup("tree", Verbosity::Top)[0].frequency == 12);
+        assert(spell.decrementDictionaryEntry("tree", 5));
+        assert(spell.lookup("tree", Verbosity::Top).empty() && spell.stagedCount() == 1);
+        spell.createDictionaryEntry("tree", 3);
+        assert(spell.lookup("tree", Verbosity::Top)[0].frequency == 10);
+        assert(spell.stagedCount() == 0);
+        assert(spell.decrementDictionaryEntry("tree", 100));
+        assert(spell.lookup("tree", Verbosity::Top).empty() && spell.stagedCount() == 0);
+        assert(!spell.decrementDictionaryEntry("tree"));
+        assert(!spell.decrementDictionaryEntry("absent"));
+    }
+
+    {
+        // A bounded staging area keeps the most frequent sub-threshold words.
+        SymSpell spell(std::make_unique<MemoryStore>(2, 7), 2, 7);
+        spell.setCountThreshold(100);
+        spell.setStagingCapacity(4);
+        for (int i = 1; i <= 10; ++i) {
+            spell.createDictionaryEntry("w" + std::to_string(i), i);
+        }
+        assert(spell.stagedCount() <= 4);
+        assert(spell.stagingEvictions() == 10 - spell.stagedCount());
+        spell.createDictionaryEntry("w10", 90);
+        assert(!spell.lookup("w10", Verbosity::Top).empty());
+
+        spell.setStagingCapacity(0);
+        assert(spell.stagedCount() == 0);
+        spell.createDictionaryEntry("rare", 1);
+        assert(spell.stagedCount() == 0);
+    }
+
+    {
+        sqlite3* db;
+        int rc = sqlite3_open(":memory:", &db);
+        assert(rc == SQLITE_OK);
+        assert(SQLiteStore::initializeDatabase(db));
+
+        auto tiered = std::make_unique<TieredStore>(std::make_unique<SQLiteStore>(db, 2, 7));
+        SymSpell spell(std::move(tiered), 2, 7);
+        spell.createDictionaryEntry("hello", 1000);
+        spell.createDictionaryEntry("help", 500);
+        assert(hasTerm(spell.lookup("hellp", Verbosity::All), "hello"));
+
+        assert(spell.removeDictionaryEntry("hello"));
+        assert(!spell.removeDictionaryEntry("hello"));
+        assert(!hasTerm(spell.lookup("hellp", Verbosity::All), "hello"));
+
+        sqlite3_stmt* stmt;
+        sqlite3_prepare_v2(db, "SELECT COUNT(*) FROM symspell_deletes", -1, &stmt, nullptr);
+        sqlite3_step(stmt);
+        int64_t rows = sqlite3_column_int64(stmt, 0);
+        sqlite3_finalize(stmt);
+        assert(spell.removeDictionaryEntry("help"));
+        sqlite3_prepare_v2(db, "SELECT COUNT(*) FROM symspell_deletes", -1, &stmt, nullptr);
+        sqlite3_step(stmt);
+        assert(rows > 0 && sqlite3_column_int64(stmt, 0) == 0);
+        sqlite3_finalize(stmt);
+
+        sqlite3_close(db);
+    }
+
+    std::cout << "PASSED" << std::endl;
+}
+
 void testMultipleEdits() {
     std::cout << "Running testMultipleEdits... " << std::flush;
 
@@ -160,6 +320,276 @@ void testMaxEditDistance() {
     std::cout << "PASSED" << std::endl;
 }
 
+// Store that only implements the copying getTerms() API, exercising the visitTerms() fallback.
+class LegacyStore : public ISymSpellStore {
+public:
+    void addDelete(DeleteHash hash, std::string_view term) override {
+        inner_.addDelete(hash, term);
+    }
+    std::vector<std::string> getTerms(DeleteHash hash) override { return inner_.getTerms(hash); }
+    void setFrequency(std::string_view term, int64_t freq) override {
+        inner_.setFrequency(term, freq);
+    }
+    std::optional<int64_t> getFrequency(std::string_view term) override {
+        ++frequencyLookups;
+        return inner_.getFrequency(term);
+    }
+    bool termExists(std::string_view term) override { return inner_.termExists(term); }
+
+    int frequencyLookups = 0;
+
+private:
+    MemoryStore inner_;
+};
+
+void testVisitTerms() {
+    std::cout << "Running testVisitTerms... " << std::flush;
+
+    MemoryStore store(2, 7);
+    store.addDelete(42, "alpha");
+    store.addDelete(42, "beta");
+    store.addDelete(42, "gamma");
+
+    std::vector<std::string> seen;
+    store.visitTerms(42, [&](std::string_view term) {
+        seen.emplace_back(term);
+        return true;
+    });
+    assert((seen == std::vector<std::string>{"alpha", "beta", "gamma"}));
+
+    seen.clear();
+    store.visitTerms(42, [&](std::string_view term) {
+        seen.emplace_back(term);
+        return seen.size() < 2;
+    });
+    assert(seen.size() == 2);
+
+    store.visitTerms(7, [](std::string_view) {
+        assert(false);
+        return true;
+    });
+
+    SymSpell spell(std::make_unique<LegacyStore>(), 2, 7);
+    spell.createDictionaryEntry("hello", 1000);
+    spell.createDictionaryEntry("help", 100);
+
+    auto suggestions = spell.lookup("hellp", Verbosity::Closest);
+    assert(!suggestions.empty());
+    assert(suggestions[0].term == "hello");
+
+    std::cout << "PASSED" << std::endl;
+}
+
+// Counts bucket probes made by SymSpell::lookup.
+class ProbeCountingStore : public MemoryStore {
+public:
+    void visitTerms(DeleteHash hash, TermVisitor visitor) override {
+        ++singleProbes;
+        MemoryStore::visitTerms(hash, visitor);
+    }
+    void visitTermsMulti(std::span<const DeleteHash> hashes, MultiTermVisitor visitor) override {
+        ++multiProbes;
+        MemoryStore::visitTermsMulti(hashes, visitor);
+    }
+    std::optional<int64_t> getFrequency(std::string_view term) override {
+        ++frequencyLookups;
+        return MemoryStore::getFrequency(term);
+    }
+
+    int singleProbes = 0;
+    int multiProbes = 0;
+    int frequencyLookups = 0;
+};
+
+void testMultiHashProbe() {
+    std::cout << "Running testMultiHashProbe... " << std::flush;
+
+    MemoryStore store(2, 7);
+    store.setFrequency("alpha", 5);
+    store.setFrequency("beta", 7);
+    store.addDelete(1, "alpha");
+    store.addDelete(2, "beta");
+    store.addDelete(2, "alpha");
+
+    std::vector<std::tuple<int, std::string, int64_t>> seen;
+    std::vector<DeleteHash> hashes = {3, 2, 1};
+    store.visitTermsMulti(hashes, [&](DeleteHash hash, std::string_view term,
+                                      const int64_t* freq) {
+        assert(freq != nullptr);
+        seen.emplace_back(hash, std::string(term), *freq);
+        return true;
+    });
+    std::sort(seen.begin(), seen.end());
+    assert((seen == std::vector<std::tuple<int, std::string, int64_t>>{
+                        {1, "alpha", 5}, {2, "alpha", 5}, {2, "beta", 7}}));
+
+    // The fallback goes through visitTerms() and leaves frequencies to the caller.
+    LegacyStore legacy;
+    legacy.setFrequency("alpha", 5);
+    legacy.addDelete(1, "alpha");
+    int calls = 0;
+    legacy.visitTermsMulti(hashes, [&](DeleteHash hash, std::string_view term,
+                                       const int64_t* freq) {
+        assert(hash == 1 && term == "alpha" && freq == nullptr);
+        return ++calls < 1;
+    });
+    assert(calls == 1);
+
+    // One probe per candidate level: the input prefix plus one level per edit.
+    auto counting = std::make_unique<ProbeCountingStore>();
+    auto* probes = counting.get();
+    SymSpell spell(std::move(counting), 2, 7);
+    for (int i = 0; i < 200; ++i) {
+        spell.createDictionaryEntry("word" + std::to_string(i), 100 + i);
+    }
+    probes->frequencyLookups = 0;
+    auto suggestions = spell.lookup("wrod17", Verbosity::All);
+    assert(!suggestions.empty());
+    assert(probes->singleProbes == 0);
+    assert(probes->multiProbes == 3);
+    // Frequencies come with the probe; only the exact-match check asks the store.
+    assert(probes->frequencyLookups == 1);
+
+    // Without probe frequencies, only suggestions that pass the distance check are resolved.
+    auto legacyStore = std::make_unique<LegacyStore>();
+    auto* legacyProbes = legacyStore.get();
+    SymSpell legacySpell(std::move(legacyStore), 2, 7);
+    for (int i = 0; i < 200; ++i) {
+        legacySpell.createDictionaryEntry("word" + std::to_string(i), 100 + i);
+    }
+    legacyProbes->frequencyLookups = 0;
+    auto legacySuggestions = legacySpell.lookup("wrod17", Verbosity::All);
+    std::sort(suggestions.begin(), suggestions.end());
+    std::sort(legacySuggestions.begin(), legacySuggestions.end());
+    assert(legacySuggestions == suggestions);
+    assert(legacyProbes->frequencyLookups == 1 + static_cast<int>(suggestions.size()));
+
+    std::cout << "PASSED" << std::endl;
+}
+
+void testTermInterning() {
+    std::cout << "Running testTermInterning... " << std::flush;
+
+    TermDictionary dict;
+    std::vector<TermId> ids;
+    for (int i = 0; i < 1000; ++i) {
+        ids.push_back(dict.intern("term" + std::to_string(i)));
+    }
+    assert(dict.size() == 1000);
+    assert(dict.intern("term500") == ids[500]);
+    assert(dict.term(ids[999]) == "term999");
+    assert(dict.find("term42") == ids[42]);
+    assert(!dict.find("missing").has_value());
+    assert(dict.find("") == std::nullopt);
+
+    MemoryStore store(2, 7);
+    store.setFrequency("hello", 10);
+    store.addDelete(1, "hello");
+    store.addDelete(1, "hello");
+    store.addDelete(2, "hello");
+    store.addDelete(2, "help");
+    assert(store.termCount() == 2);
+    assert(store.bucketCount() == 2);
+    assert(store.getTerms(1).size() == 1);
+    assert((store.getTerms(2) == std::vector<std::string>{"hello", "help"}));
+    assert(store.getFrequency("hello") == 10);
+    store.setFrequency("hello", 20);
+    assert(store.getFrequency("hello") == 20);
+    assert(!store.termExists("help"));
+    assert(!store.getFrequency("help"));
+    assert(!store.termExists("hel"));
+
+    std::cout << "PASSED" << std::endl;
+}
+
+void testFrozenStore() {
+    std::cout << "Running testFrozenStore... " << std::flush;
+
+    auto store = std::make_unique<MemoryStore>(2, 7);
+    auto* raw = store.get();
+    SymSpell spell(std::move(store), 2, 7);
+
+    for (int i = 0; i < 2000; ++i) {
+        spell.createDictionaryEntry("word" + std::to_string(i), 100 + i);
+    }
+    spell.createDictionaryEntry("hello", 1000);
+    spell.createDictionaryEntry("help", 100);
+
+    auto before = spell.lookup("wrod1234", Verbosity::All);
+    auto buckets = raw->bucketCount();
+
+    raw->freeze();
+    assert(raw->frozen());
+    assert(raw->bucketCount() == buckets);
+    assert(&spell.store() == raw);
+
+    auto after = spell.lookup("wrod1234", Verbosity::All);
+    std::sort(before.begin(), before.end());
+    std::sort(after.begin(), after.end());
+    assert(before == after);
+
+    auto suggestions = spell.lookup("hellp", Verbosity::Closest);
+    assert(!suggestions.empty());
+    assert(suggestions[0].term == "hello");
+
+    // Existing terms may still be re-weighted; new terms are rejected.
+    spell.createDictionaryEntry("help", 5000);
+    assert(raw->getFrequency("help") == 5100);
+
+    bool threw = false;
+    try {
+        spell.createDictionaryEntry("brandnew", 10);
+    } catch (const std::logic_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::cout << "PASSED" << std::endl;
+}
+
+void testLookupContext() {
+    std::cout << "Running testLookupContext... " << std::flush;
+
+    auto store = std::make_unique<MemoryStore>(2, 7);
+    SymSpell spell(std::move(store), 2, 7);
+    for (int i = 0; i < 2000; ++i) {
+        spell.createDictionaryEntry("word" + std::to_string(i), 100 + i % 37);
+    }
+    spell.createDictionaryEntry("hello", 1000);
+    spell.createDictionaryEntry("help", 100);
+
+    const std::vector<std::string> queries = {"wrod1234", "hellp", "word77", "wodr", "xyzzy", ""};
+    const Verbosity modes[] = {Verbosity::Top, Verbosity::Closest, Verbosity::All};
+
+    LookupContext context;
+    for (const auto& query : queries) {
+        for (auto mode : modes) {
+            auto expected = spell.lookup(query, mode);
+            auto actual = spell.lookup(query, context, mode);
+            assert(std::equal(expected.begin(), expected.end(), actual.begin(), actual.end()));
+        }
+        auto expected = spell.lookupTopK(query, 3);
+        auto actual = spell.lookupTopK(query, context, 3);
+        assert(std::equal(expected.begin(), expected.end(), actual.begin(), actual.end()));
+    }
+
+    // Steady state: the warmed-up context absorbs every buffer the lookups need.
+    size_t before = gAllocations.load();
+    size_t results = 0;
+    for (int iter = 0; iter < 3; ++iter) {
+        for (const auto& query : queries) {
+            for (auto mode : modes) {
+                results += spell.lookup(query, context, mode).size();
+            }
+            results += spell.lookupTopK(query, context, 3).size();
+        }
+    }
+    assert(gAllocations.load() == before);
+    assert(results > 0);
+
+    std::cout << "PASSED" << std::endl;
+}
+
 void testSQLiteStore() {
     std::cout << "Running testSQLiteStore... " << std::flush;
 
@@ -181,6 +611,29 @@ void testSQLiteStore() {
     assert(!suggestions.empty());
     assert(suggestions[0].term == "hello");
 
+    {
+        // Multi-hash probes span several fixed-size IN batches and report each row's hash.
+        SQLiteStore probe(db, 2, 7);
+        std::vector<DeleteHash> hashes;
+        for (int i = 0; i < 150; ++i) {
+            std::string term = "probe" + std::to_string(i);
+            probe.setFrequency(term, i);
+            probe.addDelete(1000 + i, term);
+            hashes.push_back(1000 + i);
+        }
+        hashes.push_back(99999);
+
+        int rows = 0;
+        probe.visitTermsMulti(hashes, [&](DeleteHash hash, std::string_view term,
+                                          const int64_t* freq) {
+            assert(term == "probe" + std::to_string(hash - 1000));
+            assert(freq && *freq == hash - 1000);
+            ++rows;
+            return true;
+        });
+        assert(rows == 150);
+    }
+
     sqlite3_close(db);
 
     std::cout << "PASSED" << std::endl;
@@ -229,6 +682,603 @@ void testSQLitePersistence() {
     std::cout << "PASSED" << std::endl;
 }
 
+void testSQLiteConcurrentReads() {
+    std::cout << "Running testSQLiteConcurrentReads... " << std::flush;
+
+    const char* path = "/tmp/symspell_concurrent_test.db";
+    std::remove(path);
+
+    sqlite3* db;
+    int rc = sqlite3_open(path, &db);
+    assert(rc == SQLITE_OK);
+    assert(SQLiteStore::initializeDatabase(db));
+
+    auto store = std::make_unique<SQLiteStore>(db, 2, 7);
+    auto* sqlite = store.get();
+    SymSpell spell(std::move(store), 2, 7);
+
+    sqlite->beginTransaction();
+    for (int i = 0; i < 300; ++i) {
+        spell.createDictionaryEntry("word" + std::to_string(i), 100 + i);
+    }
+    sqlite->commitTransaction();
+
+    std::vector<std::string> owned;
+    for (int i = 0; i < 200; ++i) {
+        owned.push_back("wrod" + std::to_string(i));
+    }
+    std::vector<std::string_view> inputs(owned.begin(), owned.end());
+
+    // Serialized mode: safe from several threads, batches stay on the caller.
+    assert(!sqlite->supportsConcurrentReads());
+    auto expected = spell.lookupBatch(inputs, Verbosity::Closest);
+
+    std::vector<std::thread> threads;
+    std::atomic<int> mismatches{0};
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&]() {
+            for (size_t i = 0; i < 50; ++i) {
+                if (spell.lookup(inputs[i], Verbosity::Closest) != expected[i]) {
+                    ++mismatches;
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    assert(mismatches == 0);
+
+    assert(sqlite->enableConcurrentReads(3));
+    assert(sqlite->supportsConcurrentReads());
+
+    BatchOptions options;
+    options.threads = 4;
+    options.minInputsPerThread = 1;
+    auto parallel = spell.lookupBatch(inputs, Verbosity::Closest, -1, options);
+    assert(parallel == expected);
+
+    // Writes inside a transaction stay visible to the writer's own reads.
+    sqlite->beginTransaction();
+    spell.createDictionaryEntry("fresh", 10);
+    assert(sqlite->getFrequency("fresh") == 10);
+    sqlite->commitTransaction();
+    assert(spell.lookup("frseh", Verbosity::Closest).at(0).term == "fresh");
+
+    sqlite3* memoryDb;
+    sqlite3_open(":memory:", &memoryDb);
+    assert(SQLiteStore::initializeDatabase(memoryDb));
+    {
+        SQLiteStore memoryStore(memoryDb, 2, 7);
+        assert(!memoryStore.enableConcurrentReads());
+    }
+    sqlite3_close(memoryDb);
+
+    spell = SymSpell(std::make_unique<MemoryStore>(), 2, 7);
+    sqlite3_close(db);
+    std::remove(path);
+
+    std::cout << "PASSED" << std::endl;
+}
+
+void testSQLiteBulkImport() {
+    std::cout << "Running testSQLiteBulkImport... " << std::flush;
+
+    const char* path = "/tmp/symspell_bulk_test.db";
+    std::remove(path);
+
+    std::vector<std::pair<std::string, int64_t>> words;
+    for (int i = 0; i < 500; ++i) {
+        words.emplace_back("entry" + std::to_string(i), 10 + i);
+    }
+
+    SymSpell reference(std::make_unique<MemoryStore>(2, 7), 2, 7);
+    reference.createDictionary(words);
+    reference.createDictionaryEntry("import", 5);
+    reference.createDictionaryEntry("import", 5);
+
+    {
+        sqlite3* db;
+        int rc = sqlite3_open(path, &db);
+        assert(rc == SQLITE_OK);
+        assert(SQLiteStore::initializeDatabase(db));
+
+        auto store = std::make_unique<SQLiteStore>(db, 2, 7);
+        auto* sqlite = store.get();
+        auto spell = std::make_unique<SymSpell>(std::move(store), 2, 7);
+
+        BulkImportOptions options;
+        options.journalMode = "MEMORY";
+        options.deleteBufferRows = 7;
+        assert(sqlite->beginBulkImport(options));
+        assert(sqlite->importing());
+        assert(!sqlite->beginBulkImport(options));
+
+        spell->createDictionary(words);
+        // Per-entry deletes are buffered; the lookup flushes them first.
+        spell->createDictionaryEntry("import", 5);
+        spell->createDictionaryEntry("import", 5);
+        auto during = spell->lookup("imprt", Verbosity::Top);
+        assert(during.size() == 1 && during[0].term == "import" && during[0].frequency == 10);
+
+        assert(sqlite->endBulkImport());
+        assert(!sqlite->importing());
+
+        sqlite3_stmt* stmt = nullptr;
+        sqlite3_prepare_v2(db, "PRAGMA journal_mode", -1, &stmt, nullptr);
+        assert(sqlite3_step(stmt) == SQLITE_ROW);
+        assert(std::string(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0))) ==
+               "delete");
+        sqlite3_finalize(stmt);
+
+        sqlite3_prepare_v2(db, "SELECT COUNT(*) FROM sqlite_master WHERE name = "
+                               "'idx_symspell_deletes_hash'",
+                           -1, &stmt, nullptr);
+        assert(sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_int(stmt, 0) == 0);
+        sqlite3_finalize(stmt);
+
+        spell.reset();
+        sqlite3_close(db);
+    }
+
+    {
+        sqlite3* db;
+        int rc = sqlite3_open(path, &db);
+        assert(rc == SQLITE_OK);
+        auto spell = std::make_unique<SymSpell>(std::make_unique<SQLiteStore>(db, 2, 7), 2, 7);
+
+        for (const auto& input : {"entyr12", "entry499", "etnry7", "imprt", "entr"}) {
+            auto expected = reference.lookup(input, Verbosity::All);
+            auto actual = spell->lookup(input, Verbosity::All);
+            std::sort(expected.begin(), expected.end());
+            std::sort(actual.begin(), actual.end());
+            assert(actual == expected);
+        }
+
+        spell.reset();
+        sqlite3_close(db);
+    }
+
+    std::remove(path);
+
+    std::cout << "PASSED" << std::endl;
+}
+
+void testSQLitePackedSchema() {
+    std::cout << "Running testSQLitePackedSchema... " << std::flush;
+
+    const char* path = "/tmp/symspell_packed_test.db";
+    std::remove(path);
+
+    std::vector<std::pair<std::string, int64_t>> words;
+    for (int i = 0; i < 2000; ++i) {
+        words.emplace_back("entry" + std::to_string(i), 10 + i);
+    }
+    SymSpell reference(std::make_unique<MemoryStore>(2, 7), 2, 7);
+    reference.createDictionary(words);
+
+    auto sameResults = [&](SymSpell& spell) {
+        for (const auto& input : {"entyr12", "entry1999", "etnry7", "entr", "ntry5"}) {
+            auto expected = reference.lookup(input, Verbosity::All);
+            auto actual = spell.lookup(input, Verbosity::All);
+            std::sort(expected.begin(), expected.end());
+            std::sort(actual.begin(), actual.end());
+            if (actual != expected) {
+                return false;
+            }
+        }
+        return true;
+    };
+    auto hasTerm = [](const std::vector<Suggestion>& suggestions, std::string_view term) {
+        return std::any_of(suggestions.begin(), suggestions.end(),
+                           [&](const Suggestion& s) { return s.term == term; });
+    };
+    auto scalar = [](sqlite3* db, const char* sql) {
+        sqlite3_stmt* stmt = nullptr;
+        sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
+        int64_t value = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int64(stmt, 0) : -1;
+        sqlite3_finalize(stmt);
+        return value;
+    };
+
+    sqlite3* db;
+    assert(sqlite3_open(path, &db) == SQLITE_OK);
+    assert(SQLiteStore::initializeDatabase(db));
+    assert(SQLiteStore::detectSchema(db) == SQLiteSchema::Rows);
+    {
+        auto store = std::make_unique<SQLiteStore>(db, 2, 7);
+        auto* sqlite = store.get();
+        SymSpell spell(std::move(store), 2, 7);
+        assert(sqlite->beginBulkImport());
+        spell.createDictionary(words);
+        assert(sqlite->endBulkImport());
+    }
+    std::vector<DeleteHash> sampled;
+    std::vector<std::vector<std::string>> sampledTerms;
+    {
+        SQLiteStore rows(db, 2, 7);
+        sqlite3_stmt* stmt = nullptr;
+        sqlite3_prepare_v2(db, "SELECT DISTINCT delete_hash FROM symspell_deletes LIMIT 100", -1,
+                           &stmt, nullptr);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            sampled.push_back(sqlite3_column_int64(stmt, 0));
+            sampledTerms.push_back(rows.getTerms(sampled.back()));
+            std::sort(sampledTerms.back().begin(), sampledTerms.back().end());
+        }
+        sqlite3_finalize(stmt);
+    }
+    int64_t rowsPages = scalar(db, "PRAGMA page_count");
+    int64_t deleteRows = scalar(db, "SELECT COUNT(*) FROM symspell_deletes");
+    int64_t buckets = scalar(db, "SELECT COUNT(DISTINCT delete_hash) FROM symspell_deletes");
+
+    // Migration packs every bucket into one row and drops the old table.
+    assert(SQLiteStore::initializeDatabase(db, SQLiteSchema::Packed));
+    assert(SQLiteStore::detectSchema(db) == SQLiteSchema::Packed);
+    assert(scalar(db, "SELECT COUNT(*) FROM sqlite_master WHERE name = 'symspell_deletes'") == 0);
+    assert(scalar(db, "SELECT COUNT(*) FROM symspell_postings") == buckets);
+    assert(sqlite3_exec(db, "VACUUM", nullptr, nullptr, nullptr) == SQLITE_OK);
+    assert(scalar(db, "PRAGMA page_count") * 2 < rowsPages);
+    // Initializing with the default schema keeps a packed database packed.
+    assert(SQLiteStore::initializeDatabase(db));
+    assert(SQLiteStore::detectSchema(db) == SQLiteSchema::Packed);
+
+    {
+        SQLiteStoreOptions options;
+        options.mmapSize = 1 << 20;
+        options.cacheSize = -4096;
+        auto store = std::make_unique<SQLiteStore>(db, 2, 7, options);
+        auto* sqlite = store.get();
+        assert(sqlite->schema() == SQLiteSchema::Packed);
+        assert(scalar(db, "PRAGMA cache_size") == -4096);
+        assert(scalar(db, "PRAGMA mmap_size") == 1 << 20);
+        SymSpell spell(std::move(store), 2, 7);
+        assert(sameResults(spell));
+
+        size_t expectedRows = 0;
+        for (size_t i = 0; i < sampled.size(); ++i) {
+            auto terms = sqlite->getTerms(sampled[i]);
+            std::sort(terms.begin(), terms.end());
+            assert(terms == sampledTerms[i]);
+            expectedRows += terms.size();
+        }
+        size_t probed = 0;
+        sqlite->visitTermsMulti(sampled, [&](DeleteHash hash, std::string_view term,
+                                             const int64_t* freq) {
+            size_t i = std::find(sampled.begin(), sampled.end(), hash) - sampled.begin();
+            assert(std::binary_search(sampledTerms[i].begin(), sampledTerms[i].end(), term));
+            assert(freq && *freq == reference.store().getFrequency(term));
+            ++probed;
+            return true;
+        });
+        assert(probed == expectedRows);
+
+        // Per-entry writes merge into the existing buckets and removals shrink them.
+        spell.createDictionaryEntry("entry12x", 7);
+        spell.createDictionaryEntry("entry12x", 7);
+        assert(spell.lookup("entry12x", Verbosity::Top).at(0).frequency == 14);
+        assert(hasTerm(spell.lookup("entry12", Verbosity::All), "entry12x"));
+        assert(spell.removeDictionaryEntry("entry12x"));
+        assert(!hasTerm(spell.lookup("entry12", Verbosity::All), "entry12x"));
+        assert(sameResults(spell));
+
+        // Pooled readers use the packed statements and the same pragmas.
+        assert(sqlite->enableConcurrentReads(2));
+        std::vector<std::string_view> inputs = {"entyr12", "etnry7", "entry1999", "ntry5"};
+        BatchOptions batch;
+        batch.threads = 2;
+        batch.minInputsPerThread = 1;
+        auto parallel = spell.lookupBatch(inputs, Verbosity::Closest, -1, batch);
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            assert(parallel[i] == reference.lookup(inputs[i], Verbosity::Closest));
+        }
+    }
+    sqlite3_close(db);
+    std::remove(path);
+    std::remove((std::string(path) + "-wal").c_str());
+    std::remove((std::string(path) + "-shm").c_str());
+
+    // A fresh packed database, loaded through the import window with small flushes.
+    assert(sqlite3_open(":memory:", &db) == SQLITE_OK);
+    assert(SQLiteStore::initializeDatabase(db, SQLiteSchema::Packed));
+    {
+        auto store = std::make_unique<SQLiteStore>(db, 2, 7);
+        auto* sqlite = store.get();
+        SymSpell spell(std::move(store), 2, 7);
+        BulkImportOptions options;
+        options.deleteBufferRows = 100;
+        assert(sqlite->beginBulkImport(options));
+        spell.createDictionary(words);
+        assert(sqlite->endBulkImport());
+        assert(sameResults(spell));
+        assert(scalar(db, "SELECT COUNT(*) FROM symspell_postings") == buckets);
+        assert(deleteRows > buckets);
+    }
+    sqlite3_close(db);
+
+    // Buckets larger than one id batch, terms shared between buckets and negative hashes.
+    assert(sqlite3_open(":memory:", &db) == SQLITE_OK);
+    assert(SQLiteStore::initializeDatabase(db, SQLiteSchema::Packed));
+    {
+        SQLiteStore store(db, 2, 7);
+        std::vector<DeleteHash> bucketHashes = {-5, 5, DeleteHash(1) << 40};
+        for (int i = 0; i < 600; ++i) {
+            std::string term = "term" + std::to_string(i);
+            store.setFrequency(term, i + 1);
+            store.addDelete(bucketHashes[0], term);
+            if (i % 3 == 0) {
+                store.addDelete(bucketHashes[1], term);
+                store.addDelete(bucketHashes[2], term);
+            }
+        }
+        assert(store.getTerms(bucketHashes[0]).size() == 600);
+        assert(store.getTerms(bucketHashes[1]).size() == 200);
+        std::map<DeleteHash, std::set<std::string>> visited;
+        store.visitTermsMulti(bucketHashes, [&](DeleteHash hash, std::string_view term,
+                                                const int64_t* freq) {
+            assert(freq && *freq == std::stoi(std::string(term.substr(4))) + 1);
+            assert(visited[hash].emplace(term).second);
+            return true;
+        });
+        assert(visited[bucketHashes[0]].size() == 600);
+        assert(visited[bucketHashes[1]] == visited[bucketHashes[2]]);
+        assert(visited[bucketHashes[1]].size() == 200);
+        size_t calls = 0;
+        store.visitTermsMulti(bucketHashes, [&](DeleteHash, std::string_view, const int64_t*) {
+            return ++calls < 10;
+        });
+        assert(calls == 10);
+    }
+    sqlite3_close(db);
+
+    std::cout << "PASSED" << std::endl;
+}
+
+void testSnapshotRoundTrip() {
+    std::cout << "Running testSnapshotRoundTrip... " << std::flush;
+
+    const char* path = "/tmp/symspell_test.snap";
+
+    auto store = std::make_unique<MemoryStore>(2, 7);
+    auto* memory = store.get();
+    SymSpell built(std::move(store), 2, 7);
+    for (int i = 0; i < 500; ++i) {
+        built.createDictionaryEntry("word" + std::to_string(i), 10 + i);
+    }
+    built.createDictionaryEntry("persistent", 999);
+
+    assert(!writeSnapshot(*memory, path));
+    memory->freeze(BucketOrder::Frequency);
+    auto written = writeSnapshot(*memory, path);
+    assert(written);
+
+    auto opened = SnapshotStore::open(path);
+    assert(opened);
+    auto snapshot = std::move(opened.value());
+    assert(snapshot->termCount() == memory->termCount());
+    assert(snapshot->header().maxWordLength == 10);
+    assert(snapshot->getFrequency("word42") == 52);
+    assert(!snapshot->termExists("word500"));
+    assert(snapshot->bucketsOrderedByFrequency());
+
+    SymSpell loaded(std::move(snapshot), 2, 7);
+    auto suggestions = loaded.lookup("persistant", Verbosity::Closest);
+    assert(!suggestions.empty());
+    assert(suggestions[0].term == "persistent");
+    assert(suggestions[0].frequency == 999);
+
+    auto expected = built.lookup("wrod12", Verbosity::All);
+    auto actual = loaded.lookup("wrod12", Verbosity::All);
+    std::sort(expected.begin(), expected.end());
+    std::sort(actual.begin(), actual.end());
+    assert(expected == actual);
+    assert(loaded.lookupTopK("wrod12", 3) == built.lookupTopK("wrod12", 3));
+
+    bool threw = false;
+    try {
+        loaded.createDictionaryEntry("brandnew", 10);
+    } catch (const std::logic_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    {
+        std::FILE* f = std::fopen(path, "r+b");
+        std::fputc('X', f);
+        std::fclose(f);
+    }
+    auto corrupt = SnapshotStore::open(path);
+    assert(!corrupt);
+    assert(corrupt.error() == ErrorCode::InvalidFormat);
+    assert(!SnapshotStore::open("/tmp/does_not_exist.snap"));
+
+    std::remove(path);
+
+    std::cout << "PASSED" << std::endl;
+}
+
+void testDictionaryMetadata() {
+    std::cout << "Running testDictionaryMetadata... " << std::flush;
+
+    auto stored = [](sqlite3* db, const char* key) {
+        sqlite3_stmt* stmt = nullptr;
+        sqlite3_prepare_v2(db, "SELECT value FROM symspell_metadata WHERE key = ?", -1, &stmt,
+                           nullptr);
+        sqlite3_bind_text(stmt, 1, key, -1, SQLITE_STATIC);
+        int64_t value = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int64(stmt, 0) : -1;
+        sqlite3_finalize(stmt);
+        return value;
+    };
+
+    const char* path = "/tmp/symspell_metadata_test.db";
+    std::remove(path);
+    {
+        sqlite3* db;
+        assert(sqlite3_open(path, &db) == SQLITE_OK);
+        assert(SQLiteStore::initializeDatabase(db));
+        {
+            SymSpell spell(std::make_unique<SQLiteStore>(db, 2, 7), 2, 7);
+            spell.createDictionaryEntry("cat", 10);
+            spell.createDictionaryEntry("horse", 5);
+            spell.createDictionaryEntry("hippopotamus", 2);
+            spell.createDictionary(std::vector<DictionaryEntry>{{"dog", 4}, {"mouse", 3}});
+            spell.createBigramEntry("cat", "horse", 7);
+            assert(spell.removeDictionaryEntry("horse"));
+            assert(spell.metadata().termCount == 4);
+
+            // The longest term is written at once, term counts when flushed.
+            assert(stored(db, "max_word_length") == 12 && stored(db, "term_count") == 5);
+            spell.createDictionaryEntry("ox", 1);
+            assert(stored(db, "term_count") == 5);
+            spell.store().flushMetadata();
+            assert(stored(db, "term_count") == 5);
+            assert(spell.removeDictionaryEntry("ox"));
+        }
+        assert(stored(db, "term_count") == 4);
+        sqlite3_close(db);
+    }
+    {
+        sqlite3* db;
+        assert(sqlite3_open(path, &db) == SQLITE_OK);
+        SymSpell spell(std::make_unique<SQLiteStore>(db, 2, 7), 2, 7);
+        const DictionaryMetadata& metadata = spell.metadata();
+        assert(spell.maxWordLength() == 12);
+        assert(metadata.maxEditDistance == 2 && metadata.prefixLength == 7);
+        assert(metadata.termCount == 4);
+        assert(spell.minBigramCount() == 7);
+        assert(metadata.lengthHistogram.size() == 13);
+        assert(metadata.lengthHistogram[3] == 2 && metadata.lengthHistogram[5] == 1 &&
+               metadata.lengthHistogram[12] == 1);
+        auto suggestions = spell.lookup("hipopotamus", Verbosity::Closest);
+        assert(!suggestions.empty() && suggestions[0].term == "hippopotamus");
+
+        // A smaller edit distance reuses the deletes; a larger one or another prefix cannot.
+        SymSpell narrower(std::make_unique<SQLiteStore>(db, 1, 7), 1, 7);
+        assert(narrower.maxWordLength() == 12);
+        for (auto [editDistance, prefixLength] : {std::pair{3, 7}, std::pair{2, 5}}) {
+            bool threw = false;
+            try {
+                SymSpell mismatched(std::make_unique<SQLiteStore>(db, editDistance, prefixLength),
+                                    editDistance, prefixLength);
+            } catch (const std::invalid_argument&) {
+                threw = true;
+            }
+            assert(threw);
+        }
+
+        // Databases written before the metadata table existed report what symspell_terms holds.
+        assert(sqlite3_exec(db, "DROP TABLE symspell_metadata", nullptr, nullptr, nullptr) ==
+               SQLITE_OK);
+        SymSpell legacy(std::make_unique<SQLiteStore>(db, 3, 5), 3, 5);
+        assert(legacy.maxWordLength() == 12);
+        assert(legacy.metadata().termCount == 4);
+        assert(legacy.metadata().lengthHistogram == metadata.lengthHistogram);
+        assert(legacy.minBigramCount() == 7);
+        sqlite3_close(db);
+    }
+    std::remove(path);
+
+    // Writes to a store with unknown parameters leave them unknown, until they are recorded.
+    {
+        sqlite3* db;
+        assert(sqlite3_open(":memory:", &db) == SQLITE_OK);
+        assert(SQLiteStore::initializeDatabase(db));
+        HashOptions legacyHash{32, 0};
+        {
+            SymSpell spell(std::make_unique<SQLiteStore>(db, 2, 7), 2, 7, legacyHash);
+            spell.createDictionaryEntry("hello", 10);
+        }
+        assert(sqlite3_exec(db, "DROP TABLE symspell_metadata", nullptr, nullptr, nullptr) ==
+               SQLITE_OK);
+        {
+            SymSpell wrongHash(std::make_unique<SQLiteStore>(db, 2, 7), 2, 7);
+            wrongHash.createDictionaryEntry("world", 5);
+            assert(wrongHash.metadata().prefixLength == 0);
+        }
+        {
+            SymSpell spell(std::make_unique<SQLiteStore>(db, 2, 7), 2, 7, legacyHash);
+            assert(spell.metadata().prefixLength == 0 && spell.metadata().termCount == 2);
+            auto suggestions = spell.lookup("hellp", Verbosity::Closest);
+            assert(!suggestions.empty() && suggestions[0].term == "hello");
+            spell.recordBuildParameters();
+            assert(spell.metadata().prefixLength == 7);
+            assert(spell.metadata().hashOptions == legacyHash);
+
+            std::string message;
+            try {
+                SymSpell mismatched(std::make_unique<SQLiteStore>(db, 2, 7), 2, 7);
+            } catch (const std::invalid_argument& e) {
+                message = e.what();
+            }
+            assert(message.find("hash bits 32") != std::string::npos);
+            assert(message.find("encoding bytes") != std::string::npos);
+            SymSpell restored(std::make_unique<SQLiteStore>(db, 2, 7), 2, 7, legacyHash);
+            assert(restored.metadata().hashOptions == legacyHash);
+        }
+        sqlite3_close(db);
+    }
+
+    // A rollback leaves the written counts matching the rows that remain.
+    {
+        sqlite3* db;
+        assert(sqlite3_open(path, &db) == SQLITE_OK);
+        assert(SQLiteStore::initializeDatabase(db));
+        {
+            auto store = std::make_unique<SQLiteStore>(db, 2, 7);
+            auto* sqlite = store.get();
+            SymSpell spell(std::move(store), 2, 7);
+            spell.createDictionaryEntry("cat", 10);
+            sqlite->flushMetadata();
+            sqlite->beginTransaction();
+            spell.createDictionaryEntry("dog", 4);
+            spell.createDictionaryEntry("hippopotamus", 2);
+            sqlite->rollbackTransaction();
+            sqlite->flushMetadata();
+            assert(stored(db, "term_count") == 1);
+            spell.createDictionaryEntry("mouse", 3);
+        }
+        {
+            SymSpell reopened(std::make_unique<SQLiteStore>(db, 2, 7), 2, 7);
+            assert(reopened.metadata().termCount == 2);
+            assert(reopened.metadata().lengthHistogram[3] == 1);
+            assert(reopened.metadata().lengthHistogram[5] == 1);
+            assert(reopened.lookup("hipopotamus", Verbosity::All).empty());
+        }
+        sqlite3_close(db);
+    }
+    std::remove(path);
+
+    // Snapshots carry the same metadata, including the text encoding.
+    const char* snapshotPath = "/tmp/symspell_metadata_test.snap";
+    SymSpell built(std::make_unique<MemoryStore>(2, 7), 2, 7, {}, TextEncoding::Utf8);
+    built.createDictionaryEntry("caf\xC3\xA9", 3);
+    built.createDictionaryEntry("tea", 2);
+    built.createBigramEntry("caf\xC3\xA9", "tea", 1);
+    // A term with deletes but no frequency is no word and is not counted.
+    built.store().addDelete(1, "deletesonlyterm");
+    static_cast<MemoryStore&>(built.store()).freeze();
+    assert(writeSnapshot(built, snapshotPath));
+    auto opened = SnapshotStore::open(snapshotPath);
+    assert(opened);
+    assert(opened.value()->header().maxWordLength == 5);
+    SymSpell loaded(std::move(opened.value()), 2, 7, {}, TextEncoding::Utf8);
+    assert(loaded.metadata() == built.metadata());
+    assert(loaded.maxWordLength() == 5);
+    assert(loaded.minBigramCount() == 1);
+
+    auto reopened = SnapshotStore::open(snapshotPath);
+    assert(reopened);
+    bool threw = false;
+    try {
+        SymSpell bytes(std::move(reopened.value()), 2, 7);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    std::remove(snapshotPath);
+
+    std::cout << "PASSED" << std::endl;
+}
+
 void testConcurrentAccess() {
     std::cout << "Running testConcurrentAccess... " << std::flush;
 
@@ -261,6 +1311,1198 @@ void testConcurrentAccess() {
     std::cout << "PASSED" << std::endl;
 }
 
+void testLiveDictionary() {
+    std::cout << "Running testLiveDictionary... " << std::flush;
+
+    auto sorted = [](std::vector<Suggestion> suggestions) {
+        std::sort(suggestions.begin(), suggestions.end());
+        return suggestions;
+    };
+
+    // Published changes match a dictionary built directly, across overlays and compactions.
+    LiveDictionaryOptions options;
+    options.minCompactionTerms = 16;
+    LiveDictionary live(2, 7, options);
+    SymSpell reference(std::make_unique<MemoryStore>(2, 7), 2, 7);
+    auto pinned = live.snapshot();
+    std::mt19937 rng(7);
+    for (int round = 0; round < 12; ++round) {
+        for (int i = 0; i < 10; ++i) {
+            std::string word = "word" + std::to_string(rng() % 60);
+            int64_t count = 1 + rng() % 50;
+            live.createDictionaryEntry(word, count);
+            reference.createDictionaryEntry(word, count);
+        }
+        std::string victim = "word" + std::to_string(rng() % 60);
+        assert(live.removeDictionaryEntry(victim) == reference.removeDictionaryEntry(victim));
+        uint64_t version = live.publish();
+        assert(version == static_cast<uint64_t>(round + 1));
+        for (std::string query : {"wrod1", "word22", "wodr4", "ward55"}) {
+            assert(sorted(live.lookup(query, Verbosity::All)) ==
+                   sorted(reference.lookup(query, Verbosity::All)));
+        }
+    }
+    auto stats = live.stats();
+    assert(stats.compactions > 0 && stats.pendingChanges == 0);
+    assert(pinned->lookup("word1", Verbosity::All).empty()); // Old snapshots do not change.
+
+    // Staged changes stay invisible until publish(); compact() folds the overlay into the base.
+    assert(live.createDictionaryEntry("zebra", 5));
+    assert(live.lookup("zebra", Verbosity::Top).empty());
+    assert(live.publish() == stats.version + 1);
+    assert(live.lookup("zebra", Verbosity::Top)[0].frequency == 5);
+    assert(live.publish() == stats.version + 1);
+    live.compact();
+    stats = live.stats();
+    assert(stats.overlayTerms == 0 && live.base()->terms().find("zebra"));
+
+    // Readers keep running against consistent snapshots while a writer publishes.
+    std::atomic<bool> done{false};
+    std::vector<std::thread> readers;
+    std::atomic<size_t> lookups{0};
+    for (int t = 0; t < 3; ++t) {
+        readers.emplace_back([&]() {
+            LookupContext context;
+            while (!done.load()) {
+                auto snapshot = live.snapshot();
+                auto first = snapshot->lookup("zebra", context, Verbosity::Top);
+                assert(first.size() == 1 && first[0].term == "zebra");
+                int64_t frequency = first[0].frequency;
+                assert(snapshot->lookup("zebra", context, Verbosity::Top)[0].frequency ==
+                       frequency);
+                lookups.fetch_add(1);
+            }
+        });
+    }
+    for (int i = 0; i < 40; ++i) {
+        live.createDictionaryEntry("zebra", 1);
+        live.createDictionaryEntry("live" + std::to_string(i), 3);
+        live.publish();
+    }
+    while (lookups.load() < 100) {
+        std::this_thread::yield();
+    }
+    done.store(true);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    assert(live.lookup("zebra", Verbosity::Top)[0].frequency == 45);
+    assert(live.lookup("live39", Verbosity::Top)[0].frequency == 3);
+
+    // A dictionary built up front can go live as the base once frozen.
+    auto builder = std::make_shared<SymSpell>(std::make_unique<MemoryStore>(2, 7), 2, 7);
+    builder->createDictionaryEntry("hello", 10);
+    auto base = std::shared_ptr<MemoryStore>(builder, &static_cast<MemoryStore&>(builder->store()));
+    bool threw = false;
+    try {
+        LiveDictionary unfrozen(base);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    base->freeze();
+    LiveDictionary fromBase(base);
+    fromBase.createDictionaryEntry("help", 20);
+    fromBase.publish();
+    auto suggestions = fromBase.lookup("hellp", Verbosity::All);
+    assert(suggestions.size() == 2 && fromBase.stats().baseTerms == 1);
+
+    // Bigram entries of the base survive compaction as frequencies, without deletes.
+    auto bigramBuilder = std::make_shared<SymSpell>(std::make_unique<MemoryStore>(2, 7), 2, 7);
+    bigramBuilder->createDictionaryEntry("cat", 10);
+    bigramBuilder->createBigramEntry("cat", "horse", 7);
+    auto& bigramStore = static_cast<MemoryStore&>(bigramBuilder->store());
+    bigramStore.freeze();
+    LiveDictionary withBigrams(std::shared_ptr<MemoryStore>(bigramBuilder, &bigramStore));
+    assert(!withBigrams.createDictionaryEntry(SymSpell::bigramKey("cat", "dog"), 3));
+    withBigrams.createDictionaryEntry("horse", 5);
+    withBigrams.compact();
+    assert(withBigrams.stats().compactions == 1);
+    assert(withBigrams.snapshot()->bigramFrequency("cat", "horse") == 7);
+    assert(!withBigrams.snapshot()->bigramFrequency("cat", "dog"));
+    for (const auto& suggestion : withBigrams.lookup("cathorse", Verbosity::All)) {
+        assert(!SymSpell::isBigramKey(suggestion.term));
+    }
+    assert(withBigrams.lookup("cathorse", Verbosity::All).empty());
+
+    // Snapshots know the longest live word, so long inputs are pruned as in a plain SymSpell.
+    assert(withBigrams.snapshot()->maxWordLength() == 5);
+    assert(withBigrams.snapshot()->metadata().termCount == 2);
+    assert(withBigrams.snapshot()->minBigramCount() == 7);
+    withBigrams.createDictionaryEntry("hippopotamus", 2);
+    withBigrams.removeDictionaryEntry("cat");
+    withBigrams.publish();
+    auto published = withBigrams.snapshot();
+    assert(published->maxWordLength() == 12 && published->metadata().termCount == 2);
+    assert(published->metadata().lengthHistogram[5] == 1);
+    assert(published->metadata().lengthHistogram[3] == 0);
+    withBigrams.removeDictionaryEntry("hippopotamus");
+    withBigrams.publish();
+    assert(withBigrams.snapshot()->maxWordLength() == 5);
+    assert(withBigrams.lookup("hippopotamus", Verbosity::All).empty());
+
+    std::cout << "PASSED" << std::endl;
+}
+
+void testLookupAsync() {
+    std::cout << "Running testLookupAsync... " << std::flush;
+
+    auto sorted = [](std::vector<Suggestion> suggestions) {
+        std::sort(suggestions.begin(), suggestions.end());
+        return suggestions;
+    };
+    std::vector<std::pair<std::string, int64_t>> entries;
+    for (int i = 0; i < 200; ++i) {
+        entries.emplace_back("word" + std::to_string(i), 100 + (i * 37) % 500);
+    }
+    entries.emplace_back("hello", 1000);
+    entries.emplace_back("help", 500);
+
+    // A synchronous store completes the task without suspending.
+    SymSpell plain(std::make_unique<MemoryStore>(2, 7), 2, 7);
+    plain.createDictionary(entries);
+    assert(syncWait(plain.lookupAsync("hellp")) == plain.lookup("hellp"));
+
+    // Offloaded probes resume on the worker threads and give the same answers.
+    auto offload = std::make_unique<OffloadStore>(std::make_unique<MemoryStore>(2, 7), 2);
+    SymSpell spell(std::move(offload), 2, 7);
+    spell.createDictionary(entries);
+    LookupContext context;
+    for (std::string query : {"hellp", "wrod17", "word2", "wodr123", "hello", "zzzzzz"}) {
+        for (Verbosity verbosity : {Verbosity::Top, Verbosity::Closest, Verbosity::All}) {
+            auto expected = plain.lookup(query, verbosity);
+            auto results = syncWait(spell.lookupAsync(query, context, verbosity));
+            std::vector<Suggestion> copied(results.begin(), results.end());
+            if (verbosity == Verbosity::All) {
+                assert(sorted(copied) == sorted(expected));
+            } else {
+                assert(copied == expected);
+            }
+        }
+    }
+
+    // Lookups started from several threads overlap on the pool, with and without the cache.
+    for (bool cached : {false, true}) {
+        if (cached) {
+            spell.enableLookupCache(64);
+        }
+        std::vector<std::thread> threads;
+        std::atomic<int> mismatches{0};
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&, t]() {
+                for (int i = 0; i < 20; ++i) {
+                    std::string query = "wrod" + std::to_string((t * 20 + i) % 50);
+                    auto results = syncWait(spell.lookupAsync(query, Verbosity::All));
+                    if (sorted(results) != sorted(plain.lookup(query, Verbosity::All))) {
+                        mismatches.fetch_add(1);
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        assert(mismatches.load() == 0);
+    }
+    assert(spell.lookupCacheStats().hits > 0);
+
+    // Store failures reach the awaiter.
+    struct FailingStore : MemoryStore {
+        void visitTermsMulti(std::span<const DeleteHash>, MultiTermVisitor) override {
+            throw std::runtime_error("probe failed");
+        }
+    };
+    SymSpell failing(std::make_unique<OffloadStore>(std::make_unique<FailingStore>(), 1), 2, 7);
+    failing.createDictionaryEntry("hello", 10);
+    bool threw = false;
+    try {
+        syncWait(failing.lookupAsync("hellp"));
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::cout << "PASSED" << std::endl;
+}
+
+void testLookupBatch() {
+    std::cout << "Running testLookupBatch... " << std::flush;
+
+    auto store = std::make_unique<MemoryStore>(2, 7);
+    SymSpell spell(std::move(store), 2, 7);
+    for (int i = 0; i < 1000; ++i) {
+        spell.createDictionaryEntry("word" + std::to_string(i), 100 + i % 13);
+    }
+
+    std::vector<std::string> owned;
+    for (int i = 0; i < 400; ++i) {
+        owned.push_back("wrod" + std::to_string(i % 150));
+    }
+    owned.push_back("");
+    owned.push_back("word7");
+    std::vector<std::string_view> inputs(owned.begin(), owned.end());
+
+    BatchOptions options;
+    options.threads = 4;
+    options.minInputsPerThread = 1;
+
+    for (auto mode : {Verbosity::Top, Verbosity::Closest, Verbosity::All}) {
+        auto batch = spell.lookupBatch(inputs, mode, -1, options);
+        assert(batch.size() == inputs.size());
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            assert(batch[i] == spell.lookup(inputs[i], mode));
+        }
+    }
+
+    auto serial = spell.lookupBatch(inputs, Verbosity::Closest, 1, BatchOptions{1, 16});
+    assert(serial[0] == spell.lookup(inputs[0], Verbosity::Closest, 1));
+    assert(spell.lookupBatch({}, Verbosity::Closest).empty());
+
+    std::cout << "PASSED" << std::endl;
+}
+
+void testBulkBuild() {
+    std::cout << "Running testBulkBuild... " << std::flush;
+
+    std::vector<std::pair<std::string, int64_t>> words;
+    for (int i = 0; i < 2000; ++i) {
+        words.emplace_back("term" + std::to_string(i * 7919 % 5000), 1 + i % 5);
+    }
+    words.emplace_back("term0", 3); // Duplicate terms accumulate.
+    words.emplace_back("rare", 1);
+
+    SymSpell incremental(std::make_unique<MemoryStore>(2, 7), 2, 7);
+    SymSpell bulk(std::make_unique<MemoryStore>(2, 7), 2, 7);
+    incremental.setCountThreshold(2);
+    bulk.setCountThreshold(2);
+    for (const auto& [term, count] : words) {
+        incremental.createDictionaryEntry(term, count);
+    }
+    size_t added = bulk.createDictionary(words, BuildOptions{4});
+    assert(added > 0);
+    assert(bulk.maxWordLength() == incremental.maxWordLength());
+
+    for (const auto& input : {"term12", "trem12", "term", "tem0", "rare", "termm4999"}) {
+        // Bucket order may differ, so compare results independent of tie order.
+        for (auto mode : {Verbosity::Closest, Verbosity::All}) {
+            auto expected = incremental.lookup(input, mode);
+            auto actual = bulk.lookup(input, mode);
+            std::sort(expected.begin(), expected.end());
+            std::sort(actual.begin(), actual.end());
+            assert(actual == expected);
+        }
+        auto expectedTop = incremental.lookup(input, Verbosity::Top);
+        auto actualTop = bulk.lookup(input, Verbosity::Top);
+        assert(actualTop.size() == expectedTop.size());
+        if (!actualTop.empty()) {
+            assert(actualTop[0].distance == expectedTop[0].distance);
+            assert(actualTop[0].frequency == expectedTop[0].frequency);
+        }
+    }
+
+    // Staged below-threshold counts carry over into later builds, as with createDictionaryEntry.
+    assert(bulk.lookup("rare", Verbosity::Top).empty());
+    assert(bulk.createDictionary(std::vector<std::pair<std::string, int64_t>>{{"rare", 1}}) == 1);
+    auto rare = bulk.lookup("rare", Verbosity::Top);
+    assert(rare.size() == 1 && rare[0].frequency == 2);
+
+    std::istringstream file("apple 10\nbanana\t20\n\nbad line\napple 5\n");
+    SymSpell fromFile(std::make_unique<MemoryStore>(2, 7), 2, 7);
+    assert(fromFile.createDictionary(file) == 2);
+    auto apple = fromFile.lookup("aple", Verbosity::Top);
+    assert(apple.size() == 1 && apple[0].term == "apple" && apple[0].frequency == 15);
+
+    std::cout << "PASSED" << std::endl;
+}
+
+void testHashOptions() {
+    std::cout << "Running testHashOptions... " << std::flush;
+
+    // Checks that bulk builds hand their postings over in hash order.
+    class OrderCheckingStore : public MemoryStore {
+    public:
+        using MemoryStore::MemoryStore;
+        void addDeletes(std::span<const std::string_view> terms,
+                        std::span<const DeletePosting> postings) override {
+            sorted = sorted && std::is_sorted(postings.begin(), postings.end(),
+                                              [](const DeletePosting& a, const DeletePosting& b) {
+                                                  return a.hash < b.hash;
+                                              });
+            MemoryStore::addDeletes(terms, postings);
+        }
+        bool sorted = true;
+    };
+
+    std::vector<std::pair<std::string, int64_t>> words;
+    for (int i = 0; i < 2000; ++i) {
+        words.emplace_back("term" + std::to_string(i * 7919 % 5000), 1 + i % 50);
+    }
+    auto sorted = [](std::vector<Suggestion> suggestions) {
+        std::sort(suggestions.begin(), suggestions.end());
+        return suggestions;
+    };
+
+    SymSpell reference(std::make_unique<MemoryStore>(2, 7), 2, 7);
+    reference.createDictionary(words);
+    size_t fullBuckets = static_cast<MemoryStore&>(reference.store()).bucketCount();
+
+    for (HashOptions options : {HashOptions{64, 0}, HashOptions{32, 0}, HashOptions{64, 54},
+                                HashOptions{32, 22}}) {
+        auto store = std::make_unique<OrderCheckingStore>(2, 7);
+        auto* checked = store.get();
+        SymSpell spell(std::move(store), 2, 7, options);
+        spell.createDictionary(words, BuildOptions{4});
+        assert(checked->sorted);
+        assert(spell.hashOptions().bits == options.bits);
+
+        LookupContext context;
+        for (std::string query : {"trem12", "term", "tem0", "termm4999", "xyz"}) {
+            auto results = spell.lookup(query, context, Verbosity::All);
+            assert(sorted({results.begin(), results.end()}) ==
+                   sorted(reference.lookup(query, Verbosity::All)));
+        }
+        const auto& stats = context.probeStats();
+        assert(stats.rows > 0 && stats.collisions < stats.rows);
+        if (options.compactLevel > 0) {
+            // Fewer buckets, each shared by unrelated deletes that lookups filter out.
+            assert(checked->bucketCount() < fullBuckets / 4);
+            assert(stats.collisions > 0);
+        } else {
+            assert(checked->bucketCount() == fullBuckets);
+        }
+        context.resetProbeStats();
+        assert(context.probeStats().rows == 0);
+    }
+
+    // The 32-bit hash reproduces the keys of indexes built before hashes were widened.
+    SymSpell legacy(std::make_unique<MemoryStore>(0, 7), 0, 7, HashOptions{32, 0});
+    legacy.createDictionaryEntry("abc", 1);
+    assert(legacy.store().getTerms(0x1A47E90B) == std::vector<std::string>{"abc"});
+
+    // Snapshots record the options for readers.
+    const char* path = "/tmp/symspell_hash_test.snap";
+    SymSpell compacted(std::make_unique<MemoryStore>(2, 7), 2, 7, HashOptions{64, 40});
+    compacted.createDictionary(words);
+    auto& built = static_cast<MemoryStore&>(compacted.store());
+    built.freeze();
+    assert(writeSnapshot(built, path, compacted.hashOptions()));
+    auto opened = SnapshotStore::open(path);
+    assert(opened);
+    assert(opened.value()->hashOptions().bits == 64);
+    assert(opened.value()->hashOptions().compactLevel == 40);
+    SymSpell reader(std::move(opened.value()), 2, 7, HashOptions{64, 40});
+    assert(sorted(reader.lookup("trem12", Verbosity::All)) ==
+           sorted(reference.lookup("trem12", Verbosity::All)));
+    std::remove(path);
+
+    for (HashOptions invalid : {HashOptions{48, 0}, HashOptions{32, 25}, HashOptions{64, -1}}) {
+        bool threw = false;
+        try {
+            SymSpell rejected(std::make_unique<MemoryStore>(2, 7), 2, 7, invalid);
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        assert(threw);
+    }
+
+    std::cout << "PASSED" << std::endl;
+}
+
+void testPrefixLength() {
+    std::cout << "Running testPrefixLength... " << std::flush;
+
+    // Terms longer than 7 letters still match inside a longer prefix.
+    SymSpell longPrefix(std::make_unique<MemoryStore>(1, 10), 1, 10);
+    longPrefix.createDictionaryEntry("abcdefghij", 5);
+    auto found = longPrefix.lookup("abcdefghxj", Verbosity::Top);
+    assert(found.size() == 1 && found[0].term == "abcdefghij" && found[0].distance == 1);
+
+    // The specialised delete generators of (1, 7), (2, 7) and (3, 8) against the generic one:
+    // words no longer than 7 letters have the same deletes under a 9-letter prefix.
+    std::vector<std::pair<std::string, int64_t>> words;
+    for (int i = 0; i < 500; ++i) {
+        words.emplace_back("w" + std::to_string(i * 7919 % 100000), 1 + i % 7);
+    }
+    words.emplace_back("aa", 2);
+    words.emplace_back("aaab", 3);
+    auto sorted = [](std::vector<Suggestion> suggestions) {
+        std::sort(suggestions.begin(), suggestions.end());
+        return suggestions;
+    };
+    for (auto [maxEdit, prefix] : {std::pair{1, 7}, std::pair{2, 7}, std::pair{3, 8}}) {
+        SymSpell fixed(std::make_unique<MemoryStore>(maxEdit, prefix), maxEdit, prefix);
+        SymSpell generic(std::make_unique<MemoryStore>(maxEdit, 9), maxEdit, 9);
+        SymSpell fixedBulk(std::make_unique<MemoryStore>(maxEdit, prefix), maxEdit, prefix);
+        for (const auto& [term, count] : words) {
+            fixed.createDictionaryEntry(term, count);
+            generic.createDictionaryEntry(term, count);
+        }
+        fixedBulk.createDictionary(words);
+        size_t buckets = static_cast<MemoryStore&>(generic.store()).bucketCount();
+        assert(static_cast<MemoryStore&>(fixed.store()).bucketCount() == buckets);
+        assert(static_cast<MemoryStore&>(fixedBulk.store()).bucketCount() == buckets);
+        for (std::string query : {"w7919", "w791", "w17", "a", "aab", "xaaabx"}) {
+            auto expected = sorted(generic.lookup(query, Verbosity::All));
+            assert(sorted(fixed.lookup(query, Verbosity::All)) == expected);
+            assert(sorted(fixedBulk.lookup(query, Verbosity::All)) == expected);
+        }
+        // Removal regenerates the same deletes.
+        assert(fixed.removeDictionaryEntry("aaab"));
+        assert(generic.removeDictionaryEntry("aaab"));
+        assert(static_cast<MemoryStore&>(fixed.store()).bucketCount() ==
+               static_cast<MemoryStore&>(generic.store()).bucketCount());
+    }
+
+    std::cout << "PASSED" << std::endl;
+}
+
+void testMetrics() {
+    std::cout << "Running testMetrics... " << std::flush;
+
+    std::vector<std::pair<std::string, int64_t>> words;
+    for (int i = 0; i < 500; ++i) {
+        words.emplace_back("term" + std::to_string(i * 7919 % 2000), 1 + i % 9);
+    }
+    SymSpell spell(std::make_unique<MemoryStore>(2, 7), 2, 7);
+    spell.createDictionary(words);
+    auto& memory = static_cast<MemoryStore&>(spell.store());
+
+    // The histogram is computed from the index, so it is available in every build.
+    auto countBuckets = [](const std::vector<size_t>& histogram) {
+        size_t total = 0;
+        for (size_t count : histogram) {
+            total += count;
+        }
+        return total;
+    };
+    assert(countBuckets(memory.bucketSizeHistogram()) == memory.bucketCount());
+
+    LookupContext context;
+    spell.lookup("trem12", context, Verbosity::All);
+    spell.lookup("term", context, Verbosity::Closest);
+    const LookupStats& stats = context.lookupStats();
+    StoreMetrics storeMetrics = memory.metrics();
+    if constexpr (kMetricsEnabled) {
+        assert(stats.lookups == 2 && stats.cacheHits == 0);
+        assert(stats.candidates > 2 && stats.probes >= 2);
+        assert(stats.bucketsProbed <= stats.candidates);
+        assert(stats.termsScanned == storeMetrics.rowsReturned && stats.termsScanned > 0);
+        assert(stats.distanceComputations > 0 && stats.prefixRejects > 0);
+        assert(stats.generateTime.count() > 0 && stats.probeTime.count() > 0);
+        assert(storeMetrics.probes == stats.probes);
+        assert(storeMetrics.bucketsProbed == stats.bucketsProbed);
+
+        spell.enableLookupCache(16);
+        context.resetLookupStats();
+        spell.lookup("trem12", context, Verbosity::All);
+        spell.lookup("trem12", context, Verbosity::All);
+        assert(context.lookupStats().lookups == 2 && context.lookupStats().cacheHits == 1);
+    } else {
+        assert(stats.lookups == 0 && stats.termsScanned == 0 && stats.probeTime.count() == 0);
+        assert(storeMetrics.probes == 0 && storeMetrics.rowsReturned == 0);
+    }
+    context.resetLookupStats();
+    memory.resetMetrics();
+    assert(context.lookupStats().lookups == 0 && memory.metrics().probes == 0);
+
+    sqlite3* db;
+    int rc = sqlite3_open(":memory:", &db);
+    assert(rc == SQLITE_OK);
+    assert(SQLiteStore::initializeDatabase(db));
+    {
+        SymSpell persisted(std::make_unique<SQLiteStore>(db, 2, 7), 2, 7);
+        persisted.createDictionary(words);
+        auto& sqlite = static_cast<SQLiteStore&>(persisted.store());
+        sqlite.resetMetrics();
+        LookupContext sqliteContext;
+        persisted.lookup("trem12", sqliteContext, Verbosity::All);
+        StoreMetrics sqliteMetrics = sqlite.metrics();
+        if constexpr (kMetricsEnabled) {
+            assert(sqliteMetrics.probes == sqliteContext.lookupStats().probes);
+            assert(sqliteMetrics.rowsReturned == sqliteContext.lookupStats().termsScanned);
+            assert(sqliteMetrics.stepTime.count() > 0);
+        } else {
+            assert(sqliteMetrics.probes == 0 && sqliteMetrics.stepTime.count() == 0);
+        }
+    }
+    sqlite3_close(db);
+
+    std::cout << "PASSED" << std::endl;
+}
+
+void testMemoryUsage() {
+    std::cout << "Running testMemoryUsage... " << std::flush;
+
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::uniform_int_distribution<int> length(4, 10);
+    std::vector<std::string> words;
+    while (words.size() < 8000) {
+        std::string word(static_cast<size_t>(length(rng)), 'a');
+        for (char& c : word) {
+            c = static_cast<char>(letter(rng));
+        }
+        words.push_back(std::move(word));
+    }
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+    std::shuffle(words.begin(), words.end(), rng);
+    std::vector<std::string_view> views(words.begin(), words.end());
+    size_t chars = 0;
+    for (const auto& word : words) {
+        chars += word.size();
+    }
+
+    SymSpell spell(std::make_unique<MemoryStore>(2, 7), 2, 7);
+    for (const auto& word : words) {
+        spell.createDictionaryEntry(word, 10);
+    }
+    auto& store = static_cast<MemoryStore&>(spell.store());
+    MemoryUsage building = store.memoryUsage();
+    assert(building.termBytes >= chars + words.size() * sizeof(int64_t));
+    assert(building.deleteIndexBytes > 0 && building.hashTableBytes > 0);
+    assert(building.total() ==
+           building.termBytes + building.deleteIndexBytes + building.hashTableBytes);
+
+    store.freeze();
+    MemoryUsage frozen = store.memoryUsage();
+    size_t postings = store.deleteIndex().ids().size();
+    assert(frozen.deleteIndexBytes == postings * sizeof(TermId));
+    assert(frozen.total() < building.total());
+
+    // The whole word list as the sample reproduces the counts of the built index.
+    FootprintEstimate exact = SymSpell::estimateFootprint(views, views.size(), 2, 7);
+    assert(exact.postings == postings);
+    assert(exact.buckets == store.bucketCount());
+    assert(exact.frozen.deleteIndexBytes == frozen.deleteIndexBytes);
+    assert(exact.frozen.hashTableBytes == frozen.hashTableBytes);
+
+    // A quarter sample predicts the full index within a few percent.
+    auto within = [](double estimate, double actual, double tolerance) {
+        return std::abs(estimate - actual) <= actual * tolerance;
+    };
+    FootprintEstimate sampled = SymSpell::estimateFootprint(
+        std::span<const std::string_view>(views).first(views.size() / 4), views.size(), 2, 7);
+    assert(sampled.words == views.size());
+    assert(within(static_cast<double>(sampled.postings), static_cast<double>(postings), 0.05));
+    assert(within(static_cast<double>(sampled.buckets), static_cast<double>(store.bucketCount()),
+                  0.15));
+    assert(within(static_cast<double>(sampled.frozen.total()), static_cast<double>(frozen.total()),
+                  0.25));
+    assert(within(static_cast<double>(sampled.building.total()),
+                  static_cast<double>(building.total()), 0.35));
+    assert(SymSpell::estimateFootprint({}, 1000).postings == 0);
+
+    // Snapshots map the same sections.
+    const char* path = "/tmp/symspell_memory_test.snap";
+    assert(writeSnapshot(store, path));
+    auto opened = SnapshotStore::open(path);
+    assert(opened);
+    MemoryUsage mapped = opened.value()->memoryUsage();
+    assert(mapped.deleteIndexBytes == frozen.deleteIndexBytes);
+    assert(mapped.hashTableBytes == frozen.hashTableBytes);
+    std::remove(path);
+
+    std::cout << "PASSED" << std::endl;
+}
+
+void testDictionaryLoader() {
+    std::cout << "Running testDictionaryLoader... " << std::flush;
+
+    auto frequency = [](SymSpell& spell, std::string_view term) {
+        return spell.store().getFrequency(term).value_or(0);
+    };
+
+    // Frequency text parses like createDictionary(std::istream&), at any chunk size.
+    const std::string text = "apple 10\nbanana\t20\r\n\nbad line\n  apple 5  trailing\n"
+                             "cherry -3\nkiwi 0\ndate +7\nfig 12";
+    std::vector<std::unique_ptr<SymSpell>> spells;
+    for (int i = 0; i < 4; ++i) {
+        spells.push_back(std::make_unique<SymSpell>(std::make_unique<MemoryStore>(2, 7), 2, 7));
+    }
+    std::istringstream reference(text);
+    spells[0]->createDictionary(reference);
+    LoadStats stats = loadFrequencies(*spells[1], std::string_view(text));
+    assert(stats.termsAdded == 4 && stats.entries == 5 && stats.skipped == 3);
+    assert(stats.lines == 8 && stats.bytes == text.size());
+    for (size_t chunk : {size_t{1}, size_t{7}, size_t{4096}}) {
+        SymSpell streamed(std::make_unique<MemoryStore>(2, 7), 2, 7);
+        std::istringstream in(text);
+        LoadOptions options;
+        options.chunkBytes = chunk;
+        LoadStats chunked = loadFrequencies(streamed, in, options);
+        assert(chunked.termsAdded == 4 && chunked.entries == 5 && chunked.skipped == 3);
+        assert(chunked.bytes == text.size());
+        for (const char* term : {"apple", "banana", "date", "fig", "cherry", "kiwi"}) {
+            assert(frequency(streamed, term) == frequency(*spells[1], term));
+        }
+    }
+    for (const char* term : {"apple", "banana", "fig", "cherry", "kiwi"}) {
+        assert(frequency(*spells[0], term) == frequency(*spells[1], term));
+    }
+    assert(frequency(*spells[1], "apple") == 15 && frequency(*spells[1], "date") == 7);
+    auto apple = spells[1]->lookup("aple", Verbosity::Top);
+    assert(apple.size() == 1 && apple[0].term == "apple");
+
+    // Corpora count every token once, with createDictionaryEntry's threshold semantics.
+    const std::string corpus = "The cat's hat, the CAT-dog; the_end \xC3\xA9t\xC3\xA9 "
+                               "\xC3\xA9t\xC3\xA9. 42 42 cat";
+    SymSpell perToken(std::make_unique<MemoryStore>(2, 7), 2, 7);
+    perToken.setCountThreshold(2);
+    for (const char* token : {"the", "cat's", "hat", "the", "cat", "dog", "the", "end",
+                              "\xC3\xA9t\xC3\xA9", "\xC3\xA9t\xC3\xA9", "42", "42",
+                              "cat"}) {
+        perToken.createDictionaryEntry(token);
+    }
+    SymSpell counted(std::make_unique<MemoryStore>(2, 7), 2, 7);
+    counted.setCountThreshold(2);
+    LoadStats corpusStats = loadCorpus(counted, std::string_view(corpus));
+    assert(corpusStats.tokens == 13 && corpusStats.entries == 8);
+    assert(corpusStats.termsAdded == 4);
+    const char* corpusTerms[] = {"the", "cat", "42", "\xC3\xA9t\xC3\xA9", "hat", "dog", "end"};
+    for (const char* term : corpusTerms) {
+        assert(frequency(counted, term) == frequency(perToken, term));
+    }
+    assert(frequency(counted, "the") == 3 && frequency(counted, "hat") == 0);
+    // Staged counts carry over into the next load.
+    assert(loadCorpus(counted, std::string_view("hat")).termsAdded == 1);
+    assert(frequency(counted, "hat") == 2);
+
+    for (size_t chunk : {size_t{1}, size_t{5}, size_t{1024}}) {
+        SymSpell streamed(std::make_unique<MemoryStore>(2, 7), 2, 7);
+        streamed.setCountThreshold(2);
+        std::istringstream in(corpus);
+        LoadOptions options;
+        options.chunkBytes = chunk;
+        LoadStats chunked = loadCorpus(streamed, in, options);
+        assert(chunked.tokens == 13 && chunked.entries == 8 && chunked.termsAdded == 4);
+        for (const char* term : corpusTerms) {
+            assert(frequency(streamed, term) == frequency(perToken, term));
+        }
+    }
+    SymSpell caseKept(std::make_unique<MemoryStore>(2, 7), 2, 7);
+    LoadOptions keepCase;
+    keepCase.lowercase = false;
+    loadCorpus(caseKept, std::string_view(corpus), keepCase);
+    assert(frequency(caseKept, "The") == 1 && frequency(caseKept, "CAT") == 1);
+
+    // Files go through the mapping; missing files are reported.
+    const char* path = "/tmp/symspell_loader_test.txt";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << text;
+    }
+    auto fromFile = loadFrequencyFile(*spells[2], path);
+    assert(fromFile && fromFile.value().termsAdded == 4 && fromFile.value().bytes == text.size());
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << corpus;
+    }
+    spells[3]->setCountThreshold(2);
+    auto corpusFile = loadCorpusFile(*spells[3], path);
+    assert(corpusFile && corpusFile.value().tokens == 13);
+    for (const char* term : corpusTerms) {
+        assert(frequency(*spells[3], term) == frequency(perToken, term));
+    }
+    for (const char* term : {"apple", "banana", "date", "fig"}) {
+        assert(frequency(*spells[2], term) == frequency(*spells[1], term));
+    }
+    std::remove(path);
+    auto missing = loadFrequencyFile(*spells[2], "/tmp/does_not_exist.txt");
+    assert(!missing && missing.error().code == ErrorCode::IoError);
+    assert(!loadCorpusFile(*spells[2], "/tmp/does_not_exist.txt"));
+
+    std::cout << "PASSED" << std::endl;
+}
+
+void testLookupCache() {
+    std::cout << "Running testLookupCache... " << std::flush;
+
+    SymSpell spell(std::make_unique<MemoryStore>(2, 7), 2, 7);
+    spell.createDictionaryEntry("hello", 1000);
+    spell.createDictionaryEntry("help", 100);
+
+    auto uncached = spell.lookup("hellp", Verbosity::All);
+    spell.enableLookupCache(64, 4);
+
+    assert(spell.lookup("hellp", Verbosity::All) == uncached);
+    assert(spell.lookup("hellp", Verbosity::All) == uncached);
+    // -1 and the configured maximum share an entry; other verbosities do not.
+    assert(spell.lookup("hellp", Verbosity::All, 2) == uncached);
+    assert(spell.lookup("hellp", Verbosity::Top).size() == 1);
+
+    auto stats = spell.lookupCacheStats();
+    assert(stats.hits == 2 && stats.misses == 2 && stats.size == 2);
+
+    // Dictionary changes retire cached results.
+    spell.createDictionaryEntry("helps", 50);
+    auto updated = spell.lookup("hellp", Verbosity::All);
+    assert(updated.size() == uncached.size() + 1);
+    assert(spell.lookupCacheStats().misses == 3);
+    spell.createDictionaryEntry("hello", 1);
+    auto top = spell.lookup("hellp", Verbosity::Top);
+    assert(top[0].term == "hello" && top[0].frequency == 1001);
+
+    // The cache stays bounded and serves concurrent batches.
+    std::vector<std::string> owned;
+    for (int i = 0; i < 500; ++i) {
+        owned.push_back("input" + std::to_string(i % 200));
+    }
+    std::vector<std::string_view> inputs(owned.begin(), owned.end());
+    auto batch = spell.lookupBatch(inputs, Verbosity::Closest, -1, BatchOptions{4, 1});
+    auto again = spell.lookupBatch(inputs, Verbosity::Closest, -1, BatchOptions{4, 1});
+    assert(batch == again);
+    stats = spell.lookupCacheStats();
+    assert(stats.size <= 64 && stats.evictions > 0);
+
+    LookupContext context;
+    spell.lookup("hellp", context, Verbosity::Closest);
+    auto cached = spell.lookup("hellp", context, Verbosity::Closest);
+    assert(cached.size() == 2 && cached[0].term == "hello");
+
+    spell.enableLookupCache(0);
+    assert(spell.lookupCacheStats().hits == 0);
+
+    std::cout << "PASSED" << std::endl;
+}
+
+void testTieredStore() {
+    std::cout << "Running testTieredStore... " << std::flush;
+
+    auto counting = std::make_unique<ProbeCountingStore>();
+    auto* probes = counting.get();
+    auto tiered = std::make_unique<TieredStore>(std::move(counting));
+    auto* cache = tiered.get();
+    SymSpell spell(std::move(tiered), 2, 7);
+    SymSpell reference(std::make_unique<MemoryStore>(2, 7), 2, 7);
+    for (int i = 0; i < 200; ++i) {
+        spell.createDictionaryEntry("word" + std::to_string(i), 100 + i);
+        reference.createDictionaryEntry("word" + std::to_string(i), 100 + i);
+    }
+
+    auto expected = reference.lookup("wrod17", Verbosity::All);
+    std::sort(expected.begin(), expected.end());
+    auto first = spell.lookup("wrod17", Verbosity::All);
+    std::sort(first.begin(), first.end());
+    assert(first == expected);
+
+    // The second lookup is served from the hot set without touching the backing store.
+    int multiProbes = probes->multiProbes;
+    probes->frequencyLookups = 0;
+    auto second = spell.lookup("wrod17", Verbosity::All);
+    std::sort(second.begin(), second.end());
+    assert(second == expected);
+    assert(probes->multiProbes == multiProbes);
+    assert(probes->frequencyLookups <= 1); // Only the absent input itself.
+    auto stats = cache->stats();
+    assert(stats.bucketHits > 0 && stats.cachedBuckets > 0 && stats.cachedTerms > 0);
+    assert(cache->getFrequency("word17") == 117);
+    assert(probes->frequencyLookups <= 1);
+
+    // Writes go through and retire the buckets they touch.
+    spell.createDictionaryEntry("wrod", 5);
+    assert(probes->getFrequency("wrod") == 5);
+    auto updated = spell.lookup("wrod17", Verbosity::All);
+    assert(updated.size() == expected.size() + 1);
+    spell.createDictionaryEntry("word17", 3);
+    assert(cache->getFrequency("word17") == 120);
+    assert(cache->getTerms(0x7fffffff).empty());
+
+    // A one-bucket cache keeps the frequently probed bucket over a stream of one-off probes.
+    MemoryStore* backing = nullptr;
+    {
+        auto memory = std::make_unique<MemoryStore>(2, 7);
+        backing = memory.get();
+        TieredStore small(std::move(memory), TieredStoreOptions{160, 4, 1});
+        for (int hash = 0; hash < 50; ++hash) {
+            backing->addDelete(hash, "t" + std::to_string(hash));
+        }
+        for (int i = 0; i < 8; ++i) {
+            assert(small.getTerms(0) == std::vector<std::string>{"t0"});
+        }
+        for (int hash = 1; hash < 50; ++hash) {
+            assert(small.getTerms(hash).size() == 1);
+        }
+        uint64_t hits = small.stats().bucketHits;
+        small.getTerms(0);
+        stats = small.stats();
+        assert(stats.bucketHits == hits + 1);
+        assert(stats.cachedBuckets == 1 && stats.rejected > 0);
+
+        small.clearCache();
+        assert(small.stats().cachedBuckets == 0);
+    }
+
+    std::cout << "PASSED" << std::endl;
+}
+
+void testShardedStore() {
+    std::cout << "Running testShardedStore... " << std::flush;
+
+    auto makeShards = [](size_t count) {
+        std::vector<std::unique_ptr<ISymSpellStore>> shards;
+        for (size_t i = 0; i < count; ++i) {
+            shards.push_back(std::make_unique<MemoryStore>(2, 7));
+        }
+        return shards;
+    };
+    auto sorted = [](std::vector<Suggestion> suggestions) {
+        std::sort(suggestions.begin(), suggestions.end());
+        return suggestions;
+    };
+
+    std::vector<std::pair<std::string, int64_t>> entries;
+    for (int i = 0; i < 300; ++i) {
+        entries.emplace_back("word" + std::to_string(i), 100 + (i * 37) % 500);
+    }
+    SymSpell reference(std::make_unique<MemoryStore>(2, 7), 2, 7);
+    reference.createDictionary(entries);
+    size_t referenceBuckets = static_cast<MemoryStore&>(reference.store()).bucketCount();
+
+    for (bool parallel : {true, false}) {
+        auto sharded = std::make_unique<ShardedStore>(makeShards(4),
+                                                      ShardedStoreOptions{parallel, 0});
+        auto* store = sharded.get();
+        SymSpell spell(std::move(sharded), 2, 7);
+        // Half through the bulk builder, half one entry at a time.
+        spell.createDictionary(std::span(entries).first(150));
+        for (const auto& [term, count] : std::span(entries).subspan(150)) {
+            spell.createDictionaryEntry(term, count);
+        }
+
+        size_t buckets = 0;
+        for (size_t i = 0; i < store->shardCount(); ++i) {
+            auto& shard = static_cast<MemoryStore&>(store->shard(i));
+            assert(shard.bucketCount() > 0 && shard.termCount() == entries.size());
+            buckets += shard.bucketCount();
+        }
+        assert(buckets == referenceBuckets);
+        // Neighbouring and sign-extended 32-bit hashes spread over every shard.
+        std::vector<size_t> spread(store->shardCount());
+        for (DeleteHash hash = -64; hash < 64; ++hash) {
+            ++spread[store->shardOf(hash)];
+        }
+        assert(std::all_of(spread.begin(), spread.end(), [](size_t n) { return n > 8; }));
+
+        for (std::string query : {"wrod17", "word2", "wodr123", "ward299", "hello"}) {
+            assert(sorted(spell.lookup(query, Verbosity::All)) ==
+                   sorted(reference.lookup(query, Verbosity::All)));
+            assert(spell.lookup(query, Verbosity::Closest) ==
+                   reference.lookup(query, Verbosity::Closest));
+            assert(spell.lookupTopK(query, 5) == reference.lookupTopK(query, 5));
+        }
+        std::vector<std::string> queries;
+        for (int i = 0; i < 40; ++i) {
+            queries.push_back("wrod" + std::to_string(i * 7));
+        }
+        std::vector<std::string_view> inputs(queries.begin(), queries.end());
+        auto batch = spell.lookupBatch(inputs, Verbosity::All, -1, BatchOptions{4, 1});
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            assert(sorted(batch[i]) == sorted(reference.lookup(inputs[i], Verbosity::All)));
+        }
+
+        spell.createDictionaryEntry("word17", 1000);
+        assert(spell.lookup("word17", Verbosity::Top)[0].frequency ==
+               reference.lookup("word17", Verbosity::Top)[0].frequency + 1000);
+        assert(spell.removeDictionaryEntry("word18"));
+        auto remaining = spell.lookup("wrod18", Verbosity::All);
+        assert(std::none_of(remaining.begin(), remaining.end(),
+                            [](const Suggestion& s) { return s.term == "word18"; }));
+    }
+
+    // Shards frozen by frequency keep the ordered top-k probe.
+    auto sharded = std::make_unique<ShardedStore>(makeShards(3));
+    auto* store = sharded.get();
+    SymSpell spell(std::move(sharded), 2, 7);
+    spell.createDictionary(entries);
+    for (size_t i = 0; i < store->shardCount(); ++i) {
+        static_cast<MemoryStore&>(store->shard(i)).freeze(BucketOrder::Frequency);
+    }
+    assert(store->bucketsOrderedByFrequency());
+    for (std::string query : {"wrod17", "word2", "wodr123"}) {
+        assert(spell.lookupTopK(query, 5) == reference.lookupTopK(query, 5));
+    }
+
+    bool threw = false;
+    try {
+        ShardedStore empty({});
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+
+    // SQLite shards record and check the build parameters like a single database.
+    std::vector<sqlite3*> dbs(2);
+    auto makeSQLiteShards = [&](int editDistance, int prefixLength) {
+        std::vector<std::unique_ptr<ISymSpellStore>> shards;
+        for (sqlite3* db : dbs) {
+            shards.push_back(std::make_unique<SQLiteStore>(db, editDistance, prefixLength));
+        }
+        return std::make_unique<ShardedStore>(std::move(shards));
+    };
+    for (sqlite3*& db : dbs) {
+        assert(sqlite3_open(":memory:", &db) == SQLITE_OK);
+        assert(SQLiteStore::initializeDatabase(db));
+    }
+    {
+        SymSpell built(makeSQLiteShards(2, 7), 2, 7);
+        built.createDictionary(std::span(entries).first(20));
+        built.createDictionaryEntry("hippopotamus", 5);
+    }
+    {
+        SymSpell reopened(makeSQLiteShards(2, 7), 2, 7);
+        assert(reopened.maxWordLength() == 12 && reopened.metadata().termCount == 21);
+        threw = false;
+        try {
+            SymSpell mismatched(makeSQLiteShards(2, 5), 2, 5);
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        assert(threw);
+    }
+    for (sqlite3* db : dbs) {
+        sqlite3_close(db);
+    }
+
+    std::cout << "PASSED" << std::endl;
+}
+
+void testTopK() {
+    std::cout << "Running testTopK... " << std::flush;
+
+    std::mt19937 rng(15);
+    std::uniform_int_distribution<int> letter(0, 5);
+    std::uniform_int_distribution<int> length(3, 9);
+    std::uniform_int_distribution<int64_t> count(1, 50);
+    std::vector<std::pair<std::string, int64_t>> words;
+    for (int i = 0; i < 3000; ++i) {
+        std::string word;
+        for (int n = length(rng); n > 0; --n) {
+            word.push_back(static_cast<char>('a' + letter(rng)));
+        }
+        words.emplace_back(word, count(rng));
+    }
+
+    auto plain = std::make_unique<MemoryStore>(2, 7);
+    auto ordered = std::make_unique<MemoryStore>(2, 7);
+    auto* orderedStore = ordered.get();
+    SymSpell spell(std::move(plain), 2, 7);
+    SymSpell orderedSpell(std::move(ordered), 2, 7);
+    spell.createDictionary(words);
+    orderedSpell.createDictionary(words);
+    assert(!orderedStore->bucketsOrderedByFrequency());
+    orderedStore->freeze(BucketOrder::Frequency);
+    assert(orderedStore->bucketsOrderedByFrequency());
+
+    // Ordered probes through the default visitTermsByFrequency() adapter.
+    auto tiered = std::make_unique<TieredStore>(std::make_unique<MemoryStore>(2, 7));
+    auto& tieredBacking = static_cast<MemoryStore&>(tiered->backing());
+    SymSpell tieredSpell(std::move(tiered), 2, 7);
+    tieredSpell.createDictionary(words);
+    tieredBacking.freeze(BucketOrder::Frequency);
+    assert(tieredSpell.store().bucketsOrderedByFrequency());
+
+    auto ranks = [](const std::vector<Suggestion>& results) {
+        std::vector<std::pair<int, int64_t>> out;
+        for (const auto& s : results) {
+            out.emplace_back(s.distance, s.frequency);
+        }
+        return out;
+    };
+
+    LookupContext context;
+    for (int i = 0; i < 200; ++i) {
+        std::string input = words[static_cast<size_t>(i) * 7].first;
+        input[static_cast<size_t>(i) % input.size()] = static_cast<char>('a' + (i % 7));
+        if (i % 3 == 0) {
+            input.push_back('b');
+        }
+
+        auto all = spell.lookup(input, Verbosity::All);
+        std::sort(all.begin(), all.end(), [](const Suggestion& a, const Suggestion& b) {
+            return a.distance != b.distance ? a.distance < b.distance : a.frequency > b.frequency;
+        });
+        for (size_t k : {size_t{1}, size_t{3}, size_t{5}}) {
+            std::vector<Suggestion> expected(all.begin(),
+                                             all.begin() + std::min(k, all.size()));
+            auto topK = spell.lookupTopK(input, k);
+            assert(ranks(topK) == ranks(expected));
+            auto orderedTopK = orderedSpell.lookupTopK(input, context, k);
+            assert(ranks({orderedTopK.begin(), orderedTopK.end()}) == ranks(expected));
+            assert(ranks(tieredSpell.lookupTopK(input, k)) == ranks(expected));
+        }
+        assert(ranks(spell.lookup(input, Verbosity::Top)) == ranks(spell.lookupTopK(input, 1)));
+        assert(ranks(orderedSpell.lookup(input, Verbosity::Top)) ==
+               ranks(spell.lookup(input, Verbosity::Top)));
+    }
+    assert(orderedSpell.lookupTopK("abc", 0).empty());
+
+    // An exact match ranks first without ending the search.
+    auto exact = spell.lookupTopK(words[0].first, 3);
+    assert(!exact.empty() && exact[0].term == words[0].first && exact[0].distance == 0);
+
+    // Re-weighting a term invalidates the bucket order.
+    orderedStore->setFrequency(words[0].first, words[0].second);
+    assert(orderedStore->bucketsOrderedByFrequency());
+    orderedStore->setFrequency(words[0].first, 1000);
+    assert(!orderedStore->bucketsOrderedByFrequency());
+    auto reweighted = orderedSpell.lookupTopK(words[0].first + "x", 1);
+    assert(reweighted.size() == 1 && reweighted[0].term == words[0].first);
+
+    std::cout << "PASSED" << std::endl;
+}
+
+// Small English dictionary with counts from the reference SymSpell frequency list.
+std::unique_ptr<SymSpell> makeEnglishSpell() {
+    auto spell = std::make_unique<SymSpell>(std::make_unique<MemoryStore>(2, 7), 2, 7);
+    std::istringstream words("the 23135851162\nof 13151942776\nand 12997637966\n"
+                             "to 12136980858\na 9081174698\nin 8469404971\nfor 5933321709\n"
+                             "is 4705743816\non 3750423199\nthat 3400031103\nby 3350048871\n"
+                             "he 2102948716\nwhere 1059604250\nhad 999123253\nwho 734343241\n"
+                             "much 609382864\nlove 708396478\npast 344953398\nread 362364051\n"
+                             "quick 163650643\nbrown 186114233\nfox 132016044\n"
+                             "dated 86485128\nsixth 34750000\ngrade 128271207\n"
+                             "inspired 17053866\nhim 363555095\nthe 1\n");
+    spell->createDictionary(words);
+    return spell;
+}
+
+void testLookupCompound() {
+    std::cout << "Running testLookupCompound... " << std::flush;
+
+    auto spell = makeEnglishSpell();
+    CompoundLookup compound(*spell);
+
+    auto corrected = compound.lookupCompound("whereis th elove hehad dated forimuch of thepast");
+    assert(corrected.term == "where is the love he had dated for much of the past");
+    assert(corrected.distance == 5);
+    assert(corrected.frequency >= 0);
+
+    // Plain words pass through; unknown tokens are kept as they are.
+    assert(compound.lookupCompound("the quick brown fox").term == "the quick brown fox");
+    assert(compound.lookupCompound("the qick brwn fox").term == "the quick brown fox");
+    assert(compound.lookupCompound("the xqzvk fox").term == "the xqzvk fox");
+    assert(compound.lookupCompound("").term.empty());
+
+    // Repeated tokens and queries are served from the memo.
+    uint64_t before = compound.lookups();
+    compound.lookupCompound("whereis th elove hehad dated forimuch of thepast");
+    assert(compound.lookups() == before);
+    compound.lookupCompound("the qick the qick the qick");
+    uint64_t repeated = compound.lookups() - before;
+    compound.lookupCompound("the qick");
+    assert(compound.lookups() - before == repeated);
+
+    // Bigram counts decide between otherwise equal splits, and live in the store.
+    assert(spell->createBigramEntry("sixth", "grade", 20000));
+    assert(!spell->createBigramEntry("sixth", "grade", 0));
+    assert(spell->bigramFrequency("sixth", "grade") == 20000);
+    assert(spell->minBigramCount() == 20000);
+    assert(!spell->bigramFrequency("grade", "sixth"));
+    std::istringstream bigrams("where is 60000\nbroken line\nhe had 40000\n");
+    assert(spell->createBigramDictionary(bigrams) == 2);
+    assert(spell->bigramFrequency("he", "had") == 40000);
+    assert(spell->minBigramCount() == 20000);
+    for (const auto& suggestion : spell->lookup(SymSpell::bigramKey("he", "had"), Verbosity::All)) {
+        assert(suggestion.term != SymSpell::bigramKey("he", "had"));
+    }
+    assert(compound.lookupCompound("sixthgrade").term == "sixth grade");
+    assert(spell->lookup("sixthgrade", Verbosity::All).empty());
+
+    // Growing the smallest bigram moves the minimum to the next one.
+    assert(spell->createBigramEntry("sixth", "grade", 30000));
+    assert(spell->minBigramCount() == 40000);
+
+    // A reopened store keeps the smallest bigram count, so its splits score the same.
+    const char* path = "/tmp/symspell_compound_test.db";
+    std::remove(path);
+    std::string query = "whereis th elove hehad dated forimuch of thepast sixthgrade";
+    {
+        sqlite3* db;
+        assert(sqlite3_open(path, &db) == SQLITE_OK);
+        assert(SQLiteStore::initializeDatabase(db));
+        {
+            SymSpell written(std::make_unique<SQLiteStore>(db, 2, 7), 2, 7);
+            auto& memory = static_cast<MemoryStore&>(spell->store());
+            TermDictionaryView terms = memory.terms();
+            for (TermId id = 0; id < terms.size(); ++id) {
+                std::string_view term = terms.term(id);
+                int64_t freq = memory.frequencies()[id];
+                if (freq <= 0) {
+                    continue;
+                }
+                if (SymSpell::isBigramKey(term)) {
+                    auto separator = term.find(SymSpell::kBigramSeparator);
+                    written.createBigramEntry(term.substr(0, separator),
+                                              term.substr(separator + 1), freq);
+                } else {
+                    written.createDictionaryEntry(term, freq);
+                }
+            }
+        }
+        {
+            SymSpell reopened(std::make_unique<SQLiteStore>(db, 2, 7), 2, 7);
+            assert(reopened.minBigramCount() == spell->minBigramCount());
+            CompoundLookup reopenedCompound(reopened);
+            auto expected = compound.lookupCompound(query);
+            auto actual = reopenedCompound.lookupCompound(query);
+            assert(actual.term == expected.term && actual.distance == expected.distance &&
+                   actual.frequency == expected.frequency);
+        }
+        sqlite3_close(db);
+    }
+    std::remove(path);
+
+    // Keys containing the separator are not words; the dictionary entry points skip them.
+    std::string key = SymSpell::bigramKey("cat", "horse");
+    assert(!spell->createDictionaryEntry(key, 7));
+    std::vector<DictionaryEntry> entries{{key, 7}, {"cathorse", 1}};
+    assert(spell->createDictionary(std::span<const DictionaryEntry>(entries)) == 1);
+    assert(!spell->store().termExists(key));
+    for (const auto& suggestion : spell->lookup("cathorse", Verbosity::All)) {
+        assert(!SymSpell::isBigramKey(suggestion.term));
+    }
+
+    // Dictionary changes drop the memo.
+    spell->createDictionaryEntry("thepast", 5000000000);
+    before = compound.lookups();
+    assert(compound.lookupCompound("of thepast").term == "of thepast");
+    assert(compound.lookups() > before);
+
+    assert(lookupCompound(*spell, "th quick").term == "the quick");
+
+    std::cout << "PASSED" << std::endl;
+}
+
+void testWordSegmentation() {
+    std::cout << "Running testWordSegmentation... " << std::flush;
+
+    auto spell = makeEnglishSpell();
+    CompoundLookup compound(*spell);
+
+    auto result = compound.wordSegmentation("thequickbrownfox");
+    assert(result.segmented == "the quick brown fox");
+    assert(result.corrected == "the quick brown fox");
+    assert(result.distance == 3);
+    assert(result.logProbability < 0);
+
+    // Misspelled words are corrected while segmenting; existing spaces are kept.
+    result = compound.wordSegmentation("thequikbrownfox");
+    assert(result.corrected == "the quick brown fox");
+    result = compound.wordSegmentation("the quickbrown fox");
+    assert(result.corrected == "the quick brown fox");
+    assert(result.distance == 1);
+
+    uint64_t before = compound.lookups();
+    compound.wordSegmentation("thequickbrownfox");
+    assert(compound.lookups() == before);
+
+    assert(wordSegmentation(*spell, "").corrected.empty());
+    assert(wordSegmentation(*spell, "hehad", 0).corrected == "he had");
+
+    std::cout << "PASSED" << std::endl;
+}
+
 void testLongWord() {
     std::cout << "Running testLongWord... " << std::flush;
 
@@ -301,6 +2543,66 @@ void testDamerauLevenshtein() {
     spell.createDictionaryEntry("abc", 100);
 
     auto suggestions = spell.lookup("acb", Verbosity::Closest);
+    assert(!suggestions.empty());
+    assert(suggestions[0].term == "abc");
+    assert(suggestions[0].distance == 1);
+
+    std::cout << "PASSED" << std::endl;
+}
+
+// Unbounded full-matrix optimal string alignment distance used as a reference.
+int referenceDistance(std::string_view a, std::string_view b) {
+    std::vector<std::vector<int>> d(a.size() + 1, std::vector<int>(b.size() + 1));
+    for (size_t i = 0; i <= a.size(); ++i) {
+        d[i][0] = static_cast<int>(i);
+    }
+    for (size_t j = 0; j <= b.size(); ++j) {
+        d[0][j] = static_cast<int>(j);
+    }
+    for (size_t i = 1; i <= a.size(); ++i) {
+        for (size_t j = 1; j <= b.size(); ++j) {
+            int cost = a[i - 1] == b[j - 1] ? 0 : 1;
+            d[i][j] = std::min({d[i - 1][j] + 1, d[i][j - 1] + 1, d[i - 1][j - 1] + cost});
+            if (i > 1 && j > 1 && a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1]) {
+                d[i][j] = std::min(d[i][j], d[i - 2][j - 2] + 1);
+            }
+        }
+    }
+    return d[a.size()][b.size()];
+}
+
+void testDistanceKernels() {
+    std::cout << "Running testDistanceKernels... " << std::flush;
+
+    std::mt19937 rng(1234);
+    std::vector<int> rows;
+    detail::BitParallelPattern pattern;
+
+    auto randomString = [&](size_t maxLen) {
+        std::uniform_int_distribution<size_t> len(0, maxLen);
+        std::uniform_int_distribution<int> ch('a', 'd');
+        std::string s(len(rng), ' ');
+        for (auto& c : s) {
+            c = static_cast<char>(ch(rng));
+        }
+        return s;
+    };
+
+    for (int iter = 0; iter < 20000; ++iter) {
+        std::string a = randomString(iter % 10 == 0 ? 64 : 12);
+        std::string b = randomString(iter % 10 == 0 ? 64 : 12);
+        int maxDistance = iter % 4;
+        int expected = std::min(referenceDistance(a, b), maxDistance + 1);
+
+        assert(detail::scalarDistance(a, b, maxDistance, rows) == expected);
+        assert(pattern.assign(a));
+        assert(pattern.distance(b, maxDistance) == expected);
+        assert(pattern.distance(b, 64) == referenceDistance(a, b));
+    }
+
+    assert(!pattern.assign(std::string(65, 'x')));
+    assert(detail::scalarDistance("ab", "ba", 2, rows) == 1);
+    assert(pattern.assign("ca") && pattern.distance("abc", 3) == 3);
 
     std::cout << "PASSED" << std::endl;
 }
@@ -314,6 +2616,123 @@ void testUnicode() {
     spell.createDictionaryEntry("naive", 100);
 
     auto suggestions = spell.lookup("naive", Verbosity::Closest);
+    assert(suggestions.size() == 1 && suggestions[0].distance == 0);
+
+    // Bytes: an accented letter is two edits from its plain form. Utf8: one.
+    SymSpell bytes(std::make_unique<MemoryStore>(2, 7), 2, 7);
+    SymSpell utf8(std::make_unique<MemoryStore>(2, 7), 2, 7, {}, TextEncoding::Utf8);
+    assert(utf8.encoding() == TextEncoding::Utf8 && bytes.encoding() == TextEncoding::Bytes);
+    for (SymSpell* s : {&bytes, &utf8}) {
+        s->createDictionaryEntry("caf\xC3\xA9", 50);     // café
+        s->createDictionaryEntry("stra\xC3\x9F" "e", 40); // straße
+        s->createDictionaryEntry("\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E", 30); // 日本語
+    }
+    auto plain = bytes.lookup("cafe", Verbosity::Closest);
+    assert(plain.size() == 1 && plain[0].distance == 2);
+    auto cafe = utf8.lookup("cafe", Verbosity::Closest);
+    assert(cafe.size() == 1 && cafe[0].term == "caf\xC3\xA9" && cafe[0].distance == 1);
+    auto grave = utf8.lookup("caf\xC3\xA8", Verbosity::Closest, 1); // cafè
+    assert(grave.size() == 1 && grave[0].distance == 1);
+    auto strasse = utf8.lookup("strase", Verbosity::Closest, 1);
+    assert(strasse.size() == 1 && strasse[0].term == "stra\xC3\x9F" "e");
+    auto nihon = utf8.lookup("\xE6\x97\xA5\xE8\xAA\x9E", Verbosity::Closest); // 日語
+    assert(nihon.size() == 1 && nihon[0].distance == 1);
+    assert(bytes.lookup("\xE6\x97\xA5\xE8\xAA\x9E", Verbosity::Closest).empty());
+    // Malformed bytes are characters of their own.
+    utf8.createDictionaryEntry("ab\xFF" "cd", 5);
+    auto malformed = utf8.lookup("abcd", Verbosity::Closest);
+    assert(malformed.size() == 1 && malformed[0].distance == 1);
+
+    // Deletes remove whole sequences, so non-ASCII words get fewer of them; ASCII words get
+    // exactly the byte hashes.
+    std::vector<std::string_view> accented = {"\xC3\xA9t\xC3\xA9", "na\xC3\xAFve",
+                                              "\xC3\xBC\xC3\xB6\xC3\xA4"};
+    auto byteFootprint = SymSpell::estimateFootprint(accented, accented.size());
+    auto utf8Footprint = SymSpell::estimateFootprint(accented, accented.size(), 2, 7, {},
+                                                     TextEncoding::Utf8);
+    assert(utf8Footprint.postings < byteFootprint.postings);
+    std::vector<std::string_view> ascii = {"hello", "world", "spelling", "correction"};
+    assert(SymSpell::estimateFootprint(ascii, ascii.size()).postings ==
+           SymSpell::estimateFootprint(ascii, ascii.size(), 2, 7, {}, TextEncoding::Utf8)
+               .postings);
+
+    // Verbosity::All finds exactly the words within the distance in code points, through
+    // both the bit-parallel kernel and the scalar fallback beyond 64 characters.
+    const std::vector<std::string> alphabet = {"a", "b", "c", "\xC3\xA9", "\xC3\x9F",
+                                               "\xE6\x97\xA5", "\xF0\x9F\x98\x80"};
+    std::mt19937 rng(11);
+    auto randomWord = [&](size_t minLength, size_t maxLength) {
+        size_t length = std::uniform_int_distribution<size_t>(minLength, maxLength)(rng);
+        std::string word;
+        for (size_t i = 0; i < length; ++i) {
+            word += alphabet[std::uniform_int_distribution<size_t>(0, alphabet.size() - 1)(rng)];
+        }
+        return word;
+    };
+    std::vector<std::string> words;
+    for (int i = 0; i < 400; ++i) {
+        words.push_back(randomWord(1, 9));
+    }
+    for (int i = 0; i < 20; ++i) {
+        words.push_back(randomWord(66, 70));
+    }
+    for (int prefix : {7, 5}) {
+        SymSpell coded(std::make_unique<MemoryStore>(2, prefix), 2, prefix, {},
+                       TextEncoding::Utf8);
+        for (const auto& word : words) {
+            coded.createDictionaryEntry(word, 1);
+        }
+        std::vector<int> rows;
+        std::u32string a;
+        std::u32string b;
+        for (int q = 0; q < 40; ++q) {
+            std::string query = q < 30 ? randomWord(1, 9) : words[400 + q - 30];
+            if (q >= 30) {
+                query.replace(0, 1, "\xC3\xA9");
+            }
+            std::vector<std::string> expected;
+            detail::decodeUtf8(query, a);
+            for (const auto& word : words) {
+                detail::decodeUtf8(word, b);
+                if (detail::scalarDistance(std::u32string_view(a), std::u32string_view(b), 2,
+                                           rows) <= 2) {
+                    expected.push_back(word);
+                }
+            }
+            std::sort(expected.begin(), expected.end());
+            expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+            std::vector<std::string> actual;
+            for (const auto& suggestion : coded.lookup(query, Verbosity::All)) {
+                detail::decodeUtf8(suggestion.term, b);
+                assert(suggestion.distance == detail::scalarDistance(std::u32string_view(a),
+                                                                     std::u32string_view(b), 2,
+                                                                     rows));
+                actual.push_back(suggestion.term);
+            }
+            std::sort(actual.begin(), actual.end());
+            assert(actual == expected);
+        }
+    }
+
+    // The code point kernel agrees with the scalar DP.
+    detail::BitParallelPattern pattern;
+    std::vector<int> rows;
+    std::u32string a;
+    std::u32string b;
+    for (int i = 0; i < 500; ++i) {
+        std::string x = randomWord(0, 12);
+        std::string y = randomWord(0, 12);
+        assert(pattern.assignUtf8(x));
+        detail::decodeUtf8(x, a);
+        detail::decodeUtf8(y, b);
+        for (int maxDistance : {1, 3, 30}) {
+            assert(pattern.distanceUtf8(y, maxDistance) ==
+                   detail::scalarDistance(std::u32string_view(a), std::u32string_view(b),
+                                          maxDistance, rows));
+        }
+    }
+    assert(!pattern.assignUtf8(randomWord(65, 65)));
+    assert(pattern.assign("abc") && pattern.distance("abd", 2) == 1);
 
     std::cout << "PASSED" << std::endl;
 }
@@ -348,16 +2767,43 @@ int main() {
     testVerbosityTop();
     testVerbosityAll();
     testFrequencyAccumulation();
+    testDictionaryRemoval();
     testMultipleEdits();
     testEmptyInput();
     testNoSuggestions();
     testMaxEditDistance();
+    testVisitTerms();
+    testMultiHashProbe();
+    testTermInterning();
+    testFrozenStore();
+    testLookupContext();
     testSQLiteStore();
     testSQLitePersistence();
+    testSQLiteConcurrentReads();
+    testSQLiteBulkImport();
+    testSQLitePackedSchema();
+    testSnapshotRoundTrip();
+    testDictionaryMetadata();
     testConcurrentAccess();
+    testLiveDictionary();
+    testLookupAsync();
+    testLookupBatch();
+    testBulkBuild();
+    testHashOptions();
+    testPrefixLength();
+    testMetrics();
+    testMemoryUsage();
+    testDictionaryLoader();
+    testLookupCache();
+    testTieredStore();
+    testShardedStore();
+    testTopK();
+    testLookupCompound();
+    testWordSegmentation();
     testLongWord();
     testCaseSensitivity();
     testDamerauLevenshtein();
+    testDistanceKernels();
     testUnicode();
     testPerformance();
 